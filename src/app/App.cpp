@@ -52,24 +52,21 @@ bool App::init() {
 
     fs::path userRoot = getUserMusicRoot();
     fs::path mediaPath = userRoot / "test_media";
-    fs::path playlistPath = userRoot / "playlist" / "playlists.json";
 
-    std::cout << "App: Loading user media from " << mediaPath << " ..." << std::endl;
-    appController->getMediaManager()->loadFromDirectory(mediaPath.string());
+    // Both libraries load in the background so the UI comes up immediately;
+    // playlists are loaded by AppController once the scans are done.
+    std::vector<std::string> roots = appController->getConfiguredLibraryRoots(mediaPath.string());
+    for (const auto& root : roots)
+        std::cout << "App: Loading user media from " << root << " ..." << std::endl;
+    appController->loadMainLibrary(roots);
 
     std::cout << "App: Checking for USB media..." << std::endl;
     if (appController->loadUSBLibrary()) {
-        int usbCount = appController->getUSBMediaManager()->getTotalFileCount();
-        std::cout << "App: USB media loaded successfully. Found " << usbCount << " files." << std::endl;
+        std::cout << "App: USB media found, loading in background." << std::endl;
     } else {
         std::cout << "App: No USB media detected or failed to load." << std::endl;
     }
 
-    if (appController && appController->getPlaylistManager()) {
-        std::cout << "App: Loading playlists from " << playlistPath << "..." << std::endl;
-        appController->getPlaylistManager()->loadFromFile(playlistPath.string());
-    }
-
     return true;
 }
 
@@ -0,0 +1,256 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+
+/**
+ * Writes a library of small, well-formed audio files for benchmarks, so nothing at
+ * scale depends on a folder of real music. Every file carries full tags (title,
+ * artist, album, year, track, genre) and a declared duration, but only a few
+ * frames of silence:
+ *  - MP3: ID3v2.3 tag, then MPEG-1 Layer III frames; the first holds a Xing
+ *    header giving the frame count, so the length is known without the audio
+ *  - FLAC: STREAMINFO with the total sample count, a VORBIS_COMMENT block and
+ *    one CONSTANT-subframe frame (CRCs included)
+ *  - WAV: 8 kHz mono PCM with a LIST/INFO tag chunk and one second of silence
+ * Header-only: the bench Makefile rule builds every .cpp in src/bench/ as a program.
+ */
+namespace SyntheticCorpus {
+
+enum class Shape {
+    NESTED, // root/Artist NNN/Album NN/TT - Title.ext
+    FLAT    // root/NNNNNN - Artist - Title.ext
+};
+
+struct Spec {
+    int fileCount = 1000;
+    Shape shape = Shape::NESTED;
+    int tracksPerAlbum = 12;
+    int albumsPerArtist = 4;
+    int mp3Percent = 70;  // Format mix; the rest after MP3 and FLAC are WAV
+    int flacPercent = 15;
+};
+
+struct Track {
+    std::string path;
+    std::string title, artist, album, genre;
+    int year = 0;
+    int trackNumber = 0;
+    int durationInSeconds = 0; // Declared in the headers (WAV files are 1 s)
+    std::string format; // "mp3", "flac" or "wav"
+};
+
+namespace detail {
+    inline void putBE(std::string& out, uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    inline void putLE(std::string& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    inline std::string padded(int value, int width) {
+        std::string digits = std::to_string(value);
+        return std::string(digits.size() < static_cast<size_t>(width) ? width - digits.size() : 0, '0') + digits;
+    }
+
+    inline uint8_t crc8(const std::string& data) { // FLAC frame header: poly 0x07
+        uint8_t crc = 0;
+        for (unsigned char byte : data) {
+            crc ^= byte;
+            for (int i = 0; i < 8; ++i) crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+        return crc;
+    }
+
+    inline uint16_t crc16(const std::string& data) { // FLAC frame footer: poly 0x8005
+        uint16_t crc = 0;
+        for (unsigned char byte : data) {
+            crc ^= static_cast<uint16_t>(byte << 8);
+            for (int i = 0; i < 8; ++i) crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+        }
+        return crc;
+    }
+}
+
+// Deterministic: the same index always gives the same track
+inline Track describe(const std::string& root, const Spec& spec, int index) {
+    static const char* GENRES[] = { "Rock", "Jazz", "Electronic", "Classical", "Folk", "Hip-Hop", "Ambient" };
+    int album = index / spec.tracksPerAlbum;
+    int artist = album / spec.albumsPerArtist;
+
+    Track track;
+    track.artist = "Artist " + detail::padded(artist, 3);
+    track.album = "Album " + detail::padded(album % spec.albumsPerArtist + 1, 2) + " of " + track.artist;
+    track.trackNumber = index % spec.tracksPerAlbum + 1;
+    track.title = "Song " + std::to_string(index);
+    track.year = 1960 + (artist * 7 + album) % 60;
+    track.genre = GENRES[artist % 7];
+    track.durationInSeconds = 90 + (index * 7919) % 300;
+
+    int bucket = (index * 37) % 100; // Spreads the formats evenly over the library
+    track.format = bucket < spec.mp3Percent ? "mp3" : bucket < spec.mp3Percent + spec.flacPercent ? "flac" : "wav";
+    if (track.format == "wav") track.durationInSeconds = 1;
+
+    if (spec.shape == Shape::NESTED) {
+        track.path = root + "/" + track.artist + "/Album " + detail::padded(album % spec.albumsPerArtist + 1, 2) + "/" +
+                     detail::padded(track.trackNumber, 2) + " - " + track.title + "." + track.format;
+    } else {
+        track.path = root + "/" + detail::padded(index, 6) + " - " + track.artist + " - " + track.title + "." + track.format;
+    }
+    return track;
+}
+
+inline std::string encodeMp3(const Track& track) {
+    using namespace detail;
+    std::string frames;
+    auto textFrame = [&frames](const char* id, const std::string& text) {
+        frames += id;
+        putBE(frames, text.size() + 1, 4); // ID3v2.3 frame sizes are plain big-endian
+        frames += std::string(2, '\0');
+        frames += '\0'; // ISO-8859-1
+        frames += text;
+    };
+    textFrame("TIT2", track.title);
+    textFrame("TPE1", track.artist);
+    textFrame("TALB", track.album);
+    textFrame("TYER", std::to_string(track.year));
+    textFrame("TRCK", std::to_string(track.trackNumber));
+    textFrame("TCON", track.genre);
+    frames += std::string(64, '\0'); // Padding, as taggers leave for in-place edits
+
+    std::string out = "ID3";
+    out += '\x03'; out += '\0'; out += '\0';
+    size_t size = frames.size();
+    for (int shift = 21; shift >= 0; shift -= 7) out += static_cast<char>((size >> shift) & 0x7f); // Syncsafe
+    out += frames;
+
+    // MPEG-1 Layer III, 128 kbps, 44.1 kHz, mono: 417-byte frames of 1152 samples
+    const size_t FRAME_SIZE = 417;
+    const uint32_t declaredFrames = static_cast<uint32_t>(track.durationInSeconds * 44100.0 / 1152.0);
+    for (int f = 0; f < 4; ++f) {
+        std::string frame = { '\xff', '\xfb', '\x90', '\xc4' };
+        frame += std::string(17, '\0'); // Side information: nothing coded, i.e. silence
+        if (f == 0) {
+            frame += "Xing";
+            putBE(frame, 0x3, 4); // Frame count and byte count present
+            putBE(frame, declaredFrames, 4);
+            putBE(frame, static_cast<uint64_t>(declaredFrames) * FRAME_SIZE, 4);
+        }
+        frame.resize(FRAME_SIZE, '\0');
+        out += frame;
+    }
+    return out;
+}
+
+inline std::string encodeFlac(const Track& track) {
+    using namespace detail;
+    const uint32_t SAMPLE_RATE = 44100;
+    const uint32_t BLOCK_SIZE = 4096;
+
+    std::string out = "fLaC";
+    out += '\0'; // STREAMINFO, not last
+    putBE(out, 34, 3);
+    putBE(out, BLOCK_SIZE, 2);
+    putBE(out, BLOCK_SIZE, 2);
+    putBE(out, 0, 3); // Frame sizes unknown
+    putBE(out, 0, 3);
+    uint64_t totalSamples = static_cast<uint64_t>(track.durationInSeconds) * SAMPLE_RATE;
+    putBE(out, (static_cast<uint64_t>(SAMPLE_RATE) << 44) | (0ULL << 41) | (15ULL << 36) | totalSamples, 8); // Mono, 16 bit
+    out += std::string(16, '\0'); // MD5 not computed
+
+    std::string comments;
+    const std::string vendor = "SyntheticCorpus";
+    putLE(comments, vendor.size(), 4);
+    comments += vendor;
+    std::vector<std::string> fields = {
+        "TITLE=" + track.title, "ARTIST=" + track.artist, "ALBUM=" + track.album,
+        "DATE=" + std::to_string(track.year), "TRACKNUMBER=" + std::to_string(track.trackNumber), "GENRE=" + track.genre
+    };
+    putLE(comments, fields.size(), 4);
+    for (const auto& field : fields) {
+        putLE(comments, field.size(), 4);
+        comments += field;
+    }
+    out += '\x84'; // VORBIS_COMMENT, last block
+    putBE(out, comments.size(), 3);
+    out += comments;
+
+    // One fixed-blocksize frame: 4096 samples, 44.1 kHz, mono, 16 bit, frame number 0
+    std::string frame = { '\xff', '\xf8', '\xc9', '\x08', '\x00' };
+    frame += static_cast<char>(crc8(frame));
+    frame += std::string(3, '\0'); // CONSTANT subframe with value 0
+    putBE(frame, crc16(frame), 2);
+    out += frame;
+    return out;
+}
+
+inline std::string encodeWav(const Track& track) {
+    using namespace detail;
+    std::string info = "INFO";
+    auto infoChunk = [&info](const char* id, const std::string& text) {
+        info += id;
+        putLE(info, text.size() + 1, 4);
+        info += text;
+        info += '\0';
+        if ((text.size() + 1) % 2) info += '\0'; // Chunks are word-aligned
+    };
+    infoChunk("INAM", track.title);
+    infoChunk("IART", track.artist);
+    infoChunk("IPRD", track.album);
+    infoChunk("ICRD", std::to_string(track.year));
+    infoChunk("IPRT", std::to_string(track.trackNumber));
+    infoChunk("IGNR", track.genre);
+
+    const uint32_t SAMPLE_RATE = 8000;
+    std::string body = "WAVE";
+    body += "fmt ";
+    putLE(body, 16, 4);
+    putLE(body, 1, 2); // PCM
+    putLE(body, 1, 2); // Mono
+    putLE(body, SAMPLE_RATE, 4);
+    putLE(body, SAMPLE_RATE, 4); // Byte rate
+    putLE(body, 1, 2); // Block align
+    putLE(body, 8, 2); // Bits per sample
+    body += "LIST";
+    putLE(body, info.size(), 4);
+    body += info;
+    body += "data";
+    putLE(body, SAMPLE_RATE * track.durationInSeconds, 4);
+    body += std::string(SAMPLE_RATE * track.durationInSeconds, '\x80'); // 8-bit silence
+
+    std::string out = "RIFF";
+    putLE(out, body.size(), 4);
+    return out + body;
+}
+
+inline std::string encode(const Track& track) {
+    if (track.format == "mp3") return encodeMp3(track);
+    if (track.format == "flac") return encodeFlac(track);
+    return encodeWav(track);
+}
+
+// Writes spec.fileCount files under 'root' and returns their paths in index order.
+// Existing files are overwritten; an empty vector means a file could not be written.
+inline std::vector<std::string> generate(const std::string& root, const Spec& spec) {
+    std::vector<std::string> paths;
+    paths.reserve(spec.fileCount);
+    std::string lastDir;
+    for (int i = 0; i < spec.fileCount; ++i) {
+        Track track = describe(root, spec, i);
+        std::string dir = std::filesystem::path(track.path).parent_path().string();
+        if (dir != lastDir) {
+            std::filesystem::create_directories(dir);
+            lastDir = dir;
+        }
+        std::ofstream out(track.path, std::ios::binary | std::ios::trunc);
+        out << encode(track);
+        if (!out) return {};
+        paths.push_back(std::move(track.path));
+    }
+    return paths;
+}
+
+} // namespace SyntheticCorpus
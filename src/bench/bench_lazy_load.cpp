@@ -0,0 +1,50 @@
+#include "model/MediaManager.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+
+/**
+ * Time to first page: eager scan vs lazy metadata.
+ * Eager loadFromDirectory() reads every tag before the list can be drawn; lazy
+ * mode records paths and stat data, then reads the 25 tags of the first page.
+ * Runs against a real directory (default ./test_media, or argv[1]) since the
+ * cost being measured is tag I/O. No library cache, so every tag is read.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t PAGE_SIZE = 25;
+    std::string path = argc > 1 ? argv[1] : "./test_media";
+    if (!std::filesystem::is_directory(path)) {
+        std::cout << "⏭  Benchmark: lazy load skipped (no directory " << path << ")" << std::endl;
+        return 0;
+    }
+
+    std::cout << "⏱  Benchmark: lazy load (" << path << ")" << std::endl;
+    TagLibWrapper tagUtil;
+
+    auto start = Clock::now();
+    MediaManager eager(&tagUtil);
+    eager.loadFromDirectory(path);
+    double eagerMs = msSince(start);
+
+    start = Clock::now();
+    MediaManager lazy(&tagUtil);
+    lazy.setLazyMetadata(true);
+    lazy.loadFromDirectory(path);
+    double scanMs = msSince(start);
+    lazy.ensureMetadata(lazy.range(0, PAGE_SIZE));
+    double firstPageMs = msSince(start);
+
+    std::cout << "  > Files: " << eager.getTotalFileCount() << std::endl;
+    std::cout << "  > Eager: " << eagerMs << " ms until the first page is ready" << std::endl;
+    std::cout << "  > Lazy:  " << firstPageMs << " ms until the first page is ready ("
+              << scanMs << " ms scan, " << lazy.getPendingMetadataCount() << " tags still pending)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "model/MediaManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <memory>
+#include <malloc.h>
+
+/**
+ * Heap bytes per library entry.
+ * Builds a synthetic 100k-file library shaped like a TagLib scan (title,
+ * artist/album/genre/year/track fields, realistic path depth) and reports
+ * how much heap the library holds per track, index included.
+ */
+
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static std::string trackPath(int i) {
+    return "/home/user/Music/Artist Name " + std::to_string(i % 500) + "/Album Title " +
+           std::to_string(i % 37) + "/" + std::to_string(i % 20 + 1) + " - Song Title " + std::to_string(i) + ".mp3";
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+
+    std::cout << "⏱  Benchmark: library memory (" << LIBRARY_SIZE << " tracks)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    size_t before = heapInUse();
+    {
+        MediaManager library(&tagUtil);
+        for (int i = 0; i < LIBRARY_SIZE; ++i) {
+            auto meta = std::make_unique<AudioMetadata>();
+            meta->title = "Song Title " + std::to_string(i);
+            meta->durationInSeconds = 180 + i % 120;
+            meta->fileSizeInBytes = 4000000 + i;
+            meta->setField("artist", "Artist Name " + std::to_string(i % 500));
+            meta->setField("album", "Album Title " + std::to_string(i % 37));
+            meta->setField("genre", i % 2 ? "Rock" : "Electronic");
+            meta->setField("year", std::to_string(1970 + i % 50));
+            meta->setField("tracknumber", std::to_string(i % 20 + 1));
+            library.addMediaFile(std::make_unique<MediaFile>(trackPath(i), std::move(meta)));
+        }
+        size_t used = heapInUse() - before;
+        std::cout << "  total heap:          " << used / (1024 * 1024) << " MB" << std::endl;
+        std::cout << "  bytes per track:     " << used / LIBRARY_SIZE << std::endl;
+    }
+    return 0;
+}
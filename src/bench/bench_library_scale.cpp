@@ -0,0 +1,237 @@
+#include "bench/SyntheticCorpus.h"
+#include "model/MediaManager.h"
+#include "model/PlaylistManager.h"
+#include "controller/MediaController.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <algorithm>
+#include <random>
+#include "nlohmann/json.hpp"
+
+/**
+ * Library operations at 1k, 10k and 100k files, on a synthetic corpus written to disk
+ * (see SyntheticCorpus.h). Times the directory scan, single tag reads, paging,
+ * path lookups, playlist save/load, journaled playlist edits (with the bytes they
+ * cost) and next/previous track lookup.
+ *
+ * Results go to stdout and, as JSON, to $BENCH_OUTPUT (default ./bench_library_scale.json).
+ * $BENCH_SIZES overrides the library sizes (e.g. BENCH_SIZES=1000,5000 make bench).
+ * The corpus is written under the system temp directory and removed afterwards, so the
+ * scan runs against a warm page cache.
+ *
+ * Standalone generator: bench_library_scale.out --generate <dir> <count> [--flat]
+ */
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::vector<int> librarySizes() {
+    std::vector<int> sizes;
+    const char* env = std::getenv("BENCH_SIZES");
+    std::stringstream list(env && *env ? env : "1000,10000,100000");
+    for (std::string item; std::getline(list, item, ','); ) {
+        int size = std::atoi(item.c_str());
+        if (size > 0) sizes.push_back(size);
+    }
+    return sizes;
+}
+
+class Recorder {
+public:
+    explicit Recorder(int files) : files(files) {}
+
+    // 'count' operations took 'ms' in total
+    void add(const std::string& op, double ms, size_t count) {
+        double perOpUs = count > 0 ? ms * 1000.0 / count : 0.0;
+        std::cout << "  " << op << std::string(op.size() < 28 ? 28 - op.size() : 1, ' ') << ms << " ms";
+        if (count > 1) std::cout << " (" << count << " ops, " << perOpUs << " us/op)";
+        std::cout << std::endl;
+        results.push_back({ {"files", files}, {"op", op}, {"count", count}, {"total_ms", ms}, {"per_op_us", perOpUs} });
+    }
+
+    json results = json::array();
+
+private:
+    int files;
+};
+
+static void runSize(int fileCount, json& allResults) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / ("bench_library_scale_" + std::to_string(fileCount));
+    const std::string root = (dir / "library").string();
+    const std::string playlistFile = (dir / "playlists.json").string();
+    fs::remove_all(dir);
+
+    std::cout << "⏱  Benchmark: library scale (" << fileCount << " files)" << std::endl;
+    Recorder recorder(fileCount);
+
+    SyntheticCorpus::Spec spec;
+    spec.fileCount = fileCount;
+    auto start = Clock::now();
+    std::vector<std::string> paths = SyntheticCorpus::generate(root, spec);
+    recorder.add("generate_corpus", msSince(start), paths.size());
+    if (paths.size() != static_cast<size_t>(fileCount)) {
+        std::cerr << "bench_library_scale: could not write the corpus under " << root << std::endl;
+        std::exit(1);
+    }
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    auto coutBuf = std::cout.rdbuf(nullptr); // The scan and playlist code log per file
+    start = Clock::now();
+    library.loadFromDirectory(root);
+    double loadMs = msSince(start);
+    std::cout.rdbuf(coutBuf);
+    recorder.add("loadFromDirectory", loadMs, library.getTotalFileCount());
+
+    // Single-file tag reads, evenly spread over the corpus; also checks the files parse as written
+    size_t samples = std::min<size_t>(paths.size(), 1000);
+    std::vector<std::unique_ptr<Metadata>> tags(samples);
+    start = Clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        tags[i] = tagUtil.readTags(paths[i * paths.size() / samples]);
+    }
+    recorder.add("readTags", msSince(start), samples);
+    size_t mismatched = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        SyntheticCorpus::Track expected = SyntheticCorpus::describe(root, spec, static_cast<int>(i * paths.size() / samples));
+        if (!tags[i] || tags[i]->title != expected.title || tags[i]->getArtist() != expected.artist) ++mismatched;
+    }
+    if (mismatched > 0) std::cerr << "  (" << mismatched << " of " << samples << " files read back with other tags)" << std::endl;
+
+    // Paging through the whole library, in scan order and sorted by artist
+    const int PAGE_SIZE = 25;
+    int pages = library.getTotalPages(PAGE_SIZE);
+    size_t seen = 0;
+    start = Clock::now();
+    for (int page = 1; page <= pages; ++page) seen += library.getPage(page, PAGE_SIZE).size();
+    recorder.add("getPage", msSince(start), pages);
+
+    start = Clock::now();
+    library.setSortOrder(SortOrder::ARTIST);
+    library.at(0);
+    recorder.add("sort_by_artist", msSince(start), 1);
+
+    start = Clock::now();
+    for (int page = 1; page <= pages; ++page) seen += library.getPage(page, PAGE_SIZE).size();
+    recorder.add("getPage_artist_order", msSince(start), pages);
+
+    // Path lookups in random order
+    std::vector<std::string> shuffled = paths;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+    size_t found = 0;
+    start = Clock::now();
+    for (const auto& path : shuffled) {
+        if (library.findFileByPath(path)) ++found;
+    }
+    recorder.add("findFileByPath", msSince(start), shuffled.size());
+
+    // Playlists: ten of a tenth of the library each, saved and loaded back
+    {
+        MediaManager usbLibrary(&tagUtil); // Empty, as in the app without a stick
+        PlaylistManager playlists(&library);
+        playlists.setUSBMediaManager(&usbLibrary);
+        size_t trackCount = 0;
+        for (int p = 0; p < 10; ++p) {
+            Playlist* playlist = playlists.createPlaylist("Playlist " + std::to_string(p));
+            for (size_t i = p; i < paths.size(); i += 10) {
+                playlist->addTrack(library.findFileByPath(paths[i]));
+                ++trackCount;
+            }
+        }
+        coutBuf = std::cout.rdbuf(nullptr);
+        start = Clock::now();
+        playlists.saveToFile(playlistFile);
+        double saveMs = msSince(start);
+
+        PlaylistManager loaded(&library);
+        loaded.setUSBMediaManager(&usbLibrary);
+        start = Clock::now();
+        loaded.loadFromFile(playlistFile);
+        double playlistLoadMs = msSince(start);
+        std::cout.rdbuf(coutBuf);
+        recorder.add("playlist_save", saveMs, trackCount);
+        recorder.add("playlist_load", playlistLoadMs, trackCount);
+
+        // Adding tracks one at a time, as from the UI: every add is journaled
+        const size_t ADDS = std::min<size_t>(paths.size(), 200);
+        Playlist* added = loaded.createPlaylist("Added one by one");
+        PlaylistManager::SaveStats before = loaded.getSaveStats();
+        coutBuf = std::cout.rdbuf(nullptr);
+        start = Clock::now();
+        for (size_t i = 0; i < ADDS; ++i) {
+            loaded.addTrack(added, library.findFileByPath(paths[i]));
+            loaded.saveIfDue();
+        }
+        double addMs = msSince(start);
+        loaded.flushAutoSave();
+        std::cout.rdbuf(coutBuf);
+        PlaylistManager::SaveStats after = loaded.getSaveStats();
+        recorder.add("playlist_add_journaled", addMs, ADDS);
+        recorder.results.back()["writes"] = after.writes - before.writes;
+        recorder.results.back()["bytes_written"] = after.bytesWritten - before.bytesWritten;
+        recorder.results.back()["journal_bytes"] = after.journalBytes - before.journalBytes;
+        std::cout << "    " << (after.changes - before.changes) << " changes, " << (after.journalBytes - before.journalBytes)
+                  << " journal bytes, then " << (after.writes - before.writes) << " compacting writes, "
+                  << (after.bytesWritten - before.bytesWritten) / 1024 << " KiB" << std::endl;
+
+        // Next track inside a playlist: a linear search for the current track each time
+        Playlist* playlist = loaded.getAllPlaylists().front();
+        size_t steps = std::min<size_t>(playlist->getTracks().size(), 1000);
+        MediaFile* current = playlist->getTracks().front();
+        start = Clock::now();
+        for (size_t i = 0; i < steps && current; ++i) {
+            current = MediaController::findAdjacentTrack(current, playlist, &library, &usbLibrary, 1);
+        }
+        recorder.add("findAdjacentTrack_playlist", msSince(start), steps);
+    }
+
+    // Next track in the library, following the artist order
+    size_t steps = std::min<size_t>(paths.size(), 10000);
+    MediaFile* current = library.at(0);
+    start = Clock::now();
+    for (size_t i = 0; i < steps && current; ++i) {
+        current = MediaController::findAdjacentTrack(current, nullptr, &library, nullptr, 1);
+    }
+    recorder.add("findAdjacentTrack_library", msSince(start), steps);
+
+    if (found != paths.size() || seen != 2 * static_cast<size_t>(library.getTotalFileCount())) {
+        std::cerr << "bench_library_scale: library check failed (" << found << " found, " << seen << " paged)" << std::endl;
+        std::exit(1);
+    }
+    for (auto& result : recorder.results) allResults.push_back(std::move(result));
+    fs::remove_all(dir);
+}
+
+static int generateOnly(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " --generate <dir> <count> [--flat]" << std::endl;
+        return 2;
+    }
+    SyntheticCorpus::Spec spec;
+    spec.fileCount = std::atoi(argv[3]);
+    if (argc > 4 && std::string(argv[4]) == "--flat") spec.shape = SyntheticCorpus::Shape::FLAT;
+    std::vector<std::string> paths = SyntheticCorpus::generate(argv[2], spec);
+    std::cout << "Wrote " << paths.size() << " files under " << argv[2] << std::endl;
+    return paths.size() == static_cast<size_t>(spec.fileCount) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--generate") return generateOnly(argc, argv);
+
+    json results = json::array();
+    for (int size : librarySizes()) runSize(size, results);
+
+    const char* env = std::getenv("BENCH_OUTPUT");
+    std::string output = env && *env ? env : "bench_library_scale.json";
+    std::ofstream(output) << json{ {"benchmark", "library_scale"}, {"results", results} }.dump(2) << std::endl;
+    std::cout << "  results: " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "model/MediaManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Library paging cost per UI frame.
+ * A frame is what MainFileView does on every redraw: fetch the visible page and
+ * the selected file. Compares the old getPage()-based path with range()/at(),
+ * counting heap allocations via a global operator new hook, and the old
+ * page-walking next-track lookup with indexOf()/at().
+ */
+
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double nsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+    const int FRAMES = 10000;
+    const int PAGE_SIZE = 25;
+
+    std::cout << "⏱  Benchmark: paging (" << LIBRARY_SIZE << " tracks, " << PAGE_SIZE << " rows per page)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    for (int i = 0; i < LIBRARY_SIZE; ++i) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = "Track " + std::to_string(i);
+        library.addMediaFile(std::make_unique<MediaFile>("/bench/track" + std::to_string(i) + ".mp3", std::move(meta)));
+    }
+
+    volatile size_t sink = 0;
+
+    // --- getPage(): one vector for the page, another for the selection lookup ---
+    size_t before = allocationCount;
+    auto start = Clock::now();
+    for (int f = 0; f < FRAMES; ++f) {
+        int page = 1 + f % 4000;
+        std::vector<MediaFile*> rows = library.getPage(page, PAGE_SIZE);
+        for (MediaFile* file : rows) sink += file->getFileName().size();
+        std::vector<MediaFile*> selectedPage = library.getPage(page, PAGE_SIZE);
+        sink += selectedPage.empty() ? 0 : 1;
+    }
+    std::cout << "  getPage frame:       " << nsSince(start) / FRAMES << " ns, "
+              << double(allocationCount - before) / FRAMES << " allocations" << std::endl;
+
+    // --- range()/at() ---
+    before = allocationCount;
+    start = Clock::now();
+    for (int f = 0; f < FRAMES; ++f) {
+        size_t offset = static_cast<size_t>(f % 4000) * PAGE_SIZE;
+        MediaFileRange rows = library.range(offset, PAGE_SIZE);
+        for (MediaFile* file : rows) sink += file->getFileName().size();
+        sink += library.at(offset) ? 1 : 0;
+    }
+    std::cout << "  range/at frame:      " << nsSince(start) / FRAMES << " ns, "
+              << double(allocationCount - before) / FRAMES << " allocations" << std::endl;
+
+    // --- Next track in library context ---
+    const int LOOKUPS = 100;
+    MediaFile* current = library.at(LIBRARY_SIZE - 10);
+    before = allocationCount;
+    start = Clock::now();
+    for (int n = 0; n < LOOKUPS; ++n) {
+        int index = -1;
+        for (int p = 1; p <= library.getTotalPages(PAGE_SIZE) && index < 0; ++p) {
+            std::vector<MediaFile*> page = library.getPage(p, PAGE_SIZE);
+            for (size_t i = 0; i < page.size(); ++i) {
+                if (page[i] == current) { index = (p - 1) * PAGE_SIZE + i; break; }
+            }
+        }
+        sink += library.getPage(index / PAGE_SIZE + 1, PAGE_SIZE).size();
+    }
+    std::cout << "  next track (pages):  " << nsSince(start) / LOOKUPS / 1000 << " us, "
+              << double(allocationCount - before) / LOOKUPS << " allocations" << std::endl;
+
+    before = allocationCount;
+    start = Clock::now();
+    for (int n = 0; n < LOOKUPS; ++n) {
+        sink += library.at(library.indexOf(current) + 1) ? 1 : 0;
+    }
+    std::cout << "  next track (index):  " << nsSince(start) / LOOKUPS / 1000 << " us, "
+              << double(allocationCount - before) / LOOKUPS << " allocations" << std::endl;
+
+    library.setSortOrder(SortOrder::FILE_NAME);
+    library.at(0); // Build the permutation outside the timed loop
+    before = allocationCount;
+    start = Clock::now();
+    for (int n = 0; n < LOOKUPS; ++n) {
+        sink += library.at(library.indexOf(current) + 1) ? 1 : 0;
+    }
+    std::cout << "  next track (sorted): " << nsSince(start) / LOOKUPS / 1000 << " us, "
+              << double(allocationCount - before) / LOOKUPS << " allocations" << std::endl;
+    return 0;
+}
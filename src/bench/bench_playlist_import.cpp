@@ -0,0 +1,92 @@
+#include "model/MediaManager.h"
+#include "model/PlaylistManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+/**
+ * M3U and PLS import/export against a large library.
+ * Builds a synthetic 100k-file library in memory (no files on disk), writes a
+ * 50k-entry M3U with half the entries relative to its directory, then times
+ * PlaylistManager::importPlaylist (one path-index lookup per entry) and
+ * exportPlaylist, for M3U and for PLS.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::string trackPath(const fs::path& root, int i) {
+    return (root / ("artist" + std::to_string(i % 500)) / ("album" + std::to_string(i % 37)) /
+            ("track" + std::to_string(i) + ".mp3")).string();
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+    const int ENTRIES = 50000;
+    const fs::path dir = fs::absolute("bench_playlist_import");
+    const fs::path musicRoot = dir / "music"; // The playlists sit next to it
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::cout << "⏱  Benchmark: playlist import (" << ENTRIES << " entries, " << LIBRARY_SIZE << "-file library)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    MediaManager usbLibrary(&tagUtil); // Empty, but searched on every miss like in the app
+    for (int i = 0; i < LIBRARY_SIZE; ++i) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = "Track " + std::to_string(i);
+        meta->setArtist("Artist " + std::to_string(i % 500));
+        meta->durationInSeconds = 120 + i % 300;
+        library.addMediaFile(std::make_unique<MediaFile>(trackPath(musicRoot, i), std::move(meta)));
+    }
+
+    const std::string source = (dir / "source.m3u").string();
+    {
+        std::ofstream out(source);
+        out << "#EXTM3U\n";
+        for (int e = 0; e < ENTRIES; ++e) {
+            std::string path = trackPath(musicRoot, (e * 7919) % LIBRARY_SIZE);
+            out << "#EXTINF:200,Artist - Track\n";
+            out << (e % 2 ? path.substr(dir.string().size() + 1) : path) << "\n"; // Odd ones relative
+        }
+    }
+
+    PlaylistManager manager(&library);
+    manager.setUSBMediaManager(&usbLibrary);
+
+    auto coutBuf = std::cout.rdbuf(nullptr);
+    auto start = Clock::now();
+    Playlist* imported = manager.importPlaylist(source, "Imported");
+    double importMs = msSince(start);
+    std::cout.rdbuf(coutBuf);
+    std::cout << "  import M3U:          " << importMs << " ms (" << (imported ? imported->getTracks().size() : 0)
+              << " tracks)" << std::endl;
+
+    for (const char* name : { "export.m3u8", "export.pls" }) {
+        const std::string file = (dir / name).string();
+        coutBuf = std::cout.rdbuf(nullptr);
+        start = Clock::now();
+        manager.exportPlaylist(imported, file);
+        double exportMs = msSince(start);
+        start = Clock::now();
+        Playlist* again = manager.importPlaylist(file, name);
+        double reimportMs = msSince(start);
+        std::cout.rdbuf(coutBuf);
+        std::cout << "  " << name << ":" << std::string(19 - std::string(name).size(), ' ') << "export " << exportMs
+                  << " ms (" << fs::file_size(file) / 1024 << " KiB), import " << reimportMs << " ms ("
+                  << (again ? again->getTracks().size() : 0) << " tracks)" << std::endl;
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "model/MediaManager.h"
+#include "model/PlaylistManager.h"
+#include "model/PlaylistFile.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+/**
+ * Playlist load and save against a large library.
+ * Builds a synthetic 100k-file library in memory (no files on disk), writes
+ * 5 playlists of 100k tracks each (a playlist file of about 30 MB) and times
+ * PlaylistManager::loadFromFile, which resolves every track through
+ * MediaManager::findFileByPath, and saveToFile. The peak memory each one adds
+ * is read from VmHWM in /proc/self/status. Then compares the JSON file (the
+ * json::dump(4) layout) with the binary one: size, save time and load time.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Resident set (kB) now, after resetting the peak so the next readPeakKb() covers only what follows
+static long resetPeakKb() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line); ) {
+        if (line.rfind("VmRSS:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+    return 0;
+}
+
+static long readPeakKb() {
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line); ) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+    return 0;
+}
+
+static std::string trackPath(int i) {
+    return "/bench/library/artist" + std::to_string(i % 500) + "/album" + std::to_string(i % 37) +
+           "/track" + std::to_string(i) + ".mp3";
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+    const int PLAYLISTS = 5;
+    const int TRACKS_PER_PLAYLIST = 100000;
+    const std::string playlistFile = "./bench_playlists.json";
+
+    std::cout << "⏱  Benchmark: playlist load (" << PLAYLISTS << " x " << TRACKS_PER_PLAYLIST
+              << " tracks, " << LIBRARY_SIZE << "-file library)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    MediaManager usbLibrary(&tagUtil); // Empty, but searched on every miss like in the app
+
+    auto start = Clock::now();
+    for (int i = 0; i < LIBRARY_SIZE; ++i) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = "Track " + std::to_string(i);
+        library.addMediaFile(std::make_unique<MediaFile>(trackPath(i), std::move(meta)));
+    }
+    std::cout << "  build library:       " << msSince(start) << " ms" << std::endl;
+
+    // Written out directly: a JSON document of this size would stay in the heap and hide
+    // what loading it takes (the paths need no escaping)
+    {
+        std::ofstream out(playlistFile);
+        out << "[\n";
+        for (int p = 0; p < PLAYLISTS; ++p) {
+            out << "    {\n        \"name\": \"Playlist " << p << "\",\n        \"tracks\": [\n";
+            for (int t = 0; t < TRACKS_PER_PLAYLIST; ++t) {
+                out << "            \"" << trackPath((p * 7919 + t * 13) % LIBRARY_SIZE)
+                    << (t + 1 < TRACKS_PER_PLAYLIST ? "\",\n" : "\"\n");
+            }
+            out << "        ]\n    }" << (p + 1 < PLAYLISTS ? ",\n" : "\n");
+        }
+        out << "]";
+    }
+    std::ifstream sizeCheck(playlistFile, std::ios::ate | std::ios::binary);
+    std::cout << "  playlist file:       " << sizeCheck.tellg() / (1024 * 1024) << " MiB" << std::endl;
+
+    PlaylistManager manager(&library);
+    manager.setUSBMediaManager(&usbLibrary);
+
+    // Silence the per-track warnings while timing
+    auto coutBuf = std::cout.rdbuf(nullptr);
+    long baseKb = resetPeakKb();
+    start = Clock::now();
+    manager.loadFromFile(playlistFile);
+    double loadMs = msSince(start);
+    long loadPeakKb = readPeakKb() - baseKb;
+    std::cout.rdbuf(coutBuf);
+
+    size_t resolved = 0;
+    for (Playlist* p : manager.getAllPlaylists()) resolved += p->getTracks().size();
+    std::cout << "  loadFromFile:        " << loadMs << " ms (" << resolved << " tracks resolved, peak +"
+              << loadPeakKb / 1024 << " MiB)" << std::endl;
+
+    coutBuf = std::cout.rdbuf(nullptr);
+    baseKb = resetPeakKb();
+    start = Clock::now();
+    manager.saveToFile();
+    double saveMs = msSince(start);
+    long savePeakKb = readPeakKb() - baseKb;
+    std::cout.rdbuf(coutBuf);
+    std::cout << "  saveToFile:          " << saveMs << " ms (peak +" << savePeakKb / 1024 << " MiB)" << std::endl;
+
+    // The same playlists in each encoding: file size, then a save and a load of it
+    const std::string binaryFile = "./bench_playlists.bin";
+    for (PlaylistFile::Format format : { PlaylistFile::Format::JSON, PlaylistFile::Format::BINARY }) {
+        const std::string& path = format == PlaylistFile::Format::BINARY ? binaryFile : playlistFile;
+        manager.setFileFormat(format);
+        coutBuf = std::cout.rdbuf(nullptr);
+        start = Clock::now();
+        manager.saveToFile(path);
+        saveMs = msSince(start);
+
+        PlaylistManager reader(&library);
+        reader.setUSBMediaManager(&usbLibrary);
+        reader.setFileFormat(format);
+        start = Clock::now();
+        reader.loadFromFile(path);
+        loadMs = msSince(start);
+        std::cout.rdbuf(coutBuf);
+
+        std::ifstream size(path, std::ios::ate | std::ios::binary);
+        std::cout << "  " << PlaylistFile::getFormatName(format) << (format == PlaylistFile::Format::BINARY ? ":" : ":  ")
+                  << "              " << size.tellg() / 1024 << " KiB, save " << saveMs << " ms, load "
+                  << loadMs << " ms" << std::endl;
+    }
+
+    const int LOOKUPS = 100000;
+    start = Clock::now();
+    size_t found = 0;
+    for (int i = 0; i < LOOKUPS; ++i) {
+        if (library.findFileByPath(trackPath((i * 31) % LIBRARY_SIZE))) ++found;
+    }
+    double perLookupUs = msSince(start) * 1000.0 / LOOKUPS;
+    std::cout << "  findFileByPath:      " << perLookupUs << " us/lookup (" << found << "/" << LOOKUPS << " hits)" << std::endl;
+
+    std::remove(playlistFile.c_str());
+    std::remove((playlistFile + ".journal").c_str());
+    std::remove(binaryFile.c_str());
+    std::remove((binaryFile + ".journal").c_str());
+    return 0;
+}
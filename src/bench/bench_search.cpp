@@ -0,0 +1,48 @@
+#include "model/MediaManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <chrono>
+#include <memory>
+
+/**
+ * Type-ahead search over a synthetic 100k-track library.
+ * Reports index build cost (on top of addMediaFile) and per-query latency
+ * for selective and broad queries, as typed one character at a time.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double usSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+    const int REPEAT = 20;
+
+    std::cout << "⏱  Benchmark: search (" << LIBRARY_SIZE << " tracks)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    auto start = Clock::now();
+    for (int i = 0; i < LIBRARY_SIZE; ++i) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = "Song Title " + std::to_string(i);
+        meta->setArtist("Artist Name " + std::to_string(i % 500));
+        meta->setAlbum("Album Title " + std::to_string(i % 3700));
+        library.addMediaFile(std::make_unique<MediaFile>(
+            "/music/artist" + std::to_string(i % 500) + "/track" + std::to_string(i) + ".mp3", std::move(meta)));
+    }
+    std::cout << "  build library+index: " << usSince(start) / 1000 << " ms" << std::endl;
+
+    for (const char* query : { "s", "so", "son", "song 4242", "artist name 17", "album title 3699", "zzz" }) {
+        size_t hits = 0;
+        start = Clock::now();
+        for (int r = 0; r < REPEAT; ++r) {
+            hits = library.search(query, 500).size();
+        }
+        std::cout << "  \"" << query << "\": " << usSince(start) / REPEAT << " us (" << hits << " results)" << std::endl;
+    }
+    return 0;
+}
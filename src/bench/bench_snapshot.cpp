@@ -0,0 +1,89 @@
+#include "model/MediaManager.h"
+#include "model/LibraryCache.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+
+/**
+ * Warm startup: JSON tag cache vs mapped library snapshot.
+ * Both start from a 100k-track library whose tags are all known. The cache path
+ * parses the JSON, then rebuilds every entry, the search index and the sort order;
+ * the snapshot path maps one file and restores all three. Stat and directory walk
+ * costs are left out of both (the snapshot pays them later, in the background check).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::string trackPath(const std::string& root, int i) {
+    return root + "/Artist Name " + std::to_string(i % 500) + "/Album Title " +
+           std::to_string(i % 37) + "/" + std::to_string(i % 20 + 1) + " - Song Title " + std::to_string(i) + ".mp3";
+}
+
+int main() {
+    const int LIBRARY_SIZE = 100000;
+    const std::string dir = (std::filesystem::temp_directory_path() / "bench_snapshot").string();
+    const std::string root = dir + "/library"; // Empty on disk: only sets the root path
+    std::filesystem::create_directories(root);
+
+    std::cout << "⏱  Benchmark: warm startup (" << LIBRARY_SIZE << " tracks)" << std::endl;
+
+    TagLibWrapper tagUtil;
+    {
+        LibraryCache cache(dir + "/cache.json");
+        MediaManager library(&tagUtil);
+        library.setSnapshotFile(dir + "/library.snapshot");
+        library.loadFromDirectory(root);
+        for (int i = 0; i < LIBRARY_SIZE; ++i) {
+            auto meta = std::make_unique<AudioMetadata>();
+            meta->title = "Song Title " + std::to_string(i);
+            meta->durationInSeconds = 180 + i % 120;
+            meta->setField("artist", "Artist Name " + std::to_string(i % 500));
+            meta->setField("album", "Album Title " + std::to_string(i % 37));
+            meta->setField("year", std::to_string(1970 + i % 50));
+            cache.store(trackPath(root, i), 4000000 + i, 1700000000, meta.get());
+            library.addMediaFile(std::make_unique<MediaFile>(trackPath(root, i), std::move(meta)));
+        }
+        library.setSortOrder(SortOrder::ARTIST);
+        library.at(0); // Materialise the order so it is saved
+        cache.save();
+        library.saveSnapshot();
+    }
+
+    // --- JSON cache: parse, then rebuild entries, search index and sort order ---
+    auto start = Clock::now();
+    {
+        LibraryCache cache(dir + "/cache.json");
+        cache.load();
+        MediaManager library(&tagUtil);
+        for (int i = 0; i < LIBRARY_SIZE; ++i) {
+            std::unique_ptr<Metadata> meta;
+            std::string path = trackPath(root, i);
+            cache.lookup(path, 4000000 + i, 1700000000, meta);
+            library.addMediaFile(std::make_unique<MediaFile>(path, std::move(meta)));
+        }
+        library.setSortOrder(SortOrder::ARTIST);
+        library.at(0);
+        std::cout << "  > JSON cache: " << msSince(start) << " ms (" << library.getTotalFileCount() << " files)" << std::endl;
+    }
+
+    // --- Snapshot: map and restore ---
+    start = Clock::now();
+    {
+        MediaManager library(&tagUtil);
+        library.setSnapshotFile(dir + "/library.snapshot");
+        library.loadFromSnapshot(root);
+        library.at(0);
+        std::cout << "  > Snapshot:   " << msSince(start) << " ms (" << library.getTotalFileCount() << " files, "
+                  << std::filesystem::file_size(dir + "/library.snapshot") / 1024 << " KiB)" << std::endl;
+        library.cancelBackgroundLoad(); // Skip the check: none of these files exist
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -5,18 +5,29 @@
 #include "utils/DeviceConnector.h"
 #include "utils/USBUtils.h"
 #include "utils/FileUtils.h"
+#include "utils/LibraryWatcher.h"
+#include "utils/TagWriteQueue.h"
+#include "utils/ScanScheduler.h"
 #include "model/MediaManager.h"
 #include "model/PlaylistManager.h"
 #include "model/MediaPlayer.h"
+#include "model/PlaylistFile.h"
+#include "model/LibraryCache.h"
 
 #include "controller/MediaController.h"
 #include "controller/PlaylistController.h"
+#include <algorithm>
+#include <cctype>
 #include <filesystem>
 #include <iostream>
+#include <fstream>
 #include <cstdlib>
+#include <unordered_map>
 #include <unistd.h> 
+#include "nlohmann/json.hpp"
 
 namespace fs = std::filesystem;
+using json = nlohmann::json;
 
 static fs::path getUserMusicRoot() {
     const char* home = getenv("HOME");
@@ -24,14 +35,92 @@ static fs::path getUserMusicRoot() {
     return fs::path(home) / "Music" / "MediaPlayer";
 }
 
+static std::string getPlaylistFilePath(PlaylistFile::Format format) {
+    const char* name = format == PlaylistFile::Format::BINARY ? "playlists.bin" : "playlists.json";
+    return (getUserMusicRoot() / "playlist" / name).string();
+}
+
+// { "playlist_format": "binary", "scan_profile": "accurate", "usb_scan_profile": "fast" }
+// playlist_format is "json" (the default) or "binary"; the scan profiles are "fast",
+// "balanced" or "accurate", by default balanced for the library and fast for sticks.
+static std::string getSettingsFilePath() {
+    return (getUserMusicRoot() / "settings.json").string();
+}
+
+static json readSettings() {
+    std::ifstream inFile(getSettingsFilePath());
+    if (!inFile.is_open()) return json::object();
+    try {
+        json settings = json::parse(inFile);
+        if (settings.is_object()) return settings;
+        std::cerr << "[AppController] Ignoring " << getSettingsFilePath() << ": not an object\n";
+    } catch (const json::exception& e) {
+        std::cerr << "[AppController] Ignoring " << getSettingsFilePath() << ": " << e.what() << "\n";
+    }
+    return json::object();
+}
+
+static PlaylistFile::Format getConfiguredPlaylistFormat(const json& settings) {
+    try {
+        std::string format = settings.value("playlist_format", "json");
+        if (format == "binary") return PlaylistFile::Format::BINARY;
+        if (format != "json") std::cerr << "[AppController] Unknown playlist_format '" << format << "'; using json.\n";
+    } catch (const json::exception& e) {
+        std::cerr << "[AppController] Ignoring playlist_format: " << e.what() << "\n";
+    }
+    return PlaylistFile::Format::JSON;
+}
+
+static ScanProfile getConfiguredScanProfile(const json& settings, const char* key, ScanProfile fallback) {
+    try {
+        if (!settings.contains(key)) return fallback;
+        std::string name = settings.at(key).get<std::string>();
+        for (ScanProfile profile : { ScanProfile::FAST, ScanProfile::BALANCED, ScanProfile::ACCURATE }) {
+            std::string known = TagLibWrapper::getScanProfileName(profile);
+            std::transform(known.begin(), known.end(), known.begin(), [](unsigned char c) { return std::tolower(c); });
+            if (name == known) return profile;
+        }
+        std::cerr << "[AppController] Unknown " << key << " '" << name << "'; using "
+                  << TagLibWrapper::getScanProfileName(fallback) << ".\n";
+    } catch (const json::exception& e) {
+        std::cerr << "[AppController] Ignoring " << key << ": " << e.what() << "\n";
+    }
+    return fallback;
+}
+
+static std::string getLibrarySnapshotPath() {
+    return (getUserMusicRoot() / "library.snapshot").string();
+}
+
+// { "roots": [ "/mnt/disk1/Music", "/mnt/disk2/Music" ] }
+static std::string getLibraryRootsFilePath() {
+    return (getUserMusicRoot() / "library_roots.json").string();
+}
+
 AppController::AppController() {}
-AppController::~AppController() {}
+AppController::~AppController() {
+    // Now, while both libraries are there: the USB one goes before the playlists do
+    if (playlistManager)
+        playlistManager->flushAutoSave();
+    if (mediaManager) {
+        mediaManager->stopHashing(); // Keeps finished hashes for the next run
+        mediaManager->saveSnapshot(); // No-op if the library did not change since the last one
+    }
+    if (libraryCache)
+        libraryCache->save();
+}
 
 bool AppController::init() {
     tagLibWrapper = std::make_unique<TagLibWrapper>();
     sdlWrapper = std::make_unique<SDLWrapper>();
     deviceConnector = std::make_unique<DeviceConnector>();
     usbUtils = std::make_unique<USBUtils>();
+    libraryWatcher = std::make_unique<LibraryWatcher>();
+    tagWriteQueue = std::make_unique<TagWriteQueue>(tagLibWrapper.get());
+    scanScheduler = std::make_unique<ScanScheduler>();
+    if (!libraryWatcher->init()) {
+        std::cerr << "[AppController] Library watcher unavailable; changes on disk need a reload.\n";
+    }
 
     if (!sdlWrapper->init()) {
         std::cerr << "CRITICAL: Failed to initialize SDLWrapper!" << std::endl;
@@ -42,8 +131,23 @@ bool AppController::init() {
     mediaManager = std::make_unique<MediaManager>(tagLibWrapper.get());
     usbMediaManager = std::make_unique<MediaManager>(tagLibWrapper.get());
 
+    libraryCache = std::make_unique<LibraryCache>((getUserMusicRoot() / "library_cache.json").string());
+    libraryCache->load();
+    mediaManager->setLibraryCache(libraryCache.get());
+    usbMediaManager->setLibraryCache(libraryCache.get());
+    mediaManager->setScanScheduler(scanScheduler.get());
+    usbMediaManager->setScanScheduler(scanScheduler.get());
+    mediaManager->setSnapshotFile(getLibrarySnapshotPath());
+    const json settings = readSettings();
+    mediaManager->setScanProfile(getConfiguredScanProfile(settings, "scan_profile", ScanProfile::BALANCED));
+    // Large sticks would otherwise read every tag before the list settles, and VBR
+    // files most of their audio for an exact length; both are filled in afterwards
+    usbMediaManager->setLazyMetadata(true);
+    usbMediaManager->setScanProfile(getConfiguredScanProfile(settings, "usb_scan_profile", ScanProfile::FAST));
+
     playlistManager = std::make_unique<PlaylistManager>(mediaManager.get());
     playlistManager->setUSBMediaManager(usbMediaManager.get());
+    playlistManager->setFileFormat(getConfiguredPlaylistFormat(settings));
 
     mediaController = std::make_unique<MediaController>(
         mediaManager.get(), mediaPlayer.get(),
@@ -55,8 +159,23 @@ bool AppController::init() {
         tagLibWrapper.get(), deviceConnector.get()
     );
 
+    // Edits and tag loads from any view go through the main controller
+    mediaController->setUSBMediaManager(usbMediaManager.get());
+    mediaController->setTagWriteQueue(tagWriteQueue.get());
+    usbmediaController->setTagWriteQueue(tagWriteQueue.get());
+
     playlistController = std::make_unique<PlaylistController>(playlistManager.get());
 
+    // Files removed by incremental updates must not stay referenced by the player or playlists
+    auto onFileRemoved = [this](MediaFile* file) {
+        if (this->mediaPlayer && this->mediaPlayer->getCurrentTrack() == file)
+            this->mediaPlayer->stop();
+        if (this->playlistManager && this->playlistManager->removeTrackFromAll(file))
+            this->playlistsChangedByWatcher = true;
+    };
+    mediaManager->setOnFileRemovedCallback(onFileRemoved);
+    usbMediaManager->setOnFileRemovedCallback(onFileRemoved);
+
     // Callback auto next track
     mediaPlayer->setOnTrackFinishedCallback([this]() {
         if (!this->mediaPlayer) return;
@@ -76,31 +195,111 @@ bool AppController::init() {
     return true;
 }
 
+std::vector<std::string> AppController::getConfiguredLibraryRoots(const std::string& fallback) const {
+    std::vector<std::string> roots;
+    std::ifstream inFile(getLibraryRootsFilePath());
+    if (inFile.is_open()) {
+        try {
+            json jsonData = json::parse(inFile);
+            for (const auto& root : jsonData.value("roots", json::array())) {
+                if (root.is_string() && !root.get<std::string>().empty()) roots.push_back(root.get<std::string>());
+            }
+        } catch (const json::exception& e) {
+            std::cerr << "[AppController] Ignoring " << getLibraryRootsFilePath() << ": " << e.what() << "\n";
+        }
+    }
+    if (roots.empty()) roots.push_back(fallback);
+    return roots;
+}
+
+void AppController::saveLibraryRoots() const {
+    if (!mediaManager) return;
+    std::ofstream outFile(getLibraryRootsFilePath());
+    if (!outFile) {
+        std::cerr << "[AppController] Could not write " << getLibraryRootsFilePath() << "\n";
+        return;
+    }
+    outFile << json{ {"roots", mediaManager->getRoots()} }.dump(2) << std::endl;
+}
+
+void AppController::loadMainLibrary(const std::vector<std::string>& roots) {
+    if (!mediaManager) return;
+    // Watch first: events raised while the scans run stay queued until they finish
+    if (libraryWatcher) {
+        for (const auto& root : roots)
+            libraryWatcher->addRoot(root);
+    }
+    // An intact snapshot of these roots is usable at once and gets checked against the
+    // disk in the background; otherwise every root is scanned by its own worker
+    if (!mediaManager->loadFromSnapshot(roots))
+        mediaManager->startBackgroundLoad(roots);
+    playlistReloadPending = true;
+}
+
+bool AppController::addLibraryRoot(const std::string& path) {
+    if (!mediaManager || !mediaManager->addRoot(path)) return false;
+    if (libraryWatcher)
+        libraryWatcher->addRoot(path);
+    saveLibraryRoots();
+    playlistReloadPending = true; // Tracks on the new root can be resolved now
+    return true;
+}
+
+bool AppController::rescanLibraryRoot(const std::string& path) {
+    return mediaManager && mediaManager->rescanRoot(path);
+}
+
+bool AppController::removeLibraryRoot(const std::string& path) {
+    if (!mediaManager) return false;
+    if (libraryWatcher)
+        libraryWatcher->removeRoot(path);
+    // The removed callback takes the root's tracks out of the playlists in memory. Edits
+    // not written yet go out first, while the tracks are still in them; the reload then
+    // keeps the root's tracks as missing ones (see Playlist::getMissingTracks()), so
+    // later saves write them back, as after a USB eject.
+    if (playlistManager)
+        playlistManager->flushAutoSave();
+    if (!mediaManager->removeRoot(path)) return false;
+    playlistsChangedByWatcher = false;
+    if (playlistManager)
+        loadPlaylists();
+    saveLibraryRoots();
+    if (libraryCache)
+        libraryCache->save();
+    return true;
+}
+
 bool AppController::loadUSBLibrary() {
     if (!usbUtils || !usbMediaManager) return false;
 
+    // Whatever is still being scanned belongs to the stick we had; stop it before looking again
+    usbMediaManager->cancelBackgroundLoad();
+    std::string previousUSBPath = currentUSBPath;
     currentUSBPath = usbUtils->detectUSBMount();
+    if (!previousUSBPath.empty() && previousUSBPath != currentUSBPath && libraryWatcher)
+        libraryWatcher->removeRoot(previousUSBPath);
     if (currentUSBPath.empty()) {
         std::cerr << "[AppController]  No USB detected.\n";
         return false;
     }
 
     std::cout << "[AppController] Loading media from: " << currentUSBPath << std::endl;
-    usbMediaManager->loadFromDirectory(currentUSBPath);
+    if (libraryWatcher)
+        libraryWatcher->addRoot(currentUSBPath);
+    if (tagWriteQueue)
+        tagWriteQueue->setDeviceLimit(currentUSBPath, 1); // Parallel rewrites only thrash flash
+    usbMediaManager->startBackgroundLoad(currentUSBPath);
     usbmediaController = std::make_unique<MediaController>(
         usbMediaManager.get(), mediaPlayer.get(),
         tagLibWrapper.get(), deviceConnector.get()
     );
+    usbmediaController->setTagWriteQueue(tagWriteQueue.get());
 
     if (playlistManager)
         playlistManager->setUSBMediaManager(usbMediaManager.get());
 
-    fs::path root = getUserMusicRoot();
-    fs::path playlistPath = root / "playlist" / "playlists.json";
-    if (playlistManager) {
-        std::cout << "[AppController]  Reloading playlists after USB mount...\n";
-        playlistManager->loadFromFile(playlistPath.string());
-    }
+    // Playlists are re-resolved once the scan has finished (see pollLibraryChanges)
+    playlistReloadPending = true;
     return true;
 }
 
@@ -113,26 +312,209 @@ bool AppController::ejectUSB() {
             mediaPlayer->stop();
     }
 
+    if (usbMediaManager)
+        usbMediaManager->cancelBackgroundLoad(); // The scan must not hold files open on the stick
+    if (tagWriteQueue)
+        tagWriteQueue->flush(currentUSBPath); // Edits to files on the stick land before it goes
+    if (playlistManager)
+        playlistManager->flushAutoSave(); // With the stick's tracks, which the reload below drops
+    if (libraryWatcher)
+        libraryWatcher->removeRoot(currentUSBPath);
+
     bool ok = usbUtils->unmountUSB(currentUSBPath);
 
-    if (ok && usbMediaManager ) {
-        usbMediaManager->clearLibrary();
+    if (ok) {
+        if (usbMediaManager)
+            usbMediaManager->clearLibrary();
         std::cout << "[AppController]  USB unmounted safely.\n";
 
-        fs::path root = getUserMusicRoot();
-        fs::path playlistPath = root / "playlist" / "playlists.json";
         if (playlistManager) {
             std::cout << "[AppController] Reloading playlists after USB eject...\n";
-            playlistManager->loadFromFile(playlistPath.string());
+            loadPlaylists();
         }
+        currentUSBPath.clear();
     } else {
         std::cerr << "[AppController] Failed to unmount USB.\n";
+        // Still mounted: watch it again and finish the scan cancelled above, with what changed meanwhile
+        if (libraryWatcher)
+            libraryWatcher->addRoot(currentUSBPath);
+        if (usbMediaManager && !usbMediaManager->rescanRoot(currentUSBPath))
+            usbMediaManager->startBackgroundLoad(currentUSBPath);
     }
-
-    currentUSBPath.clear();
     return ok;
 }
 
+void AppController::loadPlaylists() {
+    PlaylistFile::Format format = playlistManager->getFileFormat();
+    std::string path = getPlaylistFilePath(format);
+    PlaylistFile::Format other = format == PlaylistFile::Format::BINARY ? PlaylistFile::Format::JSON : PlaylistFile::Format::BINARY;
+    std::string otherPath = getPlaylistFilePath(other);
+    // After playlist_format changed the playlists are still in the file of the old one.
+    // If moving them fails, they stay there and are used from there.
+    std::error_code ec;
+    if (!fs::exists(path, ec) && fs::exists(otherPath, ec))
+        playlistManager->migrateFile(otherPath, path);
+    else
+        playlistManager->loadFromFile(path);
+}
+
+MediaManager* AppController::managerForPath(const std::string& path) const {
+    if (usbMediaManager && usbMediaManager->ownsPath(path)) return usbMediaManager.get();
+    if (mediaManager && mediaManager->ownsPath(path)) return mediaManager.get();
+    return nullptr;
+}
+
+bool AppController::pollLibraryChanges() {
+    bool changed = false;
+    if (mediaManager && mediaManager->applyPendingFiles()) changed = true;
+    if (usbMediaManager && usbMediaManager->applyPendingFiles()) changed = true;
+
+    if (tagWriteQueue) {
+        for (const auto& result : tagWriteQueue->takeResults()) {
+            std::string name = fs::path(result.path).filename().string();
+            if (result.ok) {
+                tagWriteStatus = "Saved tags: " + name;
+            } else {
+                std::cerr << "[AppController] Could not save tags to " << result.path << "\n";
+                tagWriteStatus = "Could not save tags: " + name;
+                // Show what the file really holds again, unless a newer edit is on its way
+                MediaManager* manager = managerForPath(result.path);
+                if (manager && !tagWriteQueue->isPending(result.path)) manager->addOrUpdateFile(result.path);
+            }
+            changed = true;
+        }
+    }
+
+    if (playlistManager)
+        playlistManager->saveIfDue();
+    if (libraryCache)
+        libraryCache->saveIfDue();
+
+    // Playlists can be edited as soon as the main library is there. Tracks on a stick
+    // still scanning stay missing until the reload once it is done resolves them.
+    bool usbLoading = usbMediaManager && usbMediaManager->isLoading();
+    if (playlistReloadPending && playlistManager && !(mediaManager && mediaManager->isLoading())
+        && (!playlistManager->isLoaded() || !usbLoading)) {
+        std::cout << "[AppController] Library loaded, loading playlists...\n";
+        loadPlaylists();
+        playlistReloadPending = usbLoading;
+        changed = true;
+    }
+
+    if (!libraryWatcher) return changed;
+
+    // Held-back events first, so each library sees its events in order
+    std::vector<LibraryEvent> events;
+    events.swap(deferredEvents);
+    std::vector<LibraryEvent> polled = libraryWatcher->poll();
+    events.insert(events.end(), std::make_move_iterator(polled.begin()), std::make_move_iterator(polled.end()));
+
+    // Deletes in a row are removed in one pass per library: a folder's worth one at a time is quadratic
+    std::unordered_map<MediaManager*, std::vector<std::string>> deletions;
+    auto removeDeleted = [&deletions]() {
+        for (auto& [manager, paths] : deletions) manager->removeFiles(paths);
+        deletions.clear();
+    };
+    bool applied = false;
+    for (auto& event : events) {
+        if (waitsForScan(event)) {
+            deferredEvents.push_back(std::move(event)); // Its scan would race them
+            continue;
+        }
+        applied = true;
+        if (event.type == LibraryEvent::FILE_DELETED) {
+            if (MediaManager* manager = managerForPath(event.path)) deletions[manager].push_back(event.path);
+            continue;
+        }
+        removeDeleted(); // Before anything that may come back under the same name
+        applyLibraryEvent(event);
+    }
+    removeDeleted();
+    if (!applied) return changed;
+
+    if (libraryCache)
+        libraryCache->saveLater(); // A bulk tag edit sends an event per file
+    if (playlistsChangedByWatcher && playlistManager) {
+        playlistManager->autoSave();
+        playlistsChangedByWatcher = false;
+    }
+    return true;
+}
+
+bool AppController::waitsForScan(const LibraryEvent& event) const {
+    if (event.type == LibraryEvent::QUEUE_OVERFLOW) return isLibraryLoading(); // Resyncs both
+    MediaManager* manager = managerForPath(event.path);
+    MediaManager* oldManager = event.oldPath.empty() ? nullptr : managerForPath(event.oldPath);
+    return (manager && manager->isLoading()) || (oldManager && oldManager->isLoading());
+}
+
+void AppController::applyLibraryEvent(const LibraryEvent& event) {
+    MediaManager* manager = managerForPath(event.path);
+    MediaManager* oldManager = event.oldPath.empty() ? nullptr : managerForPath(event.oldPath);
+
+    switch (event.type) {
+        case LibraryEvent::FILE_CHANGED:
+            // One of our own writes, with another queued: the last one sends its own event
+            if (tagWriteQueue && tagWriteQueue->isPending(event.path)) break;
+            if (manager) manager->addOrUpdateFile(event.path);
+            break;
+
+        case LibraryEvent::FILE_DELETED:
+            if (manager) manager->removeFile(event.path);
+            break;
+
+        case LibraryEvent::FILE_RENAMED:
+            if (oldManager && oldManager == manager && FileUtils::isMediaFile(event.path)
+                && oldManager->renameFile(event.oldPath, event.path)) {
+                break;
+            }
+            // Renamed to/from a non-media name or across roots: treat as remove + add
+            if (oldManager) oldManager->removeFile(event.oldPath);
+            if (manager && FileUtils::isMediaFile(event.path)) manager->addOrUpdateFile(event.path);
+            break;
+
+        case LibraryEvent::DIR_DELETED:
+            if (manager) manager->removeFilesUnder(event.path);
+            break;
+
+        case LibraryEvent::DIR_RENAMED:
+            if (oldManager && oldManager == manager) {
+                manager->renameDirectory(event.oldPath, event.path);
+            } else {
+                if (oldManager) oldManager->removeFilesUnder(event.oldPath);
+                if (manager) {
+                    for (const auto& file : FileUtils::getMediaFilesRecursive(event.path))
+                        manager->addOrUpdateFile(file);
+                }
+            }
+            break;
+
+        case LibraryEvent::QUEUE_OVERFLOW:
+            std::cerr << "[AppController] Watcher queue overflowed, resyncing libraries.\n";
+            if (mediaManager) mediaManager->syncWithDirectory();
+            if (usbMediaManager && !currentUSBPath.empty()) usbMediaManager->syncWithDirectory();
+            break;
+    }
+}
+
+void AppController::focusLibrary(MediaManager* visible) {
+    for (MediaManager* manager : { mediaManager.get(), usbMediaManager.get() }) {
+        if (!manager) continue;
+        manager->setScanPriority(!visible ? ScanPriority::NORMAL
+                                 : manager == visible ? ScanPriority::FOREGROUND : ScanPriority::BACKGROUND);
+    }
+}
+
+const std::string& AppController::getTagWriteStatus() const {
+    static const std::string saving = "Saving tags...";
+    return tagWriteQueue && tagWriteQueue->getPendingCount() > 0 ? saving : tagWriteStatus;
+}
+
+bool AppController::isLibraryLoading() const {
+    return (mediaManager && mediaManager->isLoading()) ||
+           (usbMediaManager && usbMediaManager->isLoading());
+}
+
 // Getters
 MediaManager* AppController::getMediaManager() const { return mediaManager.get(); }
 PlaylistManager* AppController::getPlaylistManager() const { return playlistManager.get(); }
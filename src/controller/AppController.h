@@ -1,6 +1,7 @@
 #pragma once
 #include <memory> 
 #include <string>
+#include <vector>
 class MediaManager;
 class PlaylistManager;
 class MediaPlayer;
@@ -11,6 +12,11 @@ class TagLibWrapper;
 class SDLWrapper;
 class DeviceConnector;
 class USBUtils;
+class LibraryCache;
+class LibraryWatcher;
+class TagWriteQueue;
+class ScanScheduler;
+struct LibraryEvent;
 
 class AppController {
 public:
@@ -26,24 +32,57 @@ public:
     PlaylistController* getPlaylistController() const;
     MediaManager* getUSBMediaManager() const;
     MediaController* getusbmediaController() const;
-    bool loadUSBLibrary();
-    bool ejectUSB();
+    // Main library roots, from library_roots.json in the user's music folder;
+    // 'fallback' alone if that lists none
+    std::vector<std::string> getConfiguredLibraryRoots(const std::string& fallback) const;
+    void loadMainLibrary(const std::vector<std::string>& roots);
+    // Change one root of the main library without touching the others. Adding and
+    // dropping also update library_roots.json.
+    bool addLibraryRoot(const std::string& path);
+    bool rescanLibraryRoot(const std::string& path);
+    bool removeLibraryRoot(const std::string& path);
+    bool loadUSBLibrary(); // Cancels a scan of a previous stick first
+    bool ejectUSB(); // If the unmount fails, the stick stays loaded and its scan resumes
+    // Scans of the library on screen go first; nullptr when neither is shown
+    void focusLibrary(MediaManager* visible);
+    // Called every UI tick: merges background-load batches, loads playlists once the main
+    // library is ready (again once a stick's scan finishes, for its tracks), then applies
+    // filesystem events; those of a library still scanning wait for it. True if anything
+    // visible changed.
+    bool pollLibraryChanges();
+    bool isLibraryLoading() const;
+    // "Saving tags..." while edits are being written, then how the last write went
+    const std::string& getTagWriteStatus() const;
     public:
 
 
 private:
+    MediaManager* managerForPath(const std::string& path) const;
+    void saveLibraryRoots() const;
+    void applyLibraryEvent(const LibraryEvent& event);
+    bool waitsForScan(const LibraryEvent& event) const; // Its library is scanning
+    void loadPlaylists(); // From the file of the configured format, moving them there if needed
+
     std::string currentUSBPath;
+    bool playlistsChangedByWatcher = false;
+    bool playlistReloadPending = false;
+    std::vector<LibraryEvent> deferredEvents; // For a library that was scanning, in order
+    std::string tagWriteStatus;
     // --- Ownership Utils ---
     std::unique_ptr<TagLibWrapper> tagLibWrapper;
     std::unique_ptr<SDLWrapper> sdlWrapper;
     std::unique_ptr<DeviceConnector> deviceConnector;
     std::unique_ptr<USBUtils> usbUtils;
+    std::unique_ptr<LibraryWatcher> libraryWatcher;
+    std::unique_ptr<TagWriteQueue> tagWriteQueue; // After tagLibWrapper: finishes its writes before that goes
+    std::unique_ptr<ScanScheduler> scanScheduler; // Outlives the libraries, whose workers use it
 
     // --- Ownership Model ---
     std::unique_ptr<MediaManager> mediaManager;
     std::unique_ptr<PlaylistManager> playlistManager;
     std::unique_ptr<MediaPlayer> mediaPlayer;
     std::unique_ptr<MediaManager> usbMediaManager;
+    std::unique_ptr<LibraryCache> libraryCache;
 
     // --- Ownership Controller ---
     std::unique_ptr<MediaController> mediaController;
@@ -2,6 +2,7 @@
 #include "model/MediaFile.h"
 #include "model/Metadata.h"
 #include "model/Playlist.h" 
+#include "utils/TagWriteQueue.h"
 #include <iostream> 
 
 MediaController::MediaController(MediaManager* manager, MediaPlayer* player, 
@@ -21,6 +22,7 @@ MediaController::MediaController(MediaManager* manager, MediaPlayer* player,
 void MediaController::playTrack(MediaFile* file) {
     std::cout << "MediaController: playTrack called for " << (file ? file->getFileName() : "nullptr") << std::endl;
     if (mediaPlayer && file) {
+        ensureMetadata(file);
         mediaPlayer->play(file, nullptr);
     } else {
         std::cerr << "MediaController: Cannot play track (null player or file)." << std::endl;
@@ -57,17 +59,19 @@ void MediaController::loadMediaFromPath(const std::string& path) {
 
 MediaFile* MediaController::findAdjacentTrack(int offset) {
     if (!mediaPlayer || !mediaManager) return nullptr;
+    return findAdjacentTrack(mediaPlayer->getCurrentTrack(), mediaPlayer->getActivePlaylist(),
+                             mediaManager, usbMediaManager, offset);
+}
 
-    MediaFile* currentTrack = mediaPlayer->getCurrentTrack();
-    if (!currentTrack) return nullptr;
+MediaFile* MediaController::findAdjacentTrack(MediaFile* current, Playlist* playlist, MediaManager* library,
+                                              MediaManager* usbLibrary, int offset) {
+    if (!current) return nullptr;
 
-    Playlist* activePlaylist = mediaPlayer->getActivePlaylist();
-    if (activePlaylist) {
-        std::cout << "[DEBUG] findAdjacentTrack: In Playlist context." << std::endl;
-        const auto& tracks = activePlaylist->getTracks();
+    if (playlist) {
+        const auto& tracks = playlist->getTracks();
         if (tracks.empty()) return nullptr;
 
-        auto it = std::find(tracks.begin(), tracks.end(), currentTrack);
+        auto it = std::find(tracks.begin(), tracks.end(), current);
         if (it == tracks.end()) {
              std::cerr << "ERROR: Current track not found in active playlist!" << std::endl;
              return nullptr;
@@ -76,40 +80,25 @@ MediaFile* MediaController::findAdjacentTrack(int offset) {
         int currentIndex = std::distance(tracks.begin(), it);
         int totalTracks = tracks.size();
         
-        int nextIndex = (currentIndex + offset + totalTracks) % totalTracks;
+        int nextIndex = (currentIndex + offset % totalTracks + totalTracks) % totalTracks;
         
         return tracks[nextIndex];
         
     } else {
-        std::cout << "[DEBUG] findAdjacentTrack: In Library context (inefficient)." << std::endl;
-        int totalFiles = mediaManager->getTotalFileCount();
-        if (totalFiles <= 1) return nullptr;
-
-        int currentIndex = -1;
-        int pageSize = 25; 
-        int totalPages = mediaManager->getTotalPages(pageSize);
-        for (int p = 1; p <= totalPages; ++p) {
-            std::vector<MediaFile*> page = mediaManager->getPage(p, pageSize);
-            for(size_t i = 0; i < page.size(); ++i) {
-                if (page[i] == currentTrack) {
-                    currentIndex = (p - 1) * pageSize + i;
-                    goto found_index_library;
-                }
-            }
+        // Follow the library the track came from, in its current sort order
+        if (!library) return nullptr;
+        int currentIndex = library->indexOf(current);
+        if (currentIndex == -1 && usbLibrary) {
+            library = usbLibrary;
+            currentIndex = library->indexOf(current);
         }
-
-    found_index_library:
         if (currentIndex == -1) return nullptr;
-        int nextIndex = (currentIndex + offset + totalFiles) % totalFiles;
-        int targetPage = (nextIndex / pageSize) + 1;
-        int indexOnPage = nextIndex % pageSize;
-        std::vector<MediaFile*> targetPageData = mediaManager->getPage(targetPage, pageSize);
-        if (indexOnPage >= 0 && (size_t)indexOnPage < targetPageData.size()) {
-            return targetPageData[indexOnPage];
-        }
+
+        int totalFiles = library->getTotalFileCount();
+        if (totalFiles <= 1) return nullptr;
+        int nextIndex = (currentIndex + offset % totalFiles + totalFiles) % totalFiles;
+        return library->at(nextIndex);
     }
-    
-    return nullptr;
 }
 
 
@@ -118,6 +107,7 @@ void MediaController::nextTrack() {
     std::cout << "MediaController: nextTrack called." << std::endl;
     MediaFile* next = findAdjacentTrack(1); // Get the next track (+1 offset)
     if (next) {
+        ensureMetadata(next);
         if (mediaPlayer->getActivePlaylist()) {
             mediaPlayer->play(next, mediaPlayer->getActivePlaylist());
         } else {
@@ -132,6 +122,7 @@ void MediaController::previousTrack() {
     std::cout << "MediaController: previousTrack called." << std::endl;
     MediaFile* prev = findAdjacentTrack(-1); // Get the previous track (-1 offset)
     if (prev) {
+        ensureMetadata(prev);
         if (mediaPlayer->getActivePlaylist()) {
             mediaPlayer->play(prev, mediaPlayer->getActivePlaylist());
         } else {
@@ -182,25 +173,96 @@ void MediaController::playPlaylist(Playlist* playlist, int startIndex) {
               << "', starting at track " << startIndex << std::endl;
               
     // call play, input playlist as context
+    ensureMetadata(fileToPlay);
     mediaPlayer->play(fileToPlay, playlist); 
 }
 
-bool MediaController::saveMetadataChanges(MediaFile* file) {
+bool MediaController::saveMetadataChanges(MediaFile* file, const Metadata& before) {
     if (!file || !file->getMetadata() || !tagUtil) {
         std::cerr << "MediaController: Cannot save metadata (null pointers)." << std::endl;
         return false;
     }
-    
+    bool changed = false;
+    bool success = writeTagChanges(file, before, changed);
+    if (changed) notifyMetadataChanged({ file });
+    return success;
+}
+
+bool MediaController::saveBulkMetadataChanges(const std::vector<MediaFile*>& files, const Metadata& changes,
+                                              unsigned fields) {
+    if (!tagUtil) {
+        std::cerr << "MediaController: Cannot save metadata (null pointers)." << std::endl;
+        return false;
+    }
+    bool allSaved = true;
+    std::vector<MediaFile*> edited;
+    for (MediaFile* file : files) {
+        if (!file || !file->getMetadata()) continue;
+        Metadata* meta = file->getMetadata();
+        const Metadata before = *meta;
+        if (fields & TagLibWrapper::TITLE) meta->title = changes.title;
+        if (fields & TagLibWrapper::ARTIST) meta->setArtist(changes.getArtist());
+        if (fields & TagLibWrapper::ALBUM) meta->setAlbum(changes.getAlbum());
+        if (fields & TagLibWrapper::GENRE) meta->setGenre(changes.getGenre());
+        if (fields & TagLibWrapper::YEAR) meta->setYear(changes.getYear());
+        // Files that already had these values are skipped there
+        bool changed = false;
+        if (!writeTagChanges(file, before, changed)) allSaved = false;
+        if (changed) edited.push_back(file);
+    }
+    notifyMetadataChanged(edited); // Re-sorted once for the lot, not once per file
+    return allSaved;
+}
+
+bool MediaController::writeTagChanges(MediaFile* file, const Metadata& before, bool& changed) {
     Metadata* meta = file->getMetadata();
-    
-    bool success = tagUtil->writeTags(file->getFilePath(), meta);
-    
+    unsigned fields = TagLibWrapper::changedFields(before, *meta);
+    changed = fields != 0;
+    if (!changed) return true; // Saved without changes: leave the file alone
+
+    // Queued writes report back through TagWriteQueue::takeResults()
+    bool success = tagWriteQueue ? tagWriteQueue->enqueue(file->getFilePath(), *meta, fields)
+                                 : tagUtil->writeTags(file->getFilePath(), meta, fields);
     if (!success) {
        std::cerr << "MediaController: Failed to write tags to file: " << file->getFilePath() << std::endl;
     }
     return success;
 }
 
+void MediaController::notifyMetadataChanged(const std::vector<MediaFile*>& files) {
+    // The in-memory tags changed whether or not the write worked; keep search results in step
+    for (MediaManager* manager : { mediaManager, usbMediaManager }) {
+        if (!manager) continue;
+        std::vector<MediaFile*> own;
+        for (MediaFile* file : files) {
+            if (manager->findFileByPath(file->getFilePath()) == file) own.push_back(file);
+        }
+        if (!own.empty()) manager->notifyMetadataChanged(own);
+    }
+}
+
+void MediaController::ensureMetadata(MediaFile* file) {
+    if (!file || !file->isMetadataPending()) return;
+    for (MediaManager* manager : { mediaManager, usbMediaManager }) {
+        if (manager && manager->findFileByPath(file->getFilePath()) == file) {
+            manager->ensureMetadata(file);
+            return;
+        }
+    }
+}
+
+void MediaController::ensureMetadata(const std::vector<MediaFile*>& files) {
+    // One parallel read per library instead of one file after another
+    for (MediaManager* manager : { mediaManager, usbMediaManager }) {
+        if (!manager) continue;
+        std::vector<MediaFile*> own;
+        for (MediaFile* file : files) {
+            if (file && file->isMetadataPending() && manager->findFileByPath(file->getFilePath()) == file) own.push_back(file);
+        }
+        if (!own.empty()) manager->ensureMetadata(MediaFileRange{ own.data(), own.size() });
+    }
+}
+
 void MediaController::onDevicePlayPause() {
     std::cout << "MediaController: onDevicePlayPause received." << std::endl;
     pauseOrResume();
@@ -213,3 +275,4 @@ void MediaController::sendSongInfoToDevice(MediaFile* file) {}
 int MediaController::convertAdcToVolume(int adcValue) { return 50; }
 
 void MediaController::setUSBMediaManager(MediaManager* usbMgr) { usbMediaManager = usbMgr; }
+void MediaController::setTagWriteQueue(TagWriteQueue* queue) { tagWriteQueue = queue; }
@@ -8,6 +8,7 @@
 
 class Playlist;
 class Metadata;
+class TagWriteQueue;
 
 class MediaController {
 public:
@@ -19,7 +20,16 @@ public:
     void stop();
     void setVolume(int volume);
     void loadMediaFromPath(const std::string& path);
-    bool saveMetadataChanges(MediaFile* file);
+    // Writes the fields an edit changed ('before' is the metadata as it was before the
+    // edit). Queued when a write queue is set, otherwise written now. Unchanged files
+    // are not touched. False if the write failed or could not be queued.
+    bool saveMetadataChanges(MediaFile* file, const Metadata& before);
+    // Applies the 'fields' of 'changes' to every file (bulk edit), then saves each as
+    // above. The writes run in parallel on the queue. False if any could not be saved.
+    bool saveBulkMetadataChanges(const std::vector<MediaFile*>& files, const Metadata& changes, unsigned fields);
+    void setTagWriteQueue(TagWriteQueue* queue);
+    void ensureMetadata(MediaFile* file); // Reads tags a lazy library has not loaded yet
+    void ensureMetadata(const std::vector<MediaFile*>& files); // Same for several, in parallel
 
     void nextTrack();
     void previousTrack();
@@ -31,8 +41,15 @@ public:
     void onDevicePrevious();
     void onDeviceVolumeChange(int adcValue); // Raw value from ADC
     void playPlaylist(Playlist* playlist, int startIndex = 0);
+
+    // The track 'offset' steps from 'current', wrapping around: within 'playlist' if set,
+    // otherwise in whichever library holds 'current', in its sort order. nullptr if none.
+    static MediaFile* findAdjacentTrack(MediaFile* current, Playlist* playlist, MediaManager* library,
+                                        MediaManager* usbLibrary, int offset);
 private:
     void sendSongInfoToDevice(MediaFile* file);
+    bool writeTagChanges(MediaFile* file, const Metadata& before, bool& changed);
+    void notifyMetadataChanged(const std::vector<MediaFile*>& files); // In each owning library, one pass each
     
     int convertAdcToVolume(int adcValue);
 
@@ -41,5 +58,6 @@ private:
     MediaPlayer* mediaPlayer;
     MediaFile* findAdjacentTrack(int offset); 
     TagLibWrapper* tagUtil;
+    TagWriteQueue* tagWriteQueue = nullptr; // Optional, non-owning
     DeviceConnector* deviceConnector;
 };
\ No newline at end of file
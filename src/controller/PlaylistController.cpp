@@ -10,59 +10,56 @@ PlaylistController::PlaylistController(PlaylistManager* manager)
     }
 }
 
+// Edits before the playlist file is loaded would be overwritten by the load (or clobber the file on auto-save)
+bool PlaylistController::isReady() const {
+    if (playlistManager == nullptr) return false;
+    if (!playlistManager->isLoaded()) {
+        std::cerr << "Controller Error: Playlists are not loaded yet (library still scanning)." << std::endl;
+        return false;
+    }
+    return true;
+}
+
 // createPlaylist 
 bool PlaylistController::createPlaylist(const std::string& name) {
+    if (!isReady()) return false;
     if (name.empty()) {
         std::cerr << "Controller Error: Playlist name cannot be empty." << std::endl;
         return false;
     }
-    Playlist* p = playlistManager->createPlaylist(name);
-    //return (p != nullptr);
-    if (p) {
-        playlistManager->autoSave(); 
-        return true;
-    }
-    return false;
+    Playlist* p = playlistManager->createPlaylist(name); // Journaled by the manager
+    return (p != nullptr);
 }
 
 // deletePlaylist
 bool PlaylistController::deletePlaylist(const std::string& name) {
+    if (!isReady()) return false;
     if (name.empty()) {
         return false;
     }
     
-    bool success = playlistManager->deletePlaylist(name);
-    if (success) {
-        playlistManager->autoSave(); 
-    }
-    return success;
+    return playlistManager->deletePlaylist(name);
 }
 
 // addTrackToPlaylist 
 bool PlaylistController::addTrackToPlaylist(MediaFile* file, Playlist* playlist) {
+    if (!isReady()) return false;
     if (file == nullptr || playlist == nullptr) {
         std::cerr << "Controller Error: Cannot add null track or to null playlist." << std::endl;
         return false;
     }
     
-    playlist->addTrack(file); 
-    
-    //add logic to save the playlist to file
-    playlistManager->autoSave();
-    
+    playlistManager->addTrack(playlist, file); // False (and nothing to save) if it was there already
     return true;
 }
 
 bool PlaylistController::removeTrackFromPlaylist(MediaFile* file, Playlist* playlist) {
+    if (!isReady()) return false;
     if (file == nullptr || playlist == nullptr) {
         std::cerr << "Controller Error: Cannot remove null track or from null playlist." << std::endl;
         return false;
     }
     
-    bool success = playlist->removeTrack(file);
-    if (success) {
-        playlistManager->autoSave();
-    }
-    return success;
+    return playlistManager->removeTrack(playlist, file);
 }
 
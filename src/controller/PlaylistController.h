@@ -12,6 +12,8 @@ public:
     bool addTrackToPlaylist(MediaFile* file, Playlist* playlist);
     bool removeTrackFromPlaylist(MediaFile* file, Playlist* playlist);
 private:
+    bool isReady() const;
+
     PlaylistManager* playlistManager; // Non-owning pointer
 
 };
\ No newline at end of file
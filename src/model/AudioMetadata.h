@@ -1,11 +1,8 @@
 #pragma once
 #include "Metadata.h"
 
+// Artist, album, genre and year live in Metadata as typed fields
 class AudioMetadata : public Metadata {
 public:
-    std::string artist;
-    std::string album;
-    std::string genre;
-    int year;
     std::string publisher;
-};
\ No newline at end of file
+};
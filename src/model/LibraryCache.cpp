@@ -0,0 +1,251 @@
+#include "model/LibraryCache.h"
+#include "model/AudioMetadata.h"
+#include "utils/FileUtils.h"
+#include <iostream>
+#include <fstream>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    const int CACHE_FORMAT_VERSION = 2; // Bump when the entry layout changes
+}
+
+LibraryCache::LibraryCache(const std::string& cacheFilePath)
+    : cacheFilePath(cacheFilePath), dirty(false), saveWanted(false)
+{}
+
+bool LibraryCache::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    dirty = false;
+
+    std::ifstream inFile(cacheFilePath);
+    if (!inFile.is_open()) {
+        std::cout << "LibraryCache Info: No cache file at " << cacheFilePath << ". Starting fresh." << std::endl;
+        return false;
+    }
+
+    try {
+        json jsonData = json::parse(inFile);
+        if (!jsonData.is_object() || jsonData.value("version", 0) != CACHE_FORMAT_VERSION || !jsonData.contains("entries")) {
+            std::cerr << "LibraryCache Warning: Ignoring cache with unknown format: " << cacheFilePath << std::endl;
+            return false;
+        }
+
+        for (const auto& [path, obj] : jsonData["entries"].items()) {
+            Entry entry;
+            entry.size = obj.value("size", 0LL);
+            entry.mtime = obj.value("mtime", 0LL);
+            entry.failed = obj.value("failed", false);
+            if (!entry.failed) {
+                entry.isAudio = obj.value("audio", false);
+                entry.title = obj.value("title", "");
+                entry.durationInSeconds = obj.value("duration", 0);
+                entry.fileSizeInBytes = obj.value("bytes", 0L);
+                entry.contentHash = obj.value("hash", uint64_t(0));
+                entry.estimated = obj.value("estimated", false);
+                if (obj.contains("fields") && obj["fields"].is_object()) {
+                    entry.fields = obj["fields"].get<std::map<std::string, std::string>>();
+                }
+            }
+            entries.emplace(path, std::move(entry));
+        }
+        std::cout << "LibraryCache: Loaded " << entries.size() << " entries from " << cacheFilePath << std::endl;
+        return true;
+    } catch (const json::exception& e) {
+        std::cerr << "LibraryCache Error: Failed to parse cache file " << cacheFilePath << ": " << e.what() << std::endl;
+        entries.clear();
+        return false;
+    }
+}
+
+void LibraryCache::saveLater() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    if (!saveWanted) firstSaveLater = now;
+    lastSaveLater = now;
+    saveWanted = true;
+}
+
+bool LibraryCache::saveIfDue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!saveWanted) return false;
+        Clock::time_point now = Clock::now();
+        if (now - lastSaveLater < SAVE_DELAY && now - firstSaveLater < SAVE_DELAY * 10) return false;
+    }
+    save();
+    return true;
+}
+
+bool LibraryCache::save() {
+    // Only one save writes at a time, and it copies the entries after the one before it:
+    // the file on disk never goes back to an older copy
+    std::lock_guard<std::mutex> saveLock(saveMutex);
+    std::map<std::string, Entry> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        saveWanted = false;
+        if (!dirty) return true;
+        snapshot = entries; // The scan workers keep storing while this one is written
+        dirty = false;
+    }
+
+    bool ok = false;
+    try {
+        json entriesObj = json::object();
+        for (const auto& [path, entry] : snapshot) {
+            json obj;
+            obj["size"] = entry.size;
+            obj["mtime"] = entry.mtime;
+            if (entry.failed) {
+                obj["failed"] = true;
+            } else {
+                obj["audio"] = entry.isAudio;
+                obj["title"] = entry.title;
+                obj["duration"] = entry.durationInSeconds;
+                obj["bytes"] = entry.fileSizeInBytes;
+                if (entry.contentHash != 0) obj["hash"] = entry.contentHash;
+                if (entry.estimated) obj["estimated"] = true;
+                obj["fields"] = entry.fields;
+            }
+            entriesObj[path] = std::move(obj);
+        }
+
+        json jsonData;
+        jsonData["version"] = CACHE_FORMAT_VERSION;
+        jsonData["entries"] = std::move(entriesObj);
+
+        // Invalid UTF-8 in tags must not make the whole cache unwritable
+        ok = FileUtils::writeFileAtomically(cacheFilePath, [&jsonData](std::ostream& out) {
+            out << jsonData.dump(-1, ' ', false, json::error_handler_t::replace);
+        });
+        if (ok) std::cout << "LibraryCache: Saved " << snapshot.size() << " entries to " << cacheFilePath << std::endl;
+    } catch (const json::exception& e) {
+        std::cerr << "LibraryCache Error: Failed to serialize JSON: " << e.what() << std::endl;
+    }
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dirty = true; // Try again with the next save
+    }
+    return ok;
+}
+
+bool LibraryCache::lookup(const std::string& path, long long size, long long mtime, std::unique_ptr<Metadata>& out,
+                          uint64_t* contentHash) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it == entries.end()) return false;
+
+    const Entry& entry = it->second;
+    if (entry.size != size || entry.mtime != mtime) return false; // Stale
+    if (contentHash) *contentHash = entry.contentHash;
+
+    if (entry.failed) {
+        out = nullptr;
+        return true;
+    }
+
+    if (entry.isAudio) {
+        out = std::make_unique<AudioMetadata>();
+    } else {
+        out = std::make_unique<Metadata>();
+    }
+    for (const auto& [key, value] : entry.fields) {
+        out->setField(key, value);
+    }
+    out->title = entry.title;
+    out->durationInSeconds = entry.durationInSeconds;
+    out->fileSizeInBytes = entry.fileSizeInBytes;
+    out->estimated = entry.estimated;
+    return true;
+}
+
+bool LibraryCache::getStat(const std::string& path, long long& size, long long& mtime) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it == entries.end()) return false;
+    size = it->second.size;
+    mtime = it->second.mtime;
+    return true;
+}
+
+void LibraryCache::store(const std::string& path, long long size, long long mtime, const Metadata* metadata) {
+    if (metadata == nullptr) {
+        storeFailure(path, size, mtime);
+        return;
+    }
+
+    Entry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.isAudio = dynamic_cast<const AudioMetadata*>(metadata) != nullptr;
+    entry.title = metadata->title;
+    entry.durationInSeconds = metadata->durationInSeconds;
+    entry.fileSizeInBytes = metadata->fileSizeInBytes;
+    entry.fields = metadata->getFields();
+    entry.estimated = metadata->estimated;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it != entries.end() && !it->second.failed && it->second.size == size && it->second.mtime == mtime) {
+        entry.contentHash = it->second.contentHash; // Same file re-read (e.g. refined): the audio is unchanged
+    }
+    entries[path] = std::move(entry);
+    dirty = true;
+}
+
+void LibraryCache::storeFailure(const std::string& path, long long size, long long mtime) {
+    Entry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.failed = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[path] = std::move(entry);
+    dirty = true;
+}
+
+void LibraryCache::storeContentHash(const std::string& path, long long size, long long mtime, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.failed || it->second.size != size || it->second.mtime != mtime) return;
+    if (it->second.contentHash != hash) {
+        it->second.contentHash = hash;
+        dirty = true;
+    }
+}
+
+void LibraryCache::remove(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.erase(path) > 0) {
+        dirty = true;
+    }
+}
+
+void LibraryCache::prune(const std::string& rootPath, const std::unordered_set<std::string>& seenPaths) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // std::map is ordered, so every path under rootPath is in one contiguous range. The
+    // slash keeps a sibling root sharing the name's start ("/mnt/disk10") out of it.
+    std::string prefix = rootPath;
+    if (prefix.empty() || prefix.back() != '/') prefix += '/';
+    auto it = entries.lower_bound(prefix);
+    while (it != entries.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        if (seenPaths.count(it->first) == 0) {
+            it = entries.erase(it);
+            dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t LibraryCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+const std::string& LibraryCache::getFilePath() const {
+    return cacheFilePath;
+}
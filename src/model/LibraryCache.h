@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+#include "Metadata.h"
+
+// On-disk cache of parsed tags, keyed by file path and validated by size + mtime.
+// Files TagLib could not parse are remembered too, so they are not retried on every start.
+class LibraryCache {
+public:
+    explicit LibraryCache(const std::string& cacheFilePath);
+
+    bool load();
+    bool save(); // No-op if nothing changed since the last load/save
+    // For a stream of small changes (library watcher events, our own tag writes): save()
+    // once no saveLater() came for SAVE_DELAY, or they have gone on for ten times that
+    void saveLater();
+    bool saveIfDue(); // Polled by the UI loop; true if it saved
+
+    static constexpr std::chrono::milliseconds SAVE_DELAY{ 2000 };
+
+    // Returns true if 'path' has an entry whose size and mtime still match.
+    // On a hit 'out' receives a fresh copy of the metadata, or nullptr for a known-bad file,
+    // and 'contentHash' (if given) the stored audio hash, 0 if none.
+    bool lookup(const std::string& path, long long size, long long mtime, std::unique_ptr<Metadata>& out,
+                uint64_t* contentHash = nullptr) const;
+
+    // Size and mtime the entry for 'path' was stored with
+    bool getStat(const std::string& path, long long& size, long long& mtime) const;
+
+    void store(const std::string& path, long long size, long long mtime, const Metadata* metadata);
+    void storeFailure(const std::string& path, long long size, long long mtime);
+    // Ignored unless the entry for 'path' still has this size and mtime. store() keeps it
+    // only if the size and mtime are unchanged.
+    void storeContentHash(const std::string& path, long long size, long long mtime, uint64_t hash);
+    void remove(const std::string& path);
+
+    // Drops entries under 'rootPath' that are not in 'seenPaths' (deleted since the last scan).
+    void prune(const std::string& rootPath, const std::unordered_set<std::string>& seenPaths);
+
+    size_t size() const;
+    const std::string& getFilePath() const;
+
+private:
+    struct Entry {
+        long long size = 0;
+        long long mtime = 0;
+        bool failed = false;
+        bool isAudio = false;
+        bool estimated = false; // Metadata::estimated
+        uint64_t contentHash = 0;
+        std::string title;
+        int durationInSeconds = 0;
+        long fileSizeInBytes = 0;
+        std::map<std::string, std::string> fields;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    std::string cacheFilePath;
+    std::map<std::string, Entry> entries;
+    bool dirty;
+    bool saveWanted; // saveLater() since the last save
+    Clock::time_point firstSaveLater;
+    Clock::time_point lastSaveLater;
+    mutable std::mutex mutex;
+    std::mutex saveMutex; // Held by save() while it writes, outside 'mutex'
+};
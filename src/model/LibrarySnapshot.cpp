@@ -0,0 +1,290 @@
+#include "model/LibrarySnapshot.h"
+#include "utils/FileUtils.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    const char MAGIC[8] = { 'M', 'P', 'L', 'S', 'N', 'A', 'P', '\0' };
+
+    // FNV-1a over 64-bit words (the body is padded to a multiple of 8 bytes).
+    // Catches truncation and bit rot; it is not meant to resist tampering.
+    uint64_t checksum(const unsigned char* data, size_t size) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    size_t align8(size_t value) {
+        return (value + 7) & ~static_cast<size_t>(7);
+    }
+}
+
+struct LibrarySnapshot::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize; // sizeof(Record) of the build that wrote it
+    uint64_t fileSize;
+    uint64_t checksum; // Over everything after the header
+    uint32_t recordCount;
+    uint32_t extraCount;
+    uint32_t rootCount; // Library roots: string offsets at rootsOffset
+    uint32_t currentSortOrder;
+    uint32_t sortOrderMask; // Bit per stored permutation
+    uint32_t reserved;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t recordsOffset;
+    uint64_t extrasOffset;
+    uint64_t sortOrdersOffset; // Stored permutations back to back, in slot order
+    uint64_t postingsOffset;
+    uint64_t postingWords;
+    uint64_t rootsOffset;
+};
+
+// --- Writer ---
+
+LibrarySnapshot::Writer::Writer(const std::vector<std::string>& roots)
+    : strings(1, '\0'), currentSortOrder(0)
+{
+    for (const auto& root : roots) this->roots.push_back(this->addString(root));
+}
+
+uint32_t LibrarySnapshot::Writer::addString(std::string_view value) {
+    if (value.empty()) return 0;
+    auto [it, inserted] = this->stringOffsets.emplace(std::string(value), static_cast<uint32_t>(this->strings.size()));
+    if (inserted) {
+        this->strings.append(value);
+        this->strings.push_back('\0');
+    }
+    return it->second;
+}
+
+void LibrarySnapshot::Writer::addRecord(Record record, const std::vector<ExtraField>& extras) {
+    record.extraFirst = static_cast<uint32_t>(this->extraFields.size());
+    record.extraCount = static_cast<uint32_t>(extras.size());
+    this->extraFields.insert(this->extraFields.end(), extras.begin(), extras.end());
+    this->records.push_back(record);
+}
+
+void LibrarySnapshot::Writer::setSortOrder(int slot, std::vector<uint32_t> permutation) {
+    if (slot > 0 && slot < SORT_SLOTS) this->sortOrders[slot] = std::move(permutation);
+}
+
+void LibrarySnapshot::Writer::setCurrentSortOrder(int slot) {
+    this->currentSortOrder = static_cast<uint32_t>(slot);
+}
+
+void LibrarySnapshot::Writer::setPostings(std::vector<uint32_t> postings) {
+    this->postings = std::move(postings);
+}
+
+void LibrarySnapshot::Writer::setStat(size_t record, int64_t size, int64_t mtime) {
+    this->records.at(record).size = size;
+    this->records.at(record).mtime = mtime;
+}
+
+void LibrarySnapshot::Writer::write(std::ostream& out) const {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.recordSize = sizeof(Record);
+    header.recordCount = static_cast<uint32_t>(this->records.size());
+    header.extraCount = static_cast<uint32_t>(this->extraFields.size());
+    header.rootCount = static_cast<uint32_t>(this->roots.size());
+    header.currentSortOrder = this->currentSortOrder;
+
+    // Lay the sections out in one buffer, each 8-byte aligned
+    std::vector<unsigned char> body;
+    auto appendSection = [&body](const void* bytes, size_t size) {
+        size_t offset = sizeof(Header) + body.size();
+        body.insert(body.end(), static_cast<const unsigned char*>(bytes), static_cast<const unsigned char*>(bytes) + size);
+        body.resize(align8(body.size()), 0);
+        return static_cast<uint64_t>(offset);
+    };
+    header.stringsOffset = appendSection(this->strings.data(), this->strings.size());
+    header.stringsSize = this->strings.size();
+    header.recordsOffset = appendSection(this->records.data(), this->records.size() * sizeof(Record));
+    header.extrasOffset = appendSection(this->extraFields.data(), this->extraFields.size() * sizeof(ExtraField));
+    header.sortOrdersOffset = sizeof(Header) + body.size();
+    for (int slot = 1; slot < SORT_SLOTS; ++slot) {
+        if (this->sortOrders[slot].size() != this->records.size() || this->records.empty()) continue;
+        header.sortOrderMask |= 1u << slot;
+        appendSection(this->sortOrders[slot].data(), this->sortOrders[slot].size() * sizeof(uint32_t));
+    }
+    header.postingsOffset = appendSection(this->postings.data(), this->postings.size() * sizeof(uint32_t));
+    header.postingWords = this->postings.size();
+    header.rootsOffset = appendSection(this->roots.data(), this->roots.size() * sizeof(uint32_t));
+    header.fileSize = sizeof(Header) + body.size();
+    header.checksum = checksum(body.data(), body.size());
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(body.data()), body.size());
+}
+
+bool LibrarySnapshot::Writer::save(const std::string& filePath) const {
+    // Written beside the target and renamed over it, so a crash never leaves half a snapshot
+    if (!FileUtils::writeFileAtomically(filePath, [this](std::ostream& out) { this->write(out); })) return false;
+    std::cout << "LibrarySnapshot: Saved " << this->records.size() << " entries to " << filePath << std::endl;
+    return true;
+}
+
+// --- Reader ---
+
+LibrarySnapshot::LibrarySnapshot()
+    : data(nullptr), mappedSize(0), header(nullptr)
+{}
+
+LibrarySnapshot::~LibrarySnapshot() {
+    this->close();
+}
+
+bool LibrarySnapshot::open(const std::string& filePath) {
+    this->close();
+
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "LibrarySnapshot Info: No snapshot at " << filePath << "." << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        std::cerr << "LibrarySnapshot Warning: Ignoring truncated snapshot: " << filePath << std::endl;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        std::cerr << "LibrarySnapshot Error: Could not map " << filePath << std::endl;
+        return false;
+    }
+    this->data = static_cast<const unsigned char*>(mapping);
+    this->mappedSize = static_cast<size_t>(st.st_size);
+    this->header = reinterpret_cast<const Header*>(this->data);
+
+    if (!this->validate()) {
+        std::cerr << "LibrarySnapshot Warning: Ignoring stale or damaged snapshot: " << filePath << std::endl;
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+bool LibrarySnapshot::validate() const {
+    const Header& h = *this->header;
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (h.version != FORMAT_VERSION || h.recordSize != sizeof(Record)) return false;
+    if (h.fileSize != this->mappedSize || h.currentSortOrder >= static_cast<uint32_t>(SORT_SLOTS)) return false;
+    if (checksum(this->data + sizeof(Header), this->mappedSize - sizeof(Header)) != h.checksum) return false;
+
+    // The checksum only says the file is as written; the offsets must still fit the mapping
+    auto fits = [this](uint64_t offset, uint64_t size) {
+        return offset >= sizeof(Header) && offset % 8 == 0 && offset <= this->mappedSize && size <= this->mappedSize - offset;
+    };
+    int storedOrders = 0;
+    for (int slot = 1; slot < SORT_SLOTS; ++slot) {
+        if (h.sortOrderMask & (1u << slot)) ++storedOrders;
+    }
+    if (!fits(h.stringsOffset, h.stringsSize) || h.stringsSize == 0) return false;
+    if (!fits(h.recordsOffset, static_cast<uint64_t>(h.recordCount) * sizeof(Record))) return false;
+    if (!fits(h.extrasOffset, static_cast<uint64_t>(h.extraCount) * sizeof(ExtraField))) return false;
+    if (!fits(h.sortOrdersOffset, static_cast<uint64_t>(storedOrders) * align8(h.recordCount * sizeof(uint32_t)))) return false;
+    if (!fits(h.postingsOffset, h.postingWords * sizeof(uint32_t))) return false;
+    if (!fits(h.rootsOffset, static_cast<uint64_t>(h.rootCount) * sizeof(uint32_t))) return false;
+
+    const char* strings = reinterpret_cast<const char*>(this->data + h.stringsOffset);
+    if (strings[0] != '\0' || strings[h.stringsSize - 1] != '\0') return false;
+    auto validString = [&h](uint32_t offset) { return offset < h.stringsSize; };
+
+    const uint32_t* roots = reinterpret_cast<const uint32_t*>(this->data + h.rootsOffset);
+    for (uint32_t i = 0; i < h.rootCount; ++i) {
+        if (!validString(roots[i])) return false;
+    }
+
+    const Record* records = reinterpret_cast<const Record*>(this->data + h.recordsOffset);
+    for (uint32_t i = 0; i < h.recordCount; ++i) {
+        const Record& r = records[i];
+        if (!validString(r.path) || !validString(r.title) || !validString(r.artist)
+            || !validString(r.album) || !validString(r.genre)) return false;
+        if (r.extraFirst > h.extraCount || r.extraCount > h.extraCount - r.extraFirst) return false;
+    }
+    const ExtraField* extras = reinterpret_cast<const ExtraField*>(this->data + h.extrasOffset);
+    for (uint32_t i = 0; i < h.extraCount; ++i) {
+        if (!validString(extras[i].key) || !validString(extras[i].value)) return false;
+    }
+    for (int slot = 1; slot < SORT_SLOTS; ++slot) {
+        const uint32_t* order = this->getSortOrder(slot);
+        for (uint32_t i = 0; order && i < h.recordCount; ++i) {
+            if (order[i] >= h.recordCount) return false;
+        }
+    }
+    return true;
+}
+
+void LibrarySnapshot::close() {
+    if (this->data) {
+        munmap(const_cast<unsigned char*>(this->data), this->mappedSize);
+    }
+    this->data = nullptr;
+    this->mappedSize = 0;
+    this->header = nullptr;
+}
+
+bool LibrarySnapshot::isOpen() const {
+    return this->data != nullptr;
+}
+
+std::vector<std::string> LibrarySnapshot::getRoots() const {
+    std::vector<std::string> roots;
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(this->data + this->header->rootsOffset);
+    for (uint32_t i = 0; i < this->header->rootCount; ++i) roots.emplace_back(this->getString(offsets[i]));
+    return roots;
+}
+
+size_t LibrarySnapshot::getRecordCount() const {
+    return this->header ? this->header->recordCount : 0;
+}
+
+const LibrarySnapshot::Record& LibrarySnapshot::getRecord(size_t index) const {
+    return reinterpret_cast<const Record*>(this->data + this->header->recordsOffset)[index];
+}
+
+const char* LibrarySnapshot::getString(uint32_t offset) const {
+    return reinterpret_cast<const char*>(this->data + this->header->stringsOffset) + offset;
+}
+
+const LibrarySnapshot::ExtraField* LibrarySnapshot::getExtraFields(const Record& record) const {
+    return reinterpret_cast<const ExtraField*>(this->data + this->header->extrasOffset) + record.extraFirst;
+}
+
+const uint32_t* LibrarySnapshot::getSortOrder(int slot) const {
+    if (slot <= 0 || slot >= SORT_SLOTS || !(this->header->sortOrderMask & (1u << slot))) return nullptr;
+    size_t offset = this->header->sortOrdersOffset;
+    for (int earlier = 1; earlier < slot; ++earlier) {
+        if (this->header->sortOrderMask & (1u << earlier)) offset += align8(this->header->recordCount * sizeof(uint32_t));
+    }
+    return reinterpret_cast<const uint32_t*>(this->data + offset);
+}
+
+int LibrarySnapshot::getCurrentSortOrder() const {
+    return static_cast<int>(this->header->currentSortOrder);
+}
+
+const uint32_t* LibrarySnapshot::getPostings() const {
+    return reinterpret_cast<const uint32_t*>(this->data + this->header->postingsOffset);
+}
+
+size_t LibrarySnapshot::getPostingWords() const {
+    return this->header->postingWords;
+}
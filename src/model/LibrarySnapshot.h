@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Binary image of a whole library for instant startup: entries in DATE_ADDED order with
+// their tags and the stat data those were read with, the tag sort orders and the search
+// postings. Read by mapping the file: records are fixed-size and strings are offsets into
+// one NUL-terminated table, so nothing is parsed. A version, the record size and a
+// checksum over the body guard against stale or damaged files.
+// Native byte order: the file only moves between runs of the same build.
+class LibrarySnapshot {
+public:
+    static const uint32_t FORMAT_VERSION = 3; // Bump when the layout changes
+    static const int SORT_SLOTS = 6; // One per SortOrder; slot 0 (DATE_ADDED) is never stored
+
+    enum RecordFlags : uint8_t { AUDIO = 1, METADATA_PENDING = 2, ESTIMATED = 4 };
+
+    struct Record {
+        uint32_t path; // String table offsets; 0 is the empty string
+        uint32_t title;
+        uint32_t artist;
+        uint32_t album;
+        uint32_t genre;
+        uint32_t extraFirst; // Range in the extra-field table
+        uint32_t extraCount;
+        int32_t year;
+        int64_t size; // Stat data the tags were read with
+        int64_t mtime;
+        int64_t fileSizeInBytes;
+        uint64_t contentHash; // See AudioHash; 0 if not hashed yet
+        int32_t trackNumber;
+        int32_t durationInSeconds;
+        uint8_t flags;
+        uint8_t reserved[7];
+    };
+
+    struct ExtraField {
+        uint32_t key;
+        uint32_t value;
+    };
+
+    // Collects a library in memory and writes it out in one go (temp file + rename)
+    class Writer {
+    public:
+        explicit Writer(const std::vector<std::string>& roots);
+        uint32_t addString(std::string_view value); // Repeated strings are stored once
+        void addRecord(Record record, const std::vector<ExtraField>& extras);
+        void setSortOrder(int slot, std::vector<uint32_t> permutation); // Record indices in order
+        void setCurrentSortOrder(int slot);
+        void setPostings(std::vector<uint32_t> postings);
+        void setStat(size_t record, int64_t size, int64_t mtime); // For records added before their stat was known
+        void write(std::ostream& out) const; // The whole file
+        bool save(const std::string& filePath) const;
+
+    private:
+        std::string strings;
+        std::unordered_map<std::string, uint32_t> stringOffsets;
+        std::vector<Record> records;
+        std::vector<ExtraField> extraFields;
+        std::vector<uint32_t> sortOrders[SORT_SLOTS];
+        std::vector<uint32_t> postings;
+        std::vector<uint32_t> roots; // String offsets
+        uint32_t currentSortOrder;
+    };
+
+    LibrarySnapshot();
+    ~LibrarySnapshot();
+    LibrarySnapshot(const LibrarySnapshot&) = delete;
+    LibrarySnapshot& operator=(const LibrarySnapshot&) = delete;
+
+    bool open(const std::string& filePath); // False (and closed) unless the file is intact
+    void close();
+    bool isOpen() const;
+
+    // Valid while open. Every offset has been bounds-checked by open().
+    std::vector<std::string> getRoots() const; // In the order they were added
+    size_t getRecordCount() const;
+    const Record& getRecord(size_t index) const;
+    const char* getString(uint32_t offset) const;
+    const ExtraField* getExtraFields(const Record& record) const;
+    const uint32_t* getSortOrder(int slot) const; // nullptr if that order was not stored
+    int getCurrentSortOrder() const;
+    const uint32_t* getPostings() const; // Format: see SearchIndex::exportPostings()
+    size_t getPostingWords() const;
+
+private:
+    struct Header;
+
+    const unsigned char* data;
+    size_t mappedSize;
+    const Header* header;
+
+    bool validate() const;
+};
@@ -1,15 +1,26 @@
 #include "model/MediaFile.h"
-#include <filesystem>
 
 MediaFile::MediaFile(const std::string& path, std::unique_ptr<Metadata> metadata)
-    : filePath(path), metadata(std::move(metadata))
+    : metadata(std::move(metadata))
 {
-    try {
-        this->fileName = std::filesystem::path(path).filename().string();
-    } catch (std::exception& e) {
-        this->fileName = path; // Fallback
-    }
+    setFilePath(path);
+    updateMediaType();
+}
 
+void MediaFile::setFilePath(const std::string& path) {
+    this->filePath = path;
+    this->filePath.shrink_to_fit(); // Paths never grow in place; drop the caller's spare capacity
+    size_t slash = this->filePath.find_last_of('/');
+    this->fileNameOffset = (slash == std::string::npos) ? 0 : static_cast<uint32_t>(slash + 1);
+}
+
+void MediaFile::setMetadata(std::unique_ptr<Metadata> newMetadata) {
+    this->metadata = std::move(newMetadata);
+    this->metadataPending = false;
+    updateMediaType();
+}
+
+void MediaFile::updateMediaType() {
     if (dynamic_cast<AudioMetadata*>(this->metadata.get())) {
         this->mediaType = MediaType::AUDIO;
     } else if (dynamic_cast<VideoMetadata*>(this->metadata.get())) {
@@ -23,8 +34,8 @@ const std::string& MediaFile::getFilePath() const {
     return this->filePath;
 }
 
-const std::string& MediaFile::getFileName() const {
-    return this->fileName;
+std::string_view MediaFile::getFileName() const {
+    return std::string_view(this->filePath).substr(this->fileNameOffset);
 }
 
 MediaType MediaFile::getType() const {
@@ -33,4 +44,27 @@ MediaType MediaFile::getType() const {
 
 Metadata* MediaFile::getMetadata() const {
     return metadata.get(); // Return the raw pointer
-}
\ No newline at end of file
+}
+bool MediaFile::isMetadataPending() const {
+    return this->metadataPending;
+}
+
+void MediaFile::setMetadataPending(bool pending) {
+    this->metadataPending = pending;
+}
+
+uint64_t MediaFile::getContentHash() const {
+    return this->contentHash;
+}
+
+void MediaFile::setContentHash(uint64_t hash) {
+    this->contentHash = hash;
+}
+
+uint16_t MediaFile::getSourceRoot() const {
+    return this->sourceRoot;
+}
+
+void MediaFile::setSourceRoot(uint16_t rootId) {
+    this->sourceRoot = rootId;
+}
@@ -1,24 +1,44 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <memory> 
 #include "Metadata.h"
 #include "AudioMetadata.h" 
 #include "VideoMetadata.h" 
 
-enum class MediaType { UNKNOWN, AUDIO, VIDEO };
+enum class MediaType : uint8_t { UNKNOWN, AUDIO, VIDEO };
 
 class MediaFile {
 public:
     MediaFile(const std::string& path, std::unique_ptr<Metadata> metadata);
 
     const std::string& getFilePath() const;
-    const std::string& getFileName() const; 
+    std::string_view getFileName() const; // Suffix of the path, so data() is NUL-terminated
     MediaType getType() const;
     Metadata* getMetadata() const; 
+    // True while the metadata is a path/stat placeholder in a lazy library (see MediaManager)
+    bool isMetadataPending() const;
+    void setMetadataPending(bool pending);
+    // Hash of the audio payload (see AudioHash), 0 until hashed. Survives retagging.
+    uint64_t getContentHash() const;
+    void setContentHash(uint64_t hash);
+    // Library root the file was found under (see MediaManager::addRoot()), 0 if none
+    uint16_t getSourceRoot() const;
+    void setSourceRoot(uint16_t rootId);
+
+    // Used by incremental library updates so existing MediaFile* pointers stay valid
+    void setFilePath(const std::string& path);
+    void setMetadata(std::unique_ptr<Metadata> newMetadata); // Also clears the pending flag
 
 private:
+    void updateMediaType();
+
     std::string filePath;
-    std::string fileName;
+    uint32_t fileNameOffset; // Start of the file name inside filePath
     MediaType mediaType;
+    bool metadataPending = false;
+    uint16_t sourceRoot = 0;
+    uint64_t contentHash = 0;
     std::unique_ptr<Metadata> metadata;
 };
\ No newline at end of file
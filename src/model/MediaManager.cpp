@@ -1,63 +1,1362 @@
 #include "model/MediaManager.h"
 #include "utils/TagLibWrapper.h" 
 #include "utils/FileUtils.h"     
+#include "utils/ThreadPool.h"
+#include "utils/AudioHash.h"
+#include "model/LibraryCache.h"
+#include "model/LibrarySnapshot.h"
+#include "model/AudioMetadata.h"
 #include <iostream>
 #include <cmath> 
 #include <algorithm>
 #include <filesystem>
 #include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+#include <limits>
+#include <chrono>
+
+namespace {
+    // Case-insensitive; empty values (unknown artist, ...) sort after everything else
+    int compareText(std::string_view a, std::string_view b) {
+        if (a.data() == b.data() && a.size() == b.size()) return 0; // Same interned tag string
+        if (a.empty() != b.empty()) return a.empty() ? 1 : -1;
+        size_t n = std::min(a.size(), b.size());
+        for (size_t i = 0; i < n; ++i) {
+            int ca = std::tolower(static_cast<unsigned char>(a[i]));
+            int cb = std::tolower(static_cast<unsigned char>(b[i]));
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    int compareNumber(long long a, long long b, bool zeroLast) {
+        if (zeroLast && (a == 0) != (b == 0)) return a == 0 ? 1 : -1;
+        return a == b ? 0 : (a < b ? -1 : 1);
+    }
+
+    // Strict total order: the file path breaks every remaining tie
+    bool sortLess(SortOrder order, const MediaFile* a, const MediaFile* b) {
+        static const Metadata empty;
+        const Metadata& ma = a->getMetadata() ? *a->getMetadata() : empty;
+        const Metadata& mb = b->getMetadata() ? *b->getMetadata() : empty;
+
+        int c = 0;
+        switch (order) {
+            case SortOrder::ARTIST:
+                c = compareText(ma.getArtist(), mb.getArtist());
+                if (c == 0) c = compareText(ma.getAlbum(), mb.getAlbum());
+                if (c == 0) c = compareNumber(ma.getTrackNumber(), mb.getTrackNumber(), true);
+                break;
+            case SortOrder::ALBUM:
+                c = compareText(ma.getAlbum(), mb.getAlbum());
+                if (c == 0) c = compareNumber(ma.getTrackNumber(), mb.getTrackNumber(), true);
+                break;
+            case SortOrder::YEAR:
+                c = compareNumber(ma.getYear(), mb.getYear(), true);
+                if (c == 0) c = compareText(ma.getArtist(), mb.getArtist());
+                if (c == 0) c = compareText(ma.getAlbum(), mb.getAlbum());
+                if (c == 0) c = compareNumber(ma.getTrackNumber(), mb.getTrackNumber(), true);
+                break;
+            case SortOrder::DURATION:
+                c = compareNumber(ma.durationInSeconds, mb.durationInSeconds, false);
+                break;
+            case SortOrder::FILE_NAME:
+            case SortOrder::DATE_ADDED:
+                break;
+        }
+        if (c == 0) c = compareText(a->getFileName(), b->getFileName());
+        if (c == 0) return a->getFilePath() < b->getFilePath();
+        return c < 0;
+    }
+
+    bool isUnderDirectory(const std::string& path, const std::string& dir) {
+        if (path == dir) return true;
+        return path.size() > dir.size() && path.compare(0, dir.size(), dir) == 0
+            && (path[dir.size()] == '/' || dir.back() == '/');
+    }
+
+    // A cached read serves a profile unless it is an estimate and more was asked for
+    bool coversProfile(const std::unique_ptr<Metadata>& metadata, ScanProfile profile) {
+        return !metadata || !metadata->estimated || profile == ScanProfile::FAST;
+    }
+
+    // Orders that need tags rather than just the path
+    bool sortsByTags(SortOrder order) {
+        return order != SortOrder::DATE_ADDED && order != SortOrder::FILE_NAME;
+    }
+
+    // What a lazy library shows until the tags are read: the same title fallback
+    // TagLibWrapper uses for untagged files, plus the size from the scan's stat
+    std::unique_ptr<Metadata> placeholderMetadata(const std::string& filePath, long long size) {
+        auto metadata = std::make_unique<Metadata>();
+        metadata->title = std::filesystem::path(filePath).stem().string();
+        if (size > 0) metadata->fileSizeInBytes = size;
+        return metadata;
+    }
+
+    // Integer stand-ins for sortLess's leading keys, so a full sort compares numbers
+    // instead of chasing MediaFile -> Metadata -> string for every comparison.
+    struct DecoratedEntry {
+        long long keys[4];
+        MediaFile* file;
+    };
+
+    std::vector<DecoratedEntry> decorate(SortOrder order, const std::vector<std::unique_ptr<MediaFile>>& library) {
+        static const Metadata empty;
+        const long long LAST = std::numeric_limits<long long>::max(); // Zero track/year sort last
+
+        // Rank each distinct interned tag string once, consistent with compareText
+        std::vector<const std::string*> distinct;
+        std::unordered_map<const std::string*, long long> ranks;
+        for (const auto& file : library) {
+            const Metadata& meta = file->getMetadata() ? *file->getMetadata() : empty;
+            for (const std::string* value : { &meta.getArtist(), &meta.getAlbum() }) {
+                if (ranks.emplace(value, 0).second) distinct.push_back(value);
+            }
+        }
+        std::sort(distinct.begin(), distinct.end(),
+                  [](const std::string* a, const std::string* b) { return compareText(*a, *b) < 0; });
+        long long rank = 0;
+        for (size_t i = 0; i < distinct.size(); ++i) {
+            if (i > 0 && compareText(*distinct[i - 1], *distinct[i]) != 0) ++rank;
+            ranks[distinct[i]] = rank;
+        }
+
+        std::vector<DecoratedEntry> entries;
+        entries.reserve(library.size());
+        for (const auto& file : library) {
+            const Metadata& meta = file->getMetadata() ? *file->getMetadata() : empty;
+            long long artist = ranks[&meta.getArtist()];
+            long long album = ranks[&meta.getAlbum()];
+            long long track = meta.getTrackNumber() > 0 ? meta.getTrackNumber() : LAST;
+            long long year = meta.getYear() != 0 ? meta.getYear() : LAST;
+
+            DecoratedEntry entry = { { 0, 0, 0, 0 }, file.get() };
+            switch (order) {
+                case SortOrder::ARTIST: entry.keys[0] = artist; entry.keys[1] = album; entry.keys[2] = track; break;
+                case SortOrder::ALBUM: entry.keys[0] = album; entry.keys[1] = track; break;
+                case SortOrder::YEAR: entry.keys[0] = year; entry.keys[1] = artist; entry.keys[2] = album; entry.keys[3] = track; break;
+                case SortOrder::DURATION: entry.keys[0] = meta.durationInSeconds; break;
+                case SortOrder::FILE_NAME:
+                case SortOrder::DATE_ADDED: break;
+            }
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+}
 
 MediaManager::MediaManager(TagLibWrapper* tagUtil)
-    : tagUtil(tagUtil) 
+    : generation(0), sortOrder(SortOrder::DATE_ADDED), sortedValid{},
+      tagUtil(tagUtil), libraryCache(nullptr), scanThreadCount(0), scanProfile(ScanProfile::BALANCED),
+      scanScheduler(nullptr), scanPriority(ScanPriority::NORMAL), nextRootId(1),
+      loading(false), loadCancelled(false),
+      lazyMetadata(false), pendingMetadataCount(0), prefetchStopping(false), refineRemaining(0),
+      snapshotGeneration(0), snapshotFailures(0), checkFinished(false), checking(false),
+      hashCancelled(false), hashFinished(false), hashedCount(0), hashing(false), hashWanted(false), hashAfterLoad(false),
+      hashTotal(0), hashThreadCount(2), hashBytesPerSecond(0)
 {}
 
+MediaManager::~MediaManager() {
+    this->cancelBackgroundLoad();
+    if (this->scanScheduler) this->scanScheduler->removeOwner(this);
+}
+
+void MediaManager::setLibraryCache(LibraryCache* cache) {
+    this->libraryCache = cache;
+}
+
+void MediaManager::setScanThreadCount(int threads) {
+    this->scanThreadCount = std::max(0, threads);
+}
+
+int MediaManager::getScanThreadCount() const {
+    return this->scanThreadCount;
+}
+
+void MediaManager::setScanProfile(ScanProfile profile) {
+    this->scanProfile = profile;
+}
+
+ScanProfile MediaManager::getScanProfile() const {
+    return this->scanProfile;
+}
+
+void MediaManager::setScanScheduler(ScanScheduler* scheduler) {
+    if (this->scanScheduler) this->scanScheduler->removeOwner(this);
+    this->scanScheduler = scheduler;
+    if (scheduler) scheduler->setPriority(this, this->scanPriority);
+}
+
+void MediaManager::setScanPriority(ScanPriority priority) {
+    this->scanPriority = priority;
+    if (this->scanScheduler) this->scanScheduler->setPriority(this, priority);
+}
+
+ScanPriority MediaManager::getScanPriority() const {
+    return this->scanPriority;
+}
+
+bool MediaManager::waitScanTurn(const std::atomic<bool>& cancelled) {
+    if (!this->scanScheduler) return !cancelled;
+    return this->scanScheduler->waitTurn(this, cancelled);
+}
+
+void MediaManager::setLazyMetadata(bool lazy) {
+    this->lazyMetadata = lazy;
+}
+
+bool MediaManager::isLazyMetadata() const {
+    return this->lazyMetadata;
+}
+
 void MediaManager::loadFromDirectory(const std::string& path) {
     std::cout << "MediaManager: Loading from directory: " << path << std::endl;
     this->clearLibrary();
+    this->registerRoot(path);
 
     std::vector<std::string> files = FileUtils::getMediaFilesRecursive(path);
     
     std::cout << "MediaManager: Found " << files.size() << " media files." << std::endl;
 
+    std::unique_ptr<ThreadPool> pool = this->makeScanPool(files.size(), this->readerThreadsFor(path));
+    std::vector<std::unique_ptr<MediaFile>> built = this->buildMediaFiles(files, 0, files.size(), pool.get());
+    this->library.reserve(built.size());
+    this->pathIndex.reserve(built.size());
+    for (auto& file : built) {
+        this->addEntry(std::move(file));
+    }
+    this->finishScan(path, files);
+    if (this->libraryCache) this->libraryCache->save();
+
+    std::cout << "MediaManager: Load complete. Library size: " << this->library.size() << std::endl;
+    this->refineMetadata();
+    this->saveSnapshot();
+}
+
+void MediaManager::startBackgroundLoad(const std::string& path) {
+    this->startBackgroundLoad(std::vector<std::string>{ path });
+}
+
+void MediaManager::startBackgroundLoad(const std::vector<std::string>& paths) {
+    this->clearLibrary(); // Also stops a previous background load
+    for (const auto& path : paths) {
+        std::cout << "MediaManager: Starting background load from: " << path << std::endl;
+        this->addRoot(path);
+    }
+}
+
+bool MediaManager::addRoot(const std::string& path) {
+    LibraryRoot* root = this->registerRoot(path);
+    if (!root) return false;
+    this->markRootBusy(root, false);
+    root->worker = std::thread(&MediaManager::rootScanWorker, this, root);
+    return true;
+}
+
+bool MediaManager::rescanRoot(const std::string& path) {
+    LibraryRoot* root = this->findRoot(path);
+    if (!root || root->busy) return false; // Unknown, or its scan is still running
+
+    // What each entry was read from; the worker reads again only files that differ
+    std::unordered_map<std::string, std::pair<long long, long long>> known;
+    for (const auto& file : this->library) {
+        if (file->getSourceRoot() != root->id) continue;
+        long long size = -1, mtime = 0;
+        // Without a cache, or for tags not read yet, there is nothing to compare: kept while the file exists
+        if (!this->libraryCache || file->isMetadataPending()
+            || !this->libraryCache->getStat(file->getFilePath(), size, mtime)) size = -1;
+        known.emplace(file->getFilePath(), std::make_pair(size, mtime));
+    }
+    std::cout << "MediaManager: Rescanning " << path << " (" << known.size() << " files)" << std::endl;
+    this->markRootBusy(root, true);
+    root->worker = std::thread(&MediaManager::rootRescanWorker, this, root, std::move(known));
+    return true;
+}
+
+bool MediaManager::removeRoot(const std::string& path) {
+    LibraryRoot* root = this->findRoot(path);
+    if (!root) return false;
+    this->stopRootWorker(root);
+
+    uint16_t id = root->id;
+    int removed = this->eraseWhere([id](const MediaFile* file) { return file->getSourceRoot() == id; });
+    this->roots.erase(std::find_if(this->roots.begin(), this->roots.end(),
+                                   [root](const std::unique_ptr<LibraryRoot>& r) { return r.get() == root; }));
+    this->loading = std::any_of(this->roots.begin(), this->roots.end(),
+                                [](const std::unique_ptr<LibraryRoot>& r) { return r->busy; });
+    ++this->generation; // The root list is part of the snapshot
+    std::cout << "MediaManager: Dropped root " << path << " (" << removed << " files)" << std::endl;
+    return true;
+}
+
+std::vector<std::string> MediaManager::getRoots() const {
+    std::vector<std::string> paths;
+    for (const auto& root : this->roots) paths.push_back(root->path);
+    return paths;
+}
+
+bool MediaManager::isRootLoading(const std::string& path) const {
+    LibraryRoot* root = this->findRoot(path);
+    return root && root->busy;
+}
+
+const std::string& MediaManager::getSourceRoot(const MediaFile* file) const {
+    static const std::string none;
+    if (!file || file->getSourceRoot() == 0) return none;
+    for (const auto& root : this->roots) {
+        if (root->id == file->getSourceRoot()) return root->path;
+    }
+    return none;
+}
+
+MediaManager::LibraryRoot* MediaManager::registerRoot(const std::string& path) {
+    for (const auto& root : this->roots) {
+        if (isUnderDirectory(path, root->path) || isUnderDirectory(root->path, path)) {
+            std::cerr << "MediaManager: " << path << " overlaps library root " << root->path << std::endl;
+            return nullptr;
+        }
+    }
+    auto root = std::make_unique<LibraryRoot>();
+    root->path = path;
+    root->id = this->nextRootId++;
+    this->roots.push_back(std::move(root));
+    return this->roots.back().get();
+}
+
+MediaManager::LibraryRoot* MediaManager::findRoot(const std::string& path) const {
+    for (const auto& root : this->roots) {
+        if (root->path == path) return root.get();
+    }
+    return nullptr;
+}
+
+uint16_t MediaManager::rootIdFor(const std::string& filePath) const {
+    for (const auto& root : this->roots) {
+        if (isUnderDirectory(filePath, root->path)) return root->id;
+    }
+    return 0;
+}
+
+void MediaManager::markRootBusy(LibraryRoot* root, bool rescanning) {
+    root->rescanning = rescanning;
+    root->cancelled = false;
+    root->finished = false;
+    root->walked = false;
+    root->discovered = 0;
+    root->processed = 0;
+    root->busy = true;
+    this->loading = true;
+    ++this->runningScans;
+}
+
+void MediaManager::stopRootWorker(LibraryRoot* root) {
+    if (root->worker.joinable()) {
+        root->cancelled = true;
+        root->worker.join();
+        std::cout << "MediaManager: Background load of " << root->path << " cancelled." << std::endl;
+    }
+    root->busy = false;
+    root->resyncWanted = false;
+    std::lock_guard<std::mutex> lock(this->pendingMutex);
+    uint16_t id = root->id;
+    this->pendingFiles.erase(std::remove_if(this->pendingFiles.begin(), this->pendingFiles.end(),
+                                            [id](const std::unique_ptr<MediaFile>& file) { return file->getSourceRoot() == id; }),
+                             this->pendingFiles.end());
+    root->changes.clear();
+    root->removals.clear();
+}
+
+int MediaManager::readerThreadsFor(const std::string& rootPath) const {
+    return this->scanThreadCount > 0 ? this->scanThreadCount : FileUtils::getReaderThreadCount(rootPath);
+}
+
+void MediaManager::rootScanWorker(LibraryRoot* root) {
+    if (this->scanScheduler) this->scanScheduler->beginScan(this);
+    std::vector<std::string> files;
+    if (this->waitScanTurn(root->cancelled)) {
+        files = FileUtils::getMediaFilesRecursive(root->path, 0, &root->cancelled);
+    }
+    root->discovered = static_cast<int>(files.size());
+    root->walked = true;
+    int threads = this->readerThreadsFor(root->path);
+    std::cout << "MediaManager: Found " << files.size() << " media files in " << root->path
+              << " (" << threads << " readers)" << std::endl;
+
+    // A small first batch gets the first page on screen quickly; later batches are
+    // larger so the UI thread is not woken for every handful of files.
+    std::unique_ptr<ThreadPool> pool = this->makeScanPool(files.size(), threads);
+    size_t batchSize = FIRST_BATCH_SIZE;
+
+    for (size_t begin = 0; begin < files.size() && !root->cancelled; ) {
+        size_t end = std::min(files.size(), begin + batchSize);
+        std::vector<std::unique_ptr<MediaFile>> batch = this->buildMediaFiles(files, begin, end, pool.get(), &root->cancelled);
+        {
+            std::lock_guard<std::mutex> lock(this->pendingMutex);
+            for (auto& file : batch) {
+                file->setSourceRoot(root->id);
+                this->pendingFiles.push_back(std::move(file));
+            }
+        }
+        root->processed += static_cast<int>(end - begin);
+        begin = end;
+        batchSize = BATCH_SIZE;
+    }
+
+    if (!root->cancelled) {
+        this->finishScan(root->path, files);
+    }
+    this->endRootWorker(root);
+}
+
+void MediaManager::rootRescanWorker(LibraryRoot* root, std::unordered_map<std::string, std::pair<long long, long long>> known) {
+    if (this->scanScheduler) this->scanScheduler->beginScan(this);
+    std::vector<std::string> files;
+    if (this->waitScanTurn(root->cancelled)) {
+        files = FileUtils::getMediaFilesRecursive(root->path, 0, &root->cancelled);
+    }
+    root->discovered = static_cast<int>(files.size());
+    root->walked = true;
+
+    std::vector<std::string> toRead;
     for (const auto& file : files) {
-        std::unique_ptr<Metadata> metadata = this->tagUtil->readTags(file);
+        if (root->cancelled) break;
+        auto it = known.find(file);
+        if (it != known.end()) {
+            auto [knownSize, knownMtime] = it->second;
+            known.erase(it);
+            long long size = -1, mtime = 0;
+            if (knownSize < 0 || (FileUtils::getFileStat(file, size, mtime) && size == knownSize && mtime == knownMtime)) {
+                continue;
+            }
+        }
+        toRead.push_back(file);
+    }
+    root->processed = static_cast<int>(files.size() - toRead.size());
+
+    // Read with the root's own pool; the cache learns the new tags as they come in
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> changes(toRead.size());
+    std::unique_ptr<ThreadPool> pool = this->makeScanPool(toRead.size(), this->readerThreadsFor(root->path));
+    auto readOne = [this, root, &toRead, &changes](size_t i) {
+        if (!this->waitScanTurn(root->cancelled)) return;
+        changes[i] = { toRead[i], this->readTagsCached(toRead[i], this->scanProfile) };
+        ++root->processed;
+    };
+    if (pool) {
+        pool->parallelFor(toRead.size(), readOne);
+    } else {
+        for (size_t i = 0; i < toRead.size(); ++i) readOne(i);
+    }
+
+    if (!root->cancelled) {
+        this->finishScan(root->path, files);
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        root->changes = std::move(changes);
+        for (auto& [path, stat] : known) root->removals.push_back(path); // Not found on disk any more
+    }
+    this->endRootWorker(root);
+}
+
+bool MediaManager::applyPendingFiles() {
+    bool tagsChanged = this->applyPrefetchedMetadata();
+    tagsChanged = this->applyRefinedMetadata() || tagsChanged;
+    tagsChanged = this->applySnapshotCheck() || tagsChanged;
+    tagsChanged = this->applyContentHashes() || tagsChanged;
+    if (!this->loading) return tagsChanged;
+
+    // Read the flags before draining: once a worker has finished, it pushes nothing after this swap
+    std::vector<LibraryRoot*> finished;
+    for (const auto& root : this->roots) {
+        if (root->busy && root->finished) finished.push_back(root.get());
+    }
+
+    std::vector<std::unique_ptr<MediaFile>> batch;
+    {
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        batch.swap(this->pendingFiles);
+    }
+    std::vector<MediaFile*> added;
+    added.reserve(batch.size());
+    for (auto& file : batch) {
+        MediaFile* entry = this->addEntry(std::move(file));
+        if (entry) added.push_back(entry);
+    }
+    this->insertIntoSortOrders(std::move(added)); // One merge per batch
+    if (finished.empty()) return !batch.empty() || tagsChanged;
+
+    for (LibraryRoot* root : finished) {
+        if (root->worker.joinable()) root->worker.join();
+        root->busy = false;
+        if (!root->rescanning) {
+            std::cout << "MediaManager: Scan of " << root->path << " complete." << std::endl;
+            continue;
+        }
+        std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> changes;
+        std::vector<std::string> removals;
+        {
+            std::lock_guard<std::mutex> lock(this->pendingMutex);
+            changes.swap(root->changes);
+            removals.swap(root->removals);
+        }
+        this->applyDiskChanges(changes, removals);
+        std::cout << "MediaManager: Rescan of " << root->path << " done: " << changes.size() << " changed or new, "
+                  << removals.size() << " removed." << std::endl;
+    }
+    for (LibraryRoot* root : finished) {
+        if (!root->resyncWanted) continue;
+        root->resyncWanted = false;
+        this->rescanRoot(root->path); // What it scanned may predate the lost events
+    }
+
+    this->loading = std::any_of(this->roots.begin(), this->roots.end(),
+                                [](const std::unique_ptr<LibraryRoot>& root) { return root->busy; });
+    if (!this->loading) {
+        std::cout << "MediaManager: Background load complete. Library size: " << this->library.size() << std::endl;
+        if (sortsByTags(this->sortOrder)) this->backfillMetadata();
+        this->refineMetadata();
+        if (this->hashWanted && !this->hashing) this->startHashing(this->hashThreadCount, this->hashBytesPerSecond);
+        this->saveSnapshot();
+    }
+    return true;
+}
+
+void MediaManager::cancelBackgroundLoad() {
+    // Flag every worker before joining any, so they all wind down at once
+    for (const auto& root : this->roots) root->cancelled = true;
+    this->loadCancelled = true;
+    for (const auto& root : this->roots) {
+        this->stopRootWorker(root.get());
+    }
+    if (this->checkThread.joinable()) {
+        this->checkThread.join();
+    }
+    this->checking = false;
+    this->checkedSnapshot.reset();
+    this->stopPrefetcher(); // Nor may the prefetcher (USB eject)
+    this->stopHashing();
+    std::lock_guard<std::mutex> lock(this->pendingMutex);
+    this->pendingFiles.clear();
+    this->checkChanges.clear();
+    this->checkRemovals.clear();
+    this->loading = false;
+}
+
+bool MediaManager::isLoading() const {
+    return this->loading;
+}
+
+int MediaManager::getDiscoveredFileCount() const {
+    int discovered = 0;
+    for (const auto& root : this->roots) discovered += root->discovered;
+    return discovered;
+}
+
+ScanProgress MediaManager::getScanProgress() const {
+    ScanProgress progress;
+    for (const auto& root : this->roots) {
+        if (!root->busy) continue;
+        progress.discovered += root->discovered;
+        progress.processed += root->processed;
+        if (!root->walked) progress.walking = true;
+    }
+    progress.waiting = this->loading && this->scanScheduler && this->scanScheduler->isWaiting(this);
+    return progress;
+}
+
+std::string ScanProgress::getStatusText() const {
+    if (walking && discovered == 0) return "Scanning...";
+    std::string counts = std::to_string(processed) + "/" + std::to_string(discovered) + " files";
+    if (waiting) return "Waiting... " + counts;
+    return (walking ? "Scanning... " : "Loading... ") + counts;
+}
+
+std::unique_ptr<ThreadPool> MediaManager::makeScanPool(size_t fileCount, int threadCount) const {
+    size_t threads = threadCount > 0 ? threadCount
+                   : this->scanThreadCount > 0 ? this->scanThreadCount : ThreadPool::defaultThreadCount();
+    threads = std::min(threads, fileCount);
+    if (threads <= 1) return nullptr; // Serial path
+    return std::make_unique<ThreadPool>(threads);
+}
+
+std::vector<std::unique_ptr<MediaFile>> MediaManager::buildMediaFiles(const std::vector<std::string>& files,
+                                                                      size_t begin, size_t end, ThreadPool* pool,
+                                                                      const std::atomic<bool>* cancelled) {
+    // Results land in slots matching 'files' and are appended in scan order
+    // afterwards, so the library looks exactly like a serial load.
+    size_t count = end - begin;
+    std::vector<std::unique_ptr<Metadata>> results(count);
+    std::vector<long long> sizes(count, -1);
+    std::vector<long long> mtimes(count, 0);
+    std::vector<size_t> misses;
+    std::vector<char> deferred(count, 0);
+    std::vector<uint64_t> hashes(count, 0);
+
+    for (size_t k = 0; k < count; ++k) {
+        const std::string& file = files[begin + k];
+        bool hasStat = (this->libraryCache || this->lazyMetadata) && FileUtils::getFileStat(file, sizes[k], mtimes[k]);
+        if (this->libraryCache && hasStat && this->libraryCache->lookup(file, sizes[k], mtimes[k], results[k], &hashes[k])
+            && coversProfile(results[k], this->scanProfile)) {
+            continue; // Cache hit (results[k] stays null for a known-bad file)
+        }
+        misses.push_back(k);
+    }
+
+    if (this->lazyMetadata) {
+        // Leave the tag reads to ensureMetadata() and the prefetcher
+        for (size_t k : misses) {
+            results[k] = placeholderMetadata(files[begin + k], sizes[k]);
+            deferred[k] = 1;
+        }
+        misses.clear();
+    }
+
+    if (this->libraryCache && !misses.empty()) {
+        std::cout << "MediaManager: " << (count - misses.size()) << " cached, "
+                  << misses.size() << " to read." << std::endl;
+    }
+
+    auto readOne = [this, &files, &results, &misses, begin, cancelled](size_t m) {
+        if (cancelled && !this->waitScanTurn(*cancelled)) return;
+        size_t k = misses[m];
+        results[k] = this->tagUtil->readTags(files[begin + k], this->scanProfile);
+    };
+    if (pool) {
+        pool->parallelFor(misses.size(), readOne);
+    } else {
+        for (size_t m = 0; m < misses.size(); ++m) readOne(m);
+    }
+    if (cancelled && *cancelled) return {}; // Unread files are not unreadable ones: store nothing
+
+    if (this->libraryCache) {
+        for (size_t k : misses) {
+            if (sizes[k] >= 0) {
+                this->libraryCache->store(files[begin + k], sizes[k], mtimes[k], results[k].get());
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<MediaFile>> built;
+    built.reserve(count);
+    for (size_t k = 0; k < count; ++k) {
+        if (results[k]) {
+            built.push_back(std::make_unique<MediaFile>(files[begin + k], std::move(results[k])));
+            if (deferred[k]) built.back()->setMetadataPending(true);
+            built.back()->setContentHash(hashes[k]);
+        } else {
+            std::cerr << "MediaManager: Skipping file (could not read metadata): " << files[begin + k] << std::endl;
+        }
+    }
+    return built;
+}
+
+void MediaManager::finishScan(const std::string& path, const std::vector<std::string>& files) {
+    if (!this->libraryCache) return;
+    this->libraryCache->prune(path, std::unordered_set<std::string>(files.begin(), files.end()));
+}
+
+// Saving holds the cache's lock for the whole write, stalling the other roots' lookups:
+// only the last worker to finish does it
+void MediaManager::endRootWorker(LibraryRoot* root) {
+    if (this->scanScheduler) this->scanScheduler->endScan(this);
+    if (--this->runningScans == 0 && this->libraryCache) this->libraryCache->save();
+    root->finished = true;
+}
+
+void MediaManager::setSnapshotFile(const std::string& filePath) {
+    this->snapshotPath = filePath;
+}
+
+bool MediaManager::saveSnapshot() {
+    if (this->snapshotPath.empty() || this->roots.empty()) return false;
+    if (this->loading || this->checking) return false; // Only whole, checked libraries are written
+    // A write that failed leaves the library still to be saved
+    size_t failures = this->snapshotWriter.getStats().failed;
+    bool lastFailed = failures != this->snapshotFailures;
+    this->snapshotFailures = failures;
+    if (this->snapshotGeneration == this->generation && !lastFailed) return true;
+
+    // The library is only read here, on the UI thread; stat calls, serialising and the
+    // write itself are left to the writer's thread
+    auto snapshot = std::make_shared<LibrarySnapshot::Writer>(this->getRoots());
+    LibrarySnapshot::Writer& writer = *snapshot;
+    std::vector<std::pair<size_t, std::string>> unstatted;
+    std::unordered_map<MediaFile*, uint32_t> positions;
+    positions.reserve(this->library.size());
+    static const Metadata empty;
+
+    for (const auto& file : this->library) {
+        positions.emplace(file.get(), static_cast<uint32_t>(positions.size()));
+        const Metadata& meta = file->getMetadata() ? *file->getMetadata() : empty;
+
+        LibrarySnapshot::Record record = {};
+        record.path = writer.addString(file->getFilePath());
+        record.title = writer.addString(meta.title);
+        record.artist = writer.addString(meta.getArtist());
+        record.album = writer.addString(meta.getAlbum());
+        record.genre = writer.addString(meta.getGenre());
+        record.year = meta.getYear();
+        record.trackNumber = meta.getTrackNumber();
+        record.durationInSeconds = meta.durationInSeconds;
+        record.fileSizeInBytes = meta.fileSizeInBytes;
+        record.contentHash = file->getContentHash();
+        if (dynamic_cast<const AudioMetadata*>(&meta)) record.flags |= LibrarySnapshot::AUDIO;
+        if (file->isMetadataPending()) record.flags |= LibrarySnapshot::METADATA_PENDING;
+        if (meta.estimated) record.flags |= LibrarySnapshot::ESTIMATED;
+
+        // Prefer the stat the tags were read with: a change since then must still show up
+        long long size = -1, mtime = 0;
+        if (!(this->libraryCache && !file->isMetadataPending()
+              && this->libraryCache->getStat(file->getFilePath(), size, mtime))) {
+            unstatted.emplace_back(positions.size() - 1, file->getFilePath());
+        }
+        record.size = size;
+        record.mtime = mtime;
+
+        std::vector<LibrarySnapshot::ExtraField> extras;
+        for (const auto& [key, value] : meta.getExtraFields()) {
+            extras.push_back({ writer.addString(*key), writer.addString(value) });
+        }
+        writer.addRecord(record, extras);
+    }
+
+    for (int slot = 1; slot < SORT_ORDER_COUNT; ++slot) {
+        if (!this->sortedValid[slot]) continue;
+        std::vector<uint32_t> permutation;
+        permutation.reserve(this->sortedViews[slot].size());
+        for (MediaFile* file : this->sortedViews[slot]) permutation.push_back(positions[file]);
+        writer.setSortOrder(slot, std::move(permutation));
+    }
+    writer.setCurrentSortOrder(static_cast<int>(this->sortOrder));
+    writer.setPostings(this->searchIndex.exportPostings(this->sortedViews[0]));
+
+    this->snapshotWriter.submit(this->snapshotPath, [snapshot, unstatted = std::move(unstatted)](std::ostream& out) {
+        for (const auto& [record, path] : unstatted) {
+            long long size, mtime;
+            if (FileUtils::getFileStat(path, size, mtime)) snapshot->setStat(record, size, mtime);
+        }
+        snapshot->write(out);
+    }, [entries = this->library.size(), path = this->snapshotPath](bool ok) {
+        if (ok) std::cout << "MediaManager: Snapshot of " << entries << " entries written to " << path << std::endl;
+    });
+    this->snapshotGeneration = this->generation;
+    return true;
+}
+
+void MediaManager::flushSnapshot() {
+    this->snapshotWriter.flush();
+}
+
+bool MediaManager::loadFromSnapshot(const std::string& path) {
+    return this->loadFromSnapshot(std::vector<std::string>{ path });
+}
+
+bool MediaManager::loadFromSnapshot(const std::vector<std::string>& paths) {
+    if (this->snapshotPath.empty()) return false;
+    auto snapshot = std::make_unique<LibrarySnapshot>();
+    if (!snapshot->open(this->snapshotPath)) return false;
+    if (paths != snapshot->getRoots()) {
+        std::cout << "MediaManager: Snapshot is of other library roots than the ones configured" << std::endl;
+        return false;
+    }
+
+    this->clearLibrary();
+    for (const auto& path : paths) {
+        if (!this->registerRoot(path)) {
+            this->clearLibrary();
+            return false;
+        }
+    }
+    size_t count = snapshot->getRecordCount();
+    this->library.reserve(count);
+    this->pathIndex.reserve(count);
+    this->sortedViews[0].reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const LibrarySnapshot::Record& record = snapshot->getRecord(i);
+        std::unique_ptr<Metadata> meta;
+        if (record.flags & LibrarySnapshot::AUDIO) {
+            meta = std::make_unique<AudioMetadata>();
+        } else {
+            meta = std::make_unique<Metadata>();
+        }
+        meta->title = snapshot->getString(record.title);
+        meta->setArtist(snapshot->getString(record.artist));
+        meta->setAlbum(snapshot->getString(record.album));
+        meta->setGenre(snapshot->getString(record.genre));
+        meta->setYear(record.year);
+        meta->setTrackNumber(record.trackNumber);
+        meta->durationInSeconds = record.durationInSeconds;
+        meta->fileSizeInBytes = static_cast<long>(record.fileSizeInBytes);
+        meta->estimated = (record.flags & LibrarySnapshot::ESTIMATED) != 0;
+        const LibrarySnapshot::ExtraField* extras = snapshot->getExtraFields(record);
+        for (uint32_t k = 0; k < record.extraCount; ++k) {
+            meta->setField(snapshot->getString(extras[k].key), snapshot->getString(extras[k].value));
+        }
+
+        auto file = std::make_unique<MediaFile>(snapshot->getString(record.path), std::move(meta));
+        if (record.flags & LibrarySnapshot::METADATA_PENDING) file->setMetadataPending(true);
+        file->setContentHash(record.contentHash);
+        this->addEntry(std::move(file), false);
+    }
+
+    // The stored indexes refer to record positions, so they only fit if every record made it in
+    bool intact = this->library.size() == count;
+    for (int slot = 1; intact && slot < SORT_ORDER_COUNT; ++slot) {
+        const uint32_t* order = snapshot->getSortOrder(slot);
+        if (!order) continue;
+        std::vector<MediaFile*>& view = this->sortedViews[slot];
+        view.resize(count);
+        for (size_t i = 0; i < count; ++i) view[i] = this->sortedViews[0][order[i]];
+        this->sortedValid[slot] = true;
+    }
+    if (!intact || !this->searchIndex.restore(this->sortedViews[0], snapshot->getPostings(), snapshot->getPostingWords())) {
+        this->searchIndex.clear();
+        for (MediaFile* file : this->sortedViews[0]) this->searchIndex.add(file);
+    }
+    this->sortOrder = static_cast<SortOrder>(snapshot->getCurrentSortOrder());
+    ++this->generation;
+    this->snapshotGeneration = this->generation;
+    std::cout << "MediaManager: Restored " << this->library.size() << " files from snapshot "
+              << this->snapshotPath << std::endl;
+
+    // Check it against the disk while the UI is already usable
+    this->checkedSnapshot = std::move(snapshot);
+    this->loadCancelled = false;
+    this->checkFinished = false;
+    this->checking = true;
+    this->checkThread = std::thread(&MediaManager::snapshotCheckWorker, this, paths);
+    return true;
+}
+
+bool MediaManager::isCheckingSnapshot() const {
+    return this->checking;
+}
+
+void MediaManager::snapshotCheckWorker(std::vector<std::string> paths) {
+    // Reads the mapped records directly; the UI thread keeps the mapping until this returns
+    const LibrarySnapshot& snapshot = *this->checkedSnapshot;
+    std::unordered_map<std::string_view, uint32_t> known;
+    known.reserve(snapshot.getRecordCount());
+    for (size_t i = 0; i < snapshot.getRecordCount(); ++i) {
+        known.emplace(snapshot.getString(snapshot.getRecord(i).path), static_cast<uint32_t>(i));
+    }
+
+    if (this->scanScheduler) this->scanScheduler->beginScan(this);
+    std::vector<std::string> files;
+    for (const auto& path : paths) {
+        if (!this->waitScanTurn(this->loadCancelled)) break;
+        std::vector<std::string> rootFiles = FileUtils::getMediaFilesRecursive(path, 0, &this->loadCancelled);
+        files.insert(files.end(), std::make_move_iterator(rootFiles.begin()), std::make_move_iterator(rootFiles.end()));
+    }
+    std::vector<char> seen(snapshot.getRecordCount(), 0);
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> changes;
+
+    for (const auto& file : files) {
+        if (this->loadCancelled) break;
+        long long size = -1, mtime = 0;
+        bool hasStat = FileUtils::getFileStat(file, size, mtime);
+        auto it = known.find(file);
+        if (it != known.end()) {
+            seen[it->second] = 1;
+            const LibrarySnapshot::Record& record = snapshot.getRecord(it->second);
+            if (hasStat && record.size == size && record.mtime == mtime) continue;
+        }
+        if (!this->waitScanTurn(this->loadCancelled)) break;
+        changes.emplace_back(file, this->readTagsCached(file, this->scanProfile));
+    }
+
+    std::vector<std::string> removals;
+    for (size_t i = 0; i < seen.size() && !this->loadCancelled; ++i) {
+        if (!seen[i]) removals.emplace_back(snapshot.getString(snapshot.getRecord(i).path));
+    }
+
+    if (!this->loadCancelled) {
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        this->checkChanges = std::move(changes);
+        this->checkRemovals = std::move(removals);
+    }
+    if (this->scanScheduler) this->scanScheduler->endScan(this);
+    this->checkFinished = true;
+}
+
+bool MediaManager::applySnapshotCheck() {
+    if (!this->checking || !this->checkFinished) return false;
+    if (this->checkThread.joinable()) this->checkThread.join();
+    this->checking = false;
+    this->checkedSnapshot.reset();
+
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> changes;
+    std::vector<std::string> removals;
+    {
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        changes.swap(this->checkChanges);
+        removals.swap(this->checkRemovals);
+    }
+    this->applyDiskChanges(changes, removals);
+
+    std::cout << "MediaManager: Snapshot check done: " << changes.size() << " changed or new, "
+              << removals.size() << " removed." << std::endl;
+    this->refineMetadata(); // Changed files, and any the last run did not get to
+    if (changes.empty() && removals.empty()) return false;
+    this->saveSnapshot();
+    return true;
+}
+
+void MediaManager::applyDiskChanges(std::vector<std::pair<std::string, std::unique_ptr<Metadata>>>& changes,
+                                    const std::vector<std::string>& removals) {
+    if (changes.size() + removals.size() > 64) {
+        this->invalidateSortOrders(); // Cheaper to re-sort once than to patch per file
+    }
+    if (removals.size() > 64) {
+        std::unordered_set<std::string_view> gone(removals.begin(), removals.end());
+        this->eraseWhere([&gone](const MediaFile* file) { return gone.count(file->getFilePath()) != 0; });
+    } else {
+        for (const auto& path : removals) {
+            this->removeFile(path);
+        }
+    }
+    for (auto& [path, metadata] : changes) {
+        long long size = 0, mtime = 0;
+        if (!FileUtils::getFileStat(path, size, mtime)) continue; // Deleted again since the check
+        MediaFile* existing = this->findFileByPath(path);
+        if (!metadata) {
+            std::cerr << "MediaManager: Could not read metadata for changed file: " << path << std::endl;
+            continue; // Same as addOrUpdateFile(): keep what we had
+        }
+        if (existing) {
+            if (existing->isMetadataPending()) --this->pendingMetadataCount;
+            existing->setMetadata(std::move(metadata));
+            existing->setContentHash(0); // Rewritten on disk; hash it again
+            this->notifyMetadataChanged(existing);
+        } else if (this->ownsPath(path)) { // Its root may have been dropped meanwhile
+            this->addMediaFile(std::make_unique<MediaFile>(path, std::move(metadata)));
+        }
+    }
+}
+
+bool MediaManager::ensureMetadata(MediaFile* file) {
+    if (!file) return false;
+    return this->ensureMetadata(MediaFileRange{ &file, 1 });
+}
+
+bool MediaManager::ensureMetadata(MediaFileRange files) {
+    // Copy first: applying the tags re-sorts the views 'files' may point into
+    std::vector<std::pair<MediaFile*, std::unique_ptr<Metadata>>> loaded;
+    for (MediaFile* file : files) {
+        if (file && file->isMetadataPending()) loaded.emplace_back(file, nullptr);
+    }
+    if (loaded.empty()) return false;
+
+    auto readOne = [this, &loaded](size_t i) {
+        loaded[i].second = this->readTagsCached(loaded[i].first->getFilePath(), this->scanProfile);
+    };
+    std::unique_ptr<ThreadPool> pool = this->makeScanPool(loaded.size());
+    if (pool) {
+        pool->parallelFor(loaded.size(), readOne);
+    } else {
+        for (size_t i = 0; i < loaded.size(); ++i) readOne(i);
+    }
+    return this->applyLoadedMetadata(loaded);
+}
+
+void MediaManager::prefetchAround(size_t offset, size_t count) {
+    this->prefetchPage(this->range(offset, count), offset, count);
+}
+
+void MediaManager::prefetchPage(MediaFileRange page, size_t offset, size_t count) {
+    if (!this->lazyMetadata || this->pendingMetadataCount == 0) return;
+
+    // The page on screen first, then the next one: paging forward is the common case
+    std::deque<std::string> wanted;
+    size_t before = offset >= count ? offset - count : 0;
+    for (MediaFileRange part : { page, this->range(offset + count, count), this->range(before, offset - before) }) {
+        for (MediaFile* file : part) {
+            if (file->isMetadataPending()) wanted.push_back(file->getFilePath());
+        }
+    }
+    // Unchanged since the last request: the queue already holds what is left of it
+    if (wanted == this->prefetchRequested) return;
+    this->prefetchRequested = wanted;
+    if (wanted.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        // The one being read now would only be read twice
+        auto reading = std::find(wanted.begin(), wanted.end(), this->prefetchReading);
+        if (reading != wanted.end()) wanted.erase(reading);
+        this->prefetchQueue.swap(wanted);
+    }
+    this->startPrefetcher();
+    this->prefetchWake.notify_one();
+}
+
+int MediaManager::getPendingMetadataCount() const {
+    return this->pendingMetadataCount;
+}
+
+void MediaManager::backfillMetadata() {
+    if (!this->lazyMetadata || this->pendingMetadataCount == 0) return;
+
+    std::deque<std::string> wanted;
+    for (const auto& file : this->library) {
+        if (file->isMetadataPending()) wanted.push_back(file->getFilePath());
+    }
+    std::cout << "MediaManager: Reading " << wanted.size() << " pending tags in the background." << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        this->backfillQueue.swap(wanted);
+    }
+    this->startPrefetcher();
+    this->prefetchWake.notify_one();
+}
+
+void MediaManager::startPrefetcher() {
+    if (this->prefetchThread.joinable()) return;
+    this->prefetchStopping = false;
+    this->prefetchThread = std::thread(&MediaManager::prefetchWorker, this);
+}
+
+void MediaManager::stopPrefetcher() {
+    if (!this->prefetchThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        this->prefetchStopping = true;
+        this->prefetchQueue.clear();
+        this->backfillQueue.clear();
+        this->refineQueue.clear();
+    }
+    this->prefetchRequested.clear();
+    this->prefetchWake.notify_one();
+    this->prefetchThread.join();
+    this->prefetchedTags.clear(); // Nothing else touches them once the thread has gone
+    this->refinedTags.clear();
+    this->refineRemaining = 0;
+}
+
+void MediaManager::prefetchWorker() {
+    std::unique_lock<std::mutex> lock(this->prefetchMutex);
+    while (true) {
+        this->prefetchWake.wait(lock, [this] {
+            return this->prefetchStopping || !this->prefetchQueue.empty() || !this->backfillQueue.empty()
+                || !this->refineQueue.empty();
+        });
+        if (this->prefetchStopping) return;
+
+        // Pending tags first: refinement only improves entries that are usable already
+        bool refining = this->prefetchQueue.empty() && this->backfillQueue.empty();
+        std::deque<std::string>& queue = !this->prefetchQueue.empty() ? this->prefetchQueue
+                                       : !this->backfillQueue.empty() ? this->backfillQueue : this->refineQueue;
+        std::string path = std::move(queue.front());
+        queue.pop_front();
+        if (&queue == &this->prefetchQueue) this->prefetchReading = path;
+
+        lock.unlock();
+        // Tag reader and cache are thread-safe
+        std::unique_ptr<Metadata> metadata = this->readTagsCached(path, refining ? ScanProfile::ACCURATE : this->scanProfile);
+        lock.lock();
+        this->prefetchReading.clear();
+        (refining ? this->refinedTags : this->prefetchedTags).emplace_back(std::move(path), std::move(metadata));
+    }
+}
+
+bool MediaManager::applyPrefetchedMetadata() {
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> results;
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        results.swap(this->prefetchedTags);
+    }
+    if (results.empty()) return false;
+
+    // Entries are looked up by path: the file may have been removed since it was queued
+    std::vector<std::pair<MediaFile*, std::unique_ptr<Metadata>>> loaded;
+    loaded.reserve(results.size());
+    for (auto& result : results) {
+        MediaFile* file = this->findFileByPath(result.first);
+        if (file) loaded.emplace_back(file, std::move(result.second));
+    }
+    return this->applyLoadedMetadata(loaded);
+}
+
+bool MediaManager::applyLoadedMetadata(std::vector<std::pair<MediaFile*, std::unique_ptr<Metadata>>>& loaded) {
+    std::vector<MediaFile*> changed;
+    std::deque<std::string> estimated;
+    for (auto& [file, metadata] : loaded) {
+        if (!file->isMetadataPending()) continue; // Already read by an earlier request
         if (metadata) {
-            this->library.push_back(std::make_unique<MediaFile>(file, std::move(metadata)));
+            if (metadata->estimated) estimated.push_back(file->getFilePath());
+            file->setMetadata(std::move(metadata));
         } else {
-            std::cerr << "MediaManager: Skipping file (could not read metadata): " << file << std::endl;
+            // Unlike a full scan, keep the entry: it is on screen already
+            std::cerr << "MediaManager: Could not read metadata for " << file->getFilePath() << std::endl;
+            file->setMetadataPending(false);
         }
+        --this->pendingMetadataCount;
+        this->searchIndex.update(file);
+        changed.push_back(file);
     }
-    std::cout << "MediaManager: Load complete. Library size: " << this->library.size() << std::endl;
+    if (changed.empty()) return false;
+
+    this->removeFromSortOrders(changed); // One pass per view for the whole batch
+    this->insertIntoSortOrders(changed);
+    ++this->generation;
+    if (!estimated.empty()) this->queueRefinement(std::move(estimated));
+    return true;
 }
 
-void MediaManager::clearLibrary() {
-    this->library.clear();
+void MediaManager::refineMetadata() {
+    std::deque<std::string> wanted;
+    for (const auto& file : this->library) {
+        const Metadata* metadata = file->getMetadata();
+        if (!file->isMetadataPending() && metadata && metadata->estimated) wanted.push_back(file->getFilePath());
+    }
+    if (wanted.empty()) return;
+    std::cout << "MediaManager: Refining " << wanted.size() << " estimated entries in the background." << std::endl;
+    this->queueRefinement(std::move(wanted));
 }
 
-std::vector<MediaFile*> MediaManager::getPage(int pageNumber, int pageSize) {
-    std::vector<MediaFile*> page;
-    
-    if (pageNumber < 1) {
-        pageNumber = 1;
+int MediaManager::getRefinePendingCount() const {
+    return this->refineRemaining;
+}
+
+void MediaManager::queueRefinement(std::deque<std::string> paths) {
+    // Appended, not replaced: every queued path comes back as exactly one result
+    this->refineRemaining += static_cast<int>(paths.size());
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        for (auto& path : paths) this->refineQueue.push_back(std::move(path));
     }
+    this->startPrefetcher();
+    this->prefetchWake.notify_one();
+}
 
-    int start = (pageNumber - 1) * pageSize;
-    
-    if (start < 0 || static_cast<size_t>(start) >= this->library.size()) {
-        return page; // Return empty vector
+bool MediaManager::applyRefinedMetadata() {
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> results;
+    {
+        std::lock_guard<std::mutex> lock(this->prefetchMutex);
+        results.swap(this->refinedTags);
     }
+    if (results.empty()) return false;
+    this->refineRemaining = std::max(0, this->refineRemaining - static_cast<int>(results.size()));
 
-    int end = start + pageSize;
-    
-    if (static_cast<size_t>(end) > this->library.size()) {
-        end = this->library.size();
+    // Only the duration and the extra tags are taken over: the standard tags were read
+    // in full already and may have been edited since the worker read the file
+    std::vector<MediaFile*> resorted;
+    for (auto& [path, refined] : results) {
+        MediaFile* file = this->findFileByPath(path);
+        Metadata* metadata = file && !file->isMetadataPending() ? file->getMetadata() : nullptr;
+        if (!metadata || !metadata->estimated) continue; // Removed, or refined by an earlier result
+        metadata->estimated = false;
+        if (!refined) continue; // Unreadable now: keep the estimate rather than retry forever
+        for (const auto& [key, value] : refined->getExtraFields()) metadata->setField(*key, value);
+        if (metadata->durationInSeconds != refined->durationInSeconds) {
+            metadata->durationInSeconds = refined->durationInSeconds;
+            resorted.push_back(file);
+        }
+    }
+    if (!resorted.empty()) {
+        this->removeFromSortOrders(resorted);
+        this->insertIntoSortOrders(resorted);
     }
+    ++this->generation;
 
-    for (int i = start; i < end; ++i) {
-        page.push_back(this->library[i].get()); // Add non-owning pointer
+    if (this->refineRemaining == 0) {
+        std::cout << "MediaManager: Estimated metadata refined." << std::endl;
+        if (this->libraryCache) this->libraryCache->save();
+        this->saveSnapshot();
     }
-    
-    return page;
+    return true;
+}
+
+bool MediaManager::startHashing(int threads, size_t bytesPerSecond) {
+    this->hashThreadCount = std::max(1, threads);
+    this->hashBytesPerSecond = bytesPerSecond;
+    this->hashWanted = true;
+    if (this->hashing) return true;
+
+    std::vector<std::string> paths;
+    for (const auto& file : this->library) {
+        if (file->getContentHash() == 0) paths.push_back(file->getFilePath());
+    }
+    if (paths.empty()) return this->loading; // More may be on the way
+
+    std::cout << "MediaManager: Hashing " << paths.size() << " files." << std::endl;
+    this->hashCancelled = false;
+    this->hashFinished = false;
+    this->hashedCount = 0;
+    this->hashTotal = static_cast<int>(paths.size());
+    this->hashing = true;
+    this->hashAfterLoad = this->loading;
+    this->hashThread = std::thread(&MediaManager::hashWorker, this, std::move(paths));
+    return true;
+}
+
+void MediaManager::stopHashing() {
+    this->hashWanted = false;
+    if (!this->hashThread.joinable()) return;
+    this->hashCancelled = true;
+    this->hashThread.join();
+    this->applyContentHashes(); // Whatever finished before the cancel
+}
+
+bool MediaManager::isHashing() const {
+    return this->hashing;
+}
+
+int MediaManager::getHashedCount() const {
+    return this->hashedCount;
+}
+
+int MediaManager::getHashTotal() const {
+    return this->hashTotal;
+}
+
+void MediaManager::hashWorker(std::vector<std::string> paths) {
+    // One budget shared by all workers: sleep whenever the bytes read so far are
+    // ahead of the rate, in short slices so a cancel is noticed quickly
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const double rate = static_cast<double>(this->hashBytesPerSecond);
+    std::atomic<unsigned long long> bytesRead(0);
+    auto onRead = [this, start, rate, &bytesRead](size_t bytes) {
+        if (rate <= 0) return !this->hashCancelled;
+        double due = static_cast<double>(bytesRead += bytes) / rate;
+        while (!this->hashCancelled) {
+            double ahead = due - std::chrono::duration<double>(Clock::now() - start).count();
+            if (ahead <= 0) break;
+            std::this_thread::sleep_for(std::chrono::duration<double>(std::min(ahead, 0.05)));
+        }
+        return !this->hashCancelled;
+    };
+
+    auto hashOne = [this, &paths, &onRead](size_t i) {
+        if (this->hashCancelled) return;
+        HashResult result = { paths[i], -1, 0, 0 };
+        if (FileUtils::getFileStat(result.path, result.size, result.mtime)) {
+            result.hash = AudioHash::hashFile(result.path, onRead);
+            long long size = -1, mtime = 0;
+            if (!FileUtils::getFileStat(result.path, size, mtime) || size != result.size || mtime != result.mtime) {
+                result.hash = 0; // Written to while we read it
+            }
+        }
+        if (this->hashCancelled) return;
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        this->hashResults.push_back(std::move(result));
+        ++this->hashedCount;
+    };
+
+    if (this->hashThreadCount > 1 && paths.size() > 1) {
+        ThreadPool pool(std::min(static_cast<size_t>(this->hashThreadCount), paths.size()));
+        pool.parallelFor(paths.size(), hashOne);
+    } else {
+        for (size_t i = 0; i < paths.size(); ++i) hashOne(i);
+    }
+    this->hashFinished = true;
+}
+
+bool MediaManager::applyContentHashes() {
+    if (!this->hashing) return false;
+    bool finished = this->hashFinished; // Before draining, as in applyPendingFiles()
+
+    std::vector<HashResult> results;
+    {
+        std::lock_guard<std::mutex> lock(this->pendingMutex);
+        results.swap(this->hashResults);
+    }
+    bool changed = false;
+    for (const HashResult& result : results) {
+        MediaFile* file = this->findFileByPath(result.path);
+        if (!file || result.hash == 0) continue;
+        // The entry may have been refreshed since the worker's stat
+        long long size = -1, mtime = 0;
+        if (!FileUtils::getFileStat(result.path, size, mtime) || size != result.size || mtime != result.mtime) continue;
+        file->setContentHash(result.hash);
+        if (this->libraryCache) this->libraryCache->storeContentHash(result.path, size, mtime, result.hash);
+        changed = true;
+    }
+    if (changed) ++this->generation;
+
+    if (finished) {
+        if (this->hashThread.joinable()) this->hashThread.join();
+        this->hashing = false;
+        std::cout << "MediaManager: Hashed " << this->hashedCount << " of " << this->hashTotal << " files." << std::endl;
+        if (this->libraryCache) this->libraryCache->save();
+        this->saveSnapshot();
+        if (this->hashWanted && this->hashAfterLoad && !this->loading) {
+            this->startHashing(this->hashThreadCount, this->hashBytesPerSecond); // Files the load added meanwhile
+        }
+        changed = true; // Progress display ends
+    }
+    return changed;
+}
+
+std::vector<std::vector<MediaFile*>> MediaManager::findDuplicates() const {
+    std::unordered_map<uint64_t, size_t> groupOf; // Hash -> index in 'groups'
+    std::vector<std::vector<MediaFile*>> groups;
+    for (MediaFile* file : this->sortedViews[0]) {
+        uint64_t hash = file->getContentHash();
+        if (hash == 0) continue;
+        auto [it, inserted] = groupOf.emplace(hash, groups.size());
+        if (inserted) groups.emplace_back();
+        groups[it->second].push_back(file);
+    }
+    groups.erase(std::remove_if(groups.begin(), groups.end(),
+                                [](const std::vector<MediaFile*>& group) { return group.size() < 2; }),
+                 groups.end());
+    return groups;
+}
+
+void MediaManager::clearLibrary() {
+    this->cancelBackgroundLoad();
+    this->searchIndex.clear();
+    this->invalidateSortOrders();
+    this->sortedViews[0].clear();
+    this->pathIndex.clear();
+    this->library.clear();
+    this->pendingMetadataCount = 0;
+    this->roots.clear();
+    ++this->generation;
+}
+
+MediaFile* MediaManager::at(size_t index) {
+    const std::vector<MediaFile*>& view = this->getSortedView(this->sortOrder);
+    return index < view.size() ? view[index] : nullptr;
+}
+
+int MediaManager::indexOf(MediaFile* file) {
+    if (!file) return -1;
+    const std::vector<MediaFile*>& view = this->getSortedView(this->sortOrder);
+
+    if (this->sortOrder != SortOrder::DATE_ADDED) {
+        // Sorted views are searchable by key; fall through if the tags were edited in place
+        // and notifyMetadataChanged() has not re-placed the entry yet
+        SortOrder order = this->sortOrder;
+        auto it = std::lower_bound(view.begin(), view.end(), file,
+                                   [order](const MediaFile* a, const MediaFile* b) { return sortLess(order, a, b); });
+        if (it != view.end() && *it == file) return static_cast<int>(it - view.begin());
+    }
+
+    auto it = std::find(view.begin(), view.end(), file);
+    return it != view.end() ? static_cast<int>(it - view.begin()) : -1;
+}
+
+MediaFileRange MediaManager::range(size_t offset, size_t count) {
+    const std::vector<MediaFile*>& view = this->getSortedView(this->sortOrder);
+    MediaFileRange result;
+    if (offset >= view.size()) return result;
+    result.first = view.data() + offset;
+    result.count = std::min(count, view.size() - offset);
+    return result;
+}
+
+std::vector<MediaFile*> MediaManager::getPage(int pageNumber, int pageSize) {
+    if (pageNumber < 1) {
+        pageNumber = 1;
+    }
+    if (pageSize <= 0) return {};
+
+    MediaFileRange page = this->range(static_cast<size_t>(pageNumber - 1) * pageSize, pageSize);
+    return std::vector<MediaFile*>(page.begin(), page.end());
 }
 
 int MediaManager::getTotalPages(int pageSize) const {
@@ -72,14 +1371,343 @@ int MediaManager::getTotalFileCount() const {
 }
 
 MediaFile* MediaManager::findFileByPath(const std::string& filePath) const {
-    auto it = std::find_if(library.begin(), library.end(),
-        [&filePath](const std::unique_ptr<MediaFile>& filePtr) {
-            return filePtr->getFilePath() == filePath;
+    auto it = pathIndex.find(filePath);
+    if (it != pathIndex.end()) {
+        return it->second;
+    }
+
+    return nullptr; // Not found
+}
+
+MediaFile* MediaManager::addMediaFile(std::unique_ptr<MediaFile> file) {
+    if (!file) return nullptr;
+    MediaFile* existing = this->findFileByPath(file->getFilePath());
+    if (existing) {
+        std::cerr << "MediaManager: Ignoring duplicate path: " << file->getFilePath() << std::endl;
+        return existing;
+    }
+    MediaFile* ptr = this->addEntry(std::move(file));
+    if (ptr) this->insertIntoSortOrders({ ptr });
+    return ptr;
+}
+
+MediaFile* MediaManager::addEntry(std::unique_ptr<MediaFile> file, bool indexForSearch) {
+    if (!file) return nullptr;
+
+    MediaFile* ptr = file.get();
+    auto [it, inserted] = this->pathIndex.emplace(ptr->getFilePath(), ptr);
+    if (!inserted) {
+        std::cerr << "MediaManager: Ignoring duplicate path: " << ptr->getFilePath() << std::endl;
+        return nullptr;
+    }
+    if (ptr->getSourceRoot() == 0) ptr->setSourceRoot(this->rootIdFor(ptr->getFilePath()));
+    this->library.push_back(std::move(file));
+    this->sortedViews[0].push_back(ptr);
+    if (indexForSearch) this->searchIndex.add(ptr);
+    if (ptr->isMetadataPending()) ++this->pendingMetadataCount;
+    ++this->generation;
+    return ptr;
+}
+
+std::vector<MediaFile*> MediaManager::search(const std::string& query, size_t limit) const {
+    return this->searchIndex.search(query, limit);
+}
+
+void MediaManager::notifyMetadataChanged(MediaFile* file) {
+    this->notifyMetadataChanged(std::vector<MediaFile*>{ file });
+}
+
+void MediaManager::notifyMetadataChanged(const std::vector<MediaFile*>& files) {
+    if (files.empty()) return;
+    for (MediaFile* file : files) this->searchIndex.update(file);
+    this->removeFromSortOrders(files); // Their sort keys may have changed
+    this->insertIntoSortOrders(files);
+    ++this->generation;
+}
+
+void MediaManager::setSortOrder(SortOrder order) {
+    this->sortOrder = order;
+    if (sortsByTags(order) && !this->loading) this->backfillMetadata(); // After a load, see applyPendingFiles()
+    ++this->generation;
+}
+
+SortOrder MediaManager::getSortOrder() const {
+    return this->sortOrder;
+}
+
+const char* MediaManager::getSortOrderName(SortOrder order) {
+    switch (order) {
+        case SortOrder::DATE_ADDED: return "Date added";
+        case SortOrder::ARTIST: return "Artist";
+        case SortOrder::ALBUM: return "Album";
+        case SortOrder::YEAR: return "Year";
+        case SortOrder::DURATION: return "Duration";
+        case SortOrder::FILE_NAME: return "File name";
+    }
+    return "";
+}
+
+const std::vector<MediaFile*>& MediaManager::getSortedView(SortOrder order) {
+    int slot = static_cast<int>(order);
+    std::vector<MediaFile*>& view = this->sortedViews[slot];
+    if (slot != 0 && !this->sortedValid[slot]) {
+        std::vector<DecoratedEntry> entries = decorate(order, this->library);
+        std::sort(entries.begin(), entries.end(), [order](const DecoratedEntry& a, const DecoratedEntry& b) {
+            for (int k = 0; k < 4; ++k) {
+                if (a.keys[k] != b.keys[k]) return a.keys[k] < b.keys[k];
+            }
+            return sortLess(order, a.file, b.file); // Leading keys tie: file name, then path
         });
+        view.clear();
+        view.reserve(entries.size());
+        for (const auto& entry : entries) view.push_back(entry.file);
+        this->sortedValid[slot] = true;
+    }
+    return view;
+}
+
+void MediaManager::insertIntoSortOrders(std::vector<MediaFile*> added) {
+    if (added.empty()) return;
+    for (int slot = 1; slot < SORT_ORDER_COUNT; ++slot) { // Slot 0 (DATE_ADDED) is 'library' itself
+        if (!this->sortedValid[slot]) continue;
+        SortOrder order = static_cast<SortOrder>(slot);
+        auto less = [order](const MediaFile* a, const MediaFile* b) { return sortLess(order, a, b); };
 
-    if (it != library.end()) {
-        return it->get(); // Return raw pointer
+        // Sort just the new entries and merge them in: O(n + k log k) per batch
+        std::vector<MediaFile*>& view = this->sortedViews[slot];
+        std::sort(added.begin(), added.end(), less);
+        size_t oldSize = view.size();
+        view.insert(view.end(), added.begin(), added.end());
+        std::inplace_merge(view.begin(), view.begin() + oldSize, view.end(), less);
     }
+}
 
-    return nullptr; // Not found
+void MediaManager::removeFromSortOrders(const std::vector<MediaFile*>& files) {
+    if (files.empty()) return;
+    std::unordered_set<MediaFile*> lookup;
+    if (files.size() > 1) lookup.insert(files.begin(), files.end());
+
+    for (int slot = 1; slot < SORT_ORDER_COUNT; ++slot) {
+        if (!this->sortedValid[slot]) continue;
+        std::vector<MediaFile*>& view = this->sortedViews[slot];
+        // By pointer: the keys may already have changed
+        if (files.size() == 1) {
+            auto it = std::find(view.begin(), view.end(), files[0]);
+            if (it != view.end()) view.erase(it);
+        } else {
+            view.erase(std::remove_if(view.begin(), view.end(),
+                                      [&lookup](MediaFile* file) { return lookup.count(file) != 0; }),
+                       view.end());
+        }
+    }
+}
+
+void MediaManager::invalidateSortOrders() {
+    for (int slot = 1; slot < SORT_ORDER_COUNT; ++slot) {
+        this->sortedValid[slot] = false;
+        std::vector<MediaFile*>().swap(this->sortedViews[slot]);
+    }
+}
+
+uint64_t MediaManager::getGeneration() const {
+    return this->generation;
+}
+
+bool MediaManager::ownsPath(const std::string& path) const {
+    for (const auto& root : this->roots) {
+        if (isUnderDirectory(path, root->path)) return true;
+    }
+    return false;
+}
+
+void MediaManager::setOnFileRemovedCallback(std::function<void(MediaFile*)> callback) {
+    this->onFileRemovedCallback_ = callback;
+}
+
+std::unique_ptr<Metadata> MediaManager::readTagsCached(const std::string& filePath, ScanProfile profile) {
+    long long size = -1, mtime = 0;
+    bool hasStat = FileUtils::getFileStat(filePath, size, mtime);
+
+    std::unique_ptr<Metadata> metadata;
+    if (this->libraryCache && hasStat && this->libraryCache->lookup(filePath, size, mtime, metadata)
+        && coversProfile(metadata, profile)) {
+        return metadata;
+    }
+
+    metadata = this->tagUtil->readTags(filePath, profile);
+    if (this->libraryCache && hasStat) {
+        this->libraryCache->store(filePath, size, mtime, metadata.get());
+    }
+    return metadata;
+}
+
+void MediaManager::eraseAt(size_t index) {
+    MediaFile* file = this->library[index].get();
+    if (this->onFileRemovedCallback_) {
+        this->onFileRemovedCallback_(file);
+    }
+    if (this->libraryCache) {
+        this->libraryCache->remove(file->getFilePath());
+    }
+    this->searchIndex.remove(file);
+    this->removeFromSortOrders({ file });
+    if (file->isMetadataPending()) --this->pendingMetadataCount;
+    this->pathIndex.erase(file->getFilePath()); // Before the key's backing string is freed
+    this->library.erase(this->library.begin() + index);
+    this->sortedViews[0].erase(this->sortedViews[0].begin() + index);
+    ++this->generation;
+}
+
+int MediaManager::eraseWhere(const std::function<bool(const MediaFile*)>& predicate) {
+    // One compacting pass; eraseAt() per file would be quadratic for a whole root
+    size_t kept = 0;
+    for (size_t i = 0; i < this->library.size(); ++i) {
+        MediaFile* file = this->library[i].get();
+        if (!predicate(file)) {
+            if (kept != i) this->library[kept] = std::move(this->library[i]);
+            ++kept;
+            continue;
+        }
+        if (this->onFileRemovedCallback_) {
+            this->onFileRemovedCallback_(file);
+        }
+        if (this->libraryCache) {
+            this->libraryCache->remove(file->getFilePath());
+        }
+        this->searchIndex.remove(file);
+        if (file->isMetadataPending()) --this->pendingMetadataCount;
+        this->pathIndex.erase(file->getFilePath()); // Before the key's backing string is freed
+        this->library[i].reset();
+    }
+    int removed = static_cast<int>(this->library.size() - kept);
+    if (removed == 0) return 0;
+
+    this->library.resize(kept);
+    this->sortedViews[0].clear();
+    for (const auto& file : this->library) this->sortedViews[0].push_back(file.get());
+    this->invalidateSortOrders(); // Cheaper to re-sort once than to patch per file
+    ++this->generation;
+    return removed;
+}
+
+MediaFile* MediaManager::addOrUpdateFile(const std::string& filePath) {
+    std::unique_ptr<Metadata> metadata = this->readTagsCached(filePath, this->scanProfile);
+    MediaFile* existing = this->findFileByPath(filePath);
+
+    if (!metadata) {
+        std::cerr << "MediaManager: Could not read metadata for changed file: " << filePath << std::endl;
+        return existing; // Keep the old entry rather than dropping a track mid-write
+    }
+    if (metadata->estimated) this->queueRefinement({ filePath });
+
+    if (existing) {
+        if (existing->isMetadataPending()) --this->pendingMetadataCount;
+        existing->setMetadata(std::move(metadata));
+        existing->setContentHash(0);
+        this->notifyMetadataChanged(existing);
+        std::cout << "MediaManager: Refreshed " << filePath << std::endl;
+        return existing;
+    }
+
+    // New files go to the end; a full reload would place them in scan order
+    MediaFile* added = this->addMediaFile(std::make_unique<MediaFile>(filePath, std::move(metadata)));
+    std::cout << "MediaManager: Added " << filePath << std::endl;
+    return added;
+}
+
+bool MediaManager::removeFile(const std::string& filePath) {
+    return this->removeFiles({ filePath }) == 1;
+}
+
+int MediaManager::removeFiles(const std::vector<std::string>& filePaths) {
+    std::unordered_set<const MediaFile*> doomed;
+    for (const auto& path : filePaths) {
+        MediaFile* file = this->findFileByPath(path);
+        if (file) doomed.insert(file);
+    }
+    if (doomed.empty()) return 0;
+
+    if (doomed.size() == 1) {
+        // A single file keeps the sort orders patched rather than re-sorted
+        const MediaFile* file = *doomed.begin();
+        auto it = std::find_if(this->library.begin(), this->library.end(),
+                               [file](const std::unique_ptr<MediaFile>& entry) { return entry.get() == file; });
+        std::cout << "MediaManager: Removed " << file->getFilePath() << std::endl;
+        this->eraseAt(static_cast<size_t>(it - this->library.begin()));
+        return 1;
+    }
+    int removed = this->eraseWhere([&doomed](const MediaFile* file) { return doomed.count(file) > 0; });
+    std::cout << "MediaManager: Removed " << removed << " files" << std::endl;
+    return removed;
+}
+
+bool MediaManager::renameFile(const std::string& oldPath, const std::string& newPath) {
+    MediaFile* file = this->findFileByPath(oldPath);
+    if (!file) return false;
+
+    if (this->findFileByPath(newPath)) {
+        this->removeFile(newPath); // Rename replaced an existing file
+    }
+
+    this->pathIndex.erase(oldPath);
+    file->setFilePath(newPath);
+    file->setSourceRoot(this->rootIdFor(newPath));
+    this->pathIndex.emplace(file->getFilePath(), file);
+    this->notifyMetadataChanged(file); // The file name is searchable too
+
+    if (this->libraryCache) {
+        this->libraryCache->remove(oldPath);
+        long long size = 0, mtime = 0;
+        if (FileUtils::getFileStat(newPath, size, mtime)) {
+            this->libraryCache->store(newPath, size, mtime, file->getMetadata());
+            this->libraryCache->storeContentHash(newPath, size, mtime, file->getContentHash()); // Same bytes
+        }
+    }
+    std::cout << "MediaManager: Renamed " << oldPath << " -> " << newPath << std::endl;
+    return true;
+}
+
+int MediaManager::removeFilesUnder(const std::string& dirPath) {
+    std::string prefix = dirPath + "/";
+    int removed = this->eraseWhere([&prefix](const MediaFile* file) {
+        return file->getFilePath().compare(0, prefix.size(), prefix) == 0;
+    });
+    std::cout << "MediaManager: Removed " << removed << " files under " << dirPath << std::endl;
+    return removed;
+}
+
+int MediaManager::renameDirectory(const std::string& oldDir, const std::string& newDir) {
+    std::string oldPrefix = oldDir + "/";
+    int renamed = 0;
+    this->invalidateSortOrders();
+    for (auto& filePtr : this->library) {
+        const std::string& path = filePtr->getFilePath();
+        if (path.compare(0, oldPrefix.size(), oldPrefix) == 0) {
+            std::string newPath = newDir + path.substr(oldDir.size());
+            if (this->libraryCache) {
+                this->libraryCache->remove(path);
+                long long size = 0, mtime = 0;
+                if (FileUtils::getFileStat(newPath, size, mtime)) {
+                    this->libraryCache->store(newPath, size, mtime, filePtr->getMetadata());
+                    this->libraryCache->storeContentHash(newPath, size, mtime, filePtr->getContentHash());
+                }
+            }
+            this->pathIndex.erase(path);
+            filePtr->setFilePath(newPath);
+            filePtr->setSourceRoot(this->rootIdFor(newPath));
+            this->pathIndex.emplace(filePtr->getFilePath(), filePtr.get());
+            this->notifyMetadataChanged(filePtr.get());
+            ++renamed;
+        }
+    }
+    std::cout << "MediaManager: Renamed " << renamed << " files from " << oldDir << " to " << newDir << std::endl;
+    return renamed;
+}
+
+void MediaManager::syncWithDirectory() {
+    // The diff runs on each root's worker, like any rescan; a busy root is queued for when it is done
+    for (const auto& root : this->roots) {
+        if (root->busy) root->resyncWanted = true;
+        else this->rescanRoot(root->path);
+    }
 }
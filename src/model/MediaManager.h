@@ -1,24 +1,331 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
 #include "MediaFile.h"
+#include "SearchIndex.h"
+#include "utils/TagLibWrapper.h"
+#include "utils/ScanScheduler.h"
+#include "utils/BackgroundFileWriter.h"
 
-class TagLibWrapper;
+// Browsing orders. DATE_ADDED is the library's own order (scan order, then files added later).
+enum class SortOrder { DATE_ADDED, ARTIST, ALBUM, YEAR, DURATION, FILE_NAME };
+
+// Non-owning view of consecutive library entries, like a span. No allocation;
+// invalidated by the next change to the library (see getGeneration()).
+struct MediaFileRange {
+    MediaFile* const* first = nullptr;
+    size_t count = 0;
+
+    MediaFile* const* begin() const { return first; }
+    MediaFile* const* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    MediaFile* operator[](size_t index) const { return first[index]; }
+};
+
+// How far the running scans have got, over every root being scanned
+struct ScanProgress {
+    int discovered = 0;    // Files found by the directory walks so far
+    int processed = 0;     // Of those, read or checked
+    bool walking = false;  // A walk is not done yet, so 'discovered' will still grow
+    bool waiting = false;  // Held back by a scan of higher priority (see ScanScheduler)
+
+    // "Loading... 120/4000 files" (or "Scanning..." until the directory walks are done,
+    // and "Waiting..." while a library of higher priority has the disk)
+    std::string getStatusText() const;
+};
+
+class LibraryCache;
+class LibrarySnapshot;
+class ThreadPool;
 
 class MediaManager {
 private:
     std::vector<std::unique_ptr<MediaFile>> library;
+    // Keys view each entry's own filePath, so paths are stored once. Erase a key
+    // before changing that entry's path and re-insert it afterwards.
+    std::unordered_map<std::string_view, MediaFile*> pathIndex;
+    SearchIndex searchIndex;
+    uint64_t generation; // Bumped on every change to the library's entries
+
+    // --- Sort orders ---
+    // sortedViews[0] mirrors 'library' as plain pointers (DATE_ADDED) and is always current.
+    // The others are permutations sorted on first use, then kept in step as entries
+    // change; bulk renames/removals just invalidate them.
+    static const int SORT_ORDER_COUNT = 6;
+    SortOrder sortOrder;
+    std::vector<MediaFile*> sortedViews[SORT_ORDER_COUNT];
+    bool sortedValid[SORT_ORDER_COUNT];
     TagLibWrapper* tagUtil;
+    LibraryCache* libraryCache; // Optional, non-owning
+    int scanThreadCount; // 0 = one per hardware thread
+    ScanProfile scanProfile;
+    ScanScheduler* scanScheduler; // Optional, non-owning
+    ScanPriority scanPriority;
+    std::function<void(MediaFile*)> onFileRemovedCallback_;
+
+    // --- Library roots ---
+    // Each root has its own worker thread, which reads tags with a pool sized to the
+    // root's disk, so a slow disk does not hold up the others. A first scan fills
+    // 'pendingFiles'; a rescan diffs the root against what the library already has and
+    // leaves 'changes' and 'removals'. Either way 'library' is touched on the UI thread alone.
+    struct LibraryRoot {
+        std::string path;
+        uint16_t id; // MediaFile::getSourceRoot() of its entries
+        std::thread worker;
+        bool busy = false; // Worker started and not joined yet
+        bool rescanning = false;
+        bool resyncWanted = false; // Events were lost while it was busy: rescan once it is done
+        std::atomic<bool> cancelled{ false };
+        std::atomic<bool> finished{ false };
+        std::atomic<bool> walked{ false };
+        std::atomic<int> discovered{ 0 };
+        std::atomic<int> processed{ 0 };
+        std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> changes; // Rescan results, under pendingMutex
+        std::vector<std::string> removals;
+    };
+    std::vector<std::unique_ptr<LibraryRoot>> roots; // In the order they were added
+    uint16_t nextRootId;
+    std::atomic<int> runningScans{ 0 }; // Root workers not done yet; the last one saves the cache
+
+    // --- Background loading ---
+    static const size_t FIRST_BATCH_SIZE = 64;
+    static const size_t BATCH_SIZE = 512;
+    std::mutex pendingMutex;
+    std::vector<std::unique_ptr<MediaFile>> pendingFiles;
+    bool loading; // Some root's worker is busy
+    std::atomic<bool> loadCancelled; // Snapshot check
+
+    // --- Lazy metadata ---
+    // Views have the prefetch thread read the page on screen and its neighbours, and it
+    // hands the tags back through 'prefetchedTags'; ensureMetadata() reads on the caller's
+    // thread where a file is needed at once. Entries are only changed on the UI thread.
+    bool lazyMetadata;
+    int pendingMetadataCount;
+    std::thread prefetchThread;
+    std::mutex prefetchMutex;
+    std::condition_variable prefetchWake;
+    bool prefetchStopping;
+    std::deque<std::string> prefetchQueue; // The page on screen, then its neighbours
+    std::string prefetchReading; // Taken from prefetchQueue and being read
+    std::deque<std::string> prefetchRequested; // UI thread: what the last request asked for
+    std::deque<std::string> backfillQueue; // Everything else, while sorting by a tag
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> prefetchedTags;
+
+    // --- Refinement ---
+    // Estimated entries (ScanProfile::FAST) are re-read with ACCURATE by the prefetch
+    // thread once it has nothing else to do, and handed back through 'refinedTags'.
+    std::deque<std::string> refineQueue; // Under prefetchMutex, like the two above
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> refinedTags;
+    int refineRemaining; // Queued but not applied yet
+
+    // --- Snapshot ---
+    std::string snapshotPath; // Empty: snapshots off
+    uint64_t snapshotGeneration; // 'generation' when the snapshot was last written or restored
+    size_t snapshotFailures; // snapshotWriter's failed count when last looked at
+    BackgroundFileWriter snapshotWriter; // Serialises and writes off the UI thread
+    std::unique_ptr<LibrarySnapshot> checkedSnapshot; // Stays mapped while the check runs
+    std::thread checkThread;
+    std::atomic<bool> checkFinished;
+    bool checking;
+    std::vector<std::pair<std::string, std::unique_ptr<Metadata>>> checkChanges; // Under pendingMutex
+    std::vector<std::string> checkRemovals;
+
+    // --- Content hashing ---
+    // Workers hash a list of paths taken on the UI thread and hand results back through
+    // 'hashResults'; the hashes are set on the entries by applyPendingFiles().
+    struct HashResult {
+        std::string path;
+        long long size;
+        long long mtime;
+        uint64_t hash; // 0: unreadable, or changed while hashing
+    };
+    std::thread hashThread;
+    std::atomic<bool> hashCancelled;
+    std::atomic<bool> hashFinished;
+    std::atomic<int> hashedCount;
+    bool hashing;
+    bool hashWanted; // Set by startHashing(), cleared by stopHashing()
+    bool hashAfterLoad; // The job started mid-load: hash what the load added once both are done
+    int hashTotal;
+    int hashThreadCount;
+    size_t hashBytesPerSecond;
+    std::vector<HashResult> hashResults; // Under pendingMutex
+
+    LibraryRoot* registerRoot(const std::string& path);
+    LibraryRoot* findRoot(const std::string& path) const;
+    uint16_t rootIdFor(const std::string& filePath) const; // 0 if under no root
+    void markRootBusy(LibraryRoot* root, bool rescanning); // Before its worker starts
+    void stopRootWorker(LibraryRoot* root);
+    void rootScanWorker(LibraryRoot* root);
+    void rootRescanWorker(LibraryRoot* root, std::unordered_map<std::string, std::pair<long long, long long>> known);
+    bool applyRootResults(); // Joins finished workers and applies their rescans
+    void applyDiskChanges(std::vector<std::pair<std::string, std::unique_ptr<Metadata>>>& changes,
+                          const std::vector<std::string>& removals);
+    int eraseWhere(const std::function<bool(const MediaFile*)>& predicate);
+    void snapshotCheckWorker(std::vector<std::string> paths);
+    bool applySnapshotCheck();
+    void hashWorker(std::vector<std::string> paths);
+    bool applyContentHashes();
+    void prefetchWorker();
+    void startPrefetcher();
+    void stopPrefetcher();
+    void backfillMetadata();
+    bool applyPrefetchedMetadata();
+    void queueRefinement(std::deque<std::string> paths);
+    bool applyRefinedMetadata();
+    bool applyLoadedMetadata(std::vector<std::pair<MediaFile*, std::unique_ptr<Metadata>>>& loaded);
+    bool waitScanTurn(const std::atomic<bool>& cancelled); // See ScanScheduler::waitTurn()
+    std::unique_ptr<ThreadPool> makeScanPool(size_t fileCount, int threads = 0) const; // 0: setScanThreadCount()
+    int readerThreadsFor(const std::string& rootPath) const;
+    std::vector<std::unique_ptr<MediaFile>> buildMediaFiles(const std::vector<std::string>& files,
+                                                            size_t begin, size_t end, ThreadPool* pool,
+                                                            const std::atomic<bool>* cancelled = nullptr);
+    void finishScan(const std::string& path, const std::vector<std::string>& files); // Prunes the cache
+    void endRootWorker(LibraryRoot* root);
+    std::unique_ptr<Metadata> readTagsCached(const std::string& filePath, ScanProfile profile);
+    void eraseAt(size_t index);
+    MediaFile* addEntry(std::unique_ptr<MediaFile> file, bool indexForSearch = true); // Library, path and search index only
+    const std::vector<MediaFile*>& getSortedView(SortOrder order);
+    void insertIntoSortOrders(std::vector<MediaFile*> added);
+    void removeFromSortOrders(const std::vector<MediaFile*>& files);
+    void invalidateSortOrders();
 public:
     MediaManager(TagLibWrapper* tagUtil);
+    ~MediaManager();
 
-    void loadFromDirectory(const std::string& path);
-    void clearLibrary();
+    void setLibraryCache(LibraryCache* cache);
+    void setScanThreadCount(int threads);
+    int getScanThreadCount() const;
+    // How scans read tags (see ScanProfile); set before loading. Entries read with FAST
+    // are refined in the background after each scan: exact durations and the remaining
+    // tags arrive through applyPendingFiles().
+    void setScanProfile(ScanProfile profile);
+    ScanProfile getScanProfile() const;
+    void refineMetadata(); // Queues every estimated entry for an ACCURATE re-read
+    int getRefinePendingCount() const;
 
-    std::vector<MediaFile*> getPage(int pageNumber, int pageSize = 25);
+    void loadFromDirectory(const std::string& path); // Replaces the library with this one root, scanned now
+    void clearLibrary(); // Also forgets the roots
+
+    // Replaces the library with these roots, each scanned and its tags read by its own
+    // worker thread. Results become visible in batches each time applyPendingFiles()
+    // is called from the UI loop.
+    void startBackgroundLoad(const std::string& path);
+    void startBackgroundLoad(const std::vector<std::string>& paths);
+    bool applyPendingFiles(); // True if the library changed (new files, prefetched or refined tags, hashes, snapshot check, rescans or load finished)
+    // Stops every scan promptly: walks and tag reads check for it between files.
+    void cancelBackgroundLoad(); // Also stops the metadata prefetcher and hashing
+    bool isLoading() const; // A scan or rescan of any root is running
+    int getDiscoveredFileCount() const; // Files found by the scans so far (0 until a walk is done)
+    ScanProgress getScanProgress() const;
+
+    // Background scans of libraries sharing a scheduler take turns by priority: the one
+    // on screen is usually FOREGROUND. Set the scheduler before loading; the priority
+    // may change at any time and takes effect at the next file.
+    void setScanScheduler(ScanScheduler* scheduler);
+    void setScanPriority(ScanPriority priority);
+    ScanPriority getScanPriority() const;
+
+    // --- Library roots ---
+    // The library merges several directory trees; every entry is tagged with the root it
+    // came from. Each root's tags are read by as many threads as suit its disk (see
+    // FileUtils::getReaderThreadCount()) unless setScanThreadCount() says otherwise.
+    // Roots may not overlap. Each can be rescanned or dropped without touching the others.
+    bool addRoot(const std::string& path); // Scanned in the background
+    bool rescanRoot(const std::string& path); // Changed, new and deleted files, in the background
+    bool removeRoot(const std::string& path); // Drops its entries (the removed callback runs for each)
+    std::vector<std::string> getRoots() const;
+    bool isRootLoading(const std::string& path) const;
+    const std::string& getSourceRoot(const MediaFile* file) const; // Path of the file's root, empty if none
+
+    // Snapshots (see LibrarySnapshot). With a snapshot file set, every finished scan writes
+    // one, and loadFromSnapshot() restores the library, its sort orders and search index
+    // without scanning. The restored library is then checked against the disk on a worker
+    // thread (stat only; tags are read for changed files), and the differences arrive
+    // through applyPendingFiles().
+    void setSnapshotFile(const std::string& filePath);
+    bool saveSnapshot(); // Queued for a worker; no-op if nothing changed since the last save/restore
+    void flushSnapshot(); // Blocks until a snapshot being written is on disk
+    bool loadFromSnapshot(const std::string& path); // False unless there is an intact snapshot of 'path'
+    bool loadFromSnapshot(const std::vector<std::string>& paths); // Same roots, in the same order
+    bool isCheckingSnapshot() const;
+
+    // Lazy mode: scans record paths and stat data only (plus tags already in the library
+    // cache). A prefetcher reads the tags of the page on screen and the pages around it,
+    // and they are read at once when a file is played or edited. Until then search and
+    // tag sort orders see just the file name; choosing a tag sort order queues the rest
+    // of the library for reading.
+    void setLazyMetadata(bool lazy);
+    bool isLazyMetadata() const;
+    bool ensureMetadata(MediaFile* file);      // Reads pending tags now; true if any were read
+    bool ensureMetadata(MediaFileRange files); // Same for a page, in parallel. Take the range again afterwards
+    // Queues the pending tags of 'page' (on screen), then of the pages after and before
+    // range(offset, count); count 0 for a page that is no plain range, like search results.
+    // Never blocks, and a repeated request (every redraw) leaves the queue as it is.
+    void prefetchPage(MediaFileRange page, size_t offset = 0, size_t count = 0);
+    void prefetchAround(size_t offset, size_t count); // Same, for the page range(offset, count)
+    int getPendingMetadataCount() const;
+
+    // Duplicate detection: hashes the audio payload of every file not hashed yet (see
+    // AudioHash) on a few worker threads, reading at most 'bytesPerSecond' between them.
+    // Hashes are kept in the library cache and the snapshot, so a stopped job resumes
+    // where it left off; results arrive through applyPendingFiles(). Started during a
+    // load, it picks up the rest of the library when the load is done.
+    bool startHashing(int threads = 2, size_t bytesPerSecond = 16 * 1024 * 1024); // False if nothing to hash
+    void stopHashing(); // Keeps the hashes finished so far
+    bool isHashing() const;
+    int getHashedCount() const; // Progress of the running (or last) job
+    int getHashTotal() const;
+    // Groups of two or more files with the same payload hash, each in library order,
+    // groups ordered by their first file
+    std::vector<std::vector<MediaFile*>> findDuplicates() const;
+
+    // Pages follow the current sort order
+    void setSortOrder(SortOrder order);
+    SortOrder getSortOrder() const;
+    static const char* getSortOrderName(SortOrder order);
+
+    // --- Indexed access in the current order (allocation-free) ---
+    MediaFile* at(size_t index);                    // nullptr when out of range
+    int indexOf(MediaFile* file);                   // -1 if not here ('file' must be alive; other libraries' files are fine)
+    MediaFileRange range(size_t offset, size_t count); // Clamped to the library size
+
+    std::vector<MediaFile*> getPage(int pageNumber, int pageSize = 25); // Copying wrapper over range()
     int getTotalPages(int pageSize = 25) const;
     int getTotalFileCount() const;
-    MediaFile* findFileByPath(const std::string& filePath) const;
+    MediaFile* findFileByPath(const std::string& filePath) const; // O(1) via pathIndex
+    MediaFile* addMediaFile(std::unique_ptr<MediaFile> file); // Appends an already-built entry
+
+    // Ranked type-ahead search over title, artist, album and file name
+    std::vector<MediaFile*> search(const std::string& query, size_t limit = 200) const;
+    void notifyMetadataChanged(MediaFile* file); // After editing a file's Metadata in place
+    void notifyMetadataChanged(const std::vector<MediaFile*>& files); // Same for several, one re-sort
+    // Changes whenever files are added, removed, renamed or re-tagged. Lets views
+    // holding MediaFile* (e.g. search results) know when to refresh them.
+    uint64_t getGeneration() const;
+
+    bool ownsPath(const std::string& path) const; // True if 'path' is under one of the roots
+
+    // --- Incremental updates (library watcher) ---
+    // Untouched MediaFile objects stay alive, so pointers held by playlists and the player remain valid.
+    // The removed callback runs before a MediaFile is destroyed so holders can drop their pointer.
+    void setOnFileRemovedCallback(std::function<void(MediaFile*)> callback);
+    MediaFile* addOrUpdateFile(const std::string& filePath);
+    bool removeFile(const std::string& filePath);
+    int removeFiles(const std::vector<std::string>& filePaths); // One pass for the lot
+    bool renameFile(const std::string& oldPath, const std::string& newPath);
+    int removeFilesUnder(const std::string& dirPath);
+    int renameDirectory(const std::string& oldDir, const std::string& newDir);
+    void syncWithDirectory(); // Rescan every root after lost events; results arrive through applyPendingFiles()
 
 };
\ No newline at end of file
@@ -1,21 +1,52 @@
 #include "model/Metadata.h"
+#include "utils/StringPool.h"
+#include <algorithm>
+#include <cstdlib>
 
-Metadata::Metadata() : durationInSeconds(0) {
-    // initialize
-    fields["artist"] = "";
-    fields["album"] = "";
-    fields["genre"] = "";
-    fields["year"] = "0";
+namespace {
+    int parseLeadingInt(const std::string& value) {
+        return static_cast<int>(std::strtol(value.c_str(), nullptr, 10)); // "3/12" -> 3, "abc" -> 0
+    }
+
+    bool keyLess(const std::pair<const std::string*, std::string>& entry, const std::string& key) {
+        return *entry.first < key;
+    }
+}
+
+Metadata::Metadata()
+    : artist(StringPool::empty()), album(StringPool::empty()), genre(StringPool::empty()) {
+}
+
+void Metadata::setArtist(const std::string& value) {
+    this->artist = StringPool::shared().intern(value);
+}
+
+void Metadata::setAlbum(const std::string& value) {
+    this->album = StringPool::shared().intern(value);
+}
+
+void Metadata::setGenre(const std::string& value) {
+    this->genre = StringPool::shared().intern(value);
+}
+
+void Metadata::setYear(int value) {
+    this->year = value;
 }
 
+void Metadata::setTrackNumber(int value) {
+    this->trackNumber = value;
+}
 
 std::string Metadata::getField(const std::string& key) const {
-    if (key == "title") {
-        return this->title;
-    }
-    
-    auto it = this->fields.find(key);
-    if (it != this->fields.end()) {
+    if (key == "title") return this->title;
+    if (key == "artist") return *this->artist;
+    if (key == "album") return *this->album;
+    if (key == "genre") return *this->genre;
+    if (key == "year") return std::to_string(this->year);
+    if (key == "tracknumber") return this->trackNumber > 0 ? std::to_string(this->trackNumber) : "";
+
+    auto it = std::lower_bound(this->extraFields.begin(), this->extraFields.end(), key, keyLess);
+    if (it != this->extraFields.end() && *it->first == key) {
         return it->second;
     }
     
@@ -23,9 +54,32 @@ std::string Metadata::getField(const std::string& key) const {
 }
 
 void Metadata::setField(const std::string& key, const std::string& value) {
-    if (key == "title") {
-        this->title = value;
+    if (key == "title") { this->title = value; return; }
+    if (key == "artist") { setArtist(value); return; }
+    if (key == "album") { setAlbum(value); return; }
+    if (key == "genre") { setGenre(value); return; }
+    if (key == "year") { setYear(parseLeadingInt(value)); return; }
+    if (key == "tracknumber") { setTrackNumber(parseLeadingInt(value)); return; }
+
+    auto it = std::lower_bound(this->extraFields.begin(), this->extraFields.end(), key, keyLess);
+    if (it != this->extraFields.end() && *it->first == key) {
+        it->second = value;
+    } else {
+        this->extraFields.insert(it, { StringPool::shared().intern(key), value });
     }
-    
-    this->fields[key] = value;
-}
\ No newline at end of file
+}
+
+std::map<std::string, std::string> Metadata::getFields() const {
+    std::map<std::string, std::string> fields;
+    fields["artist"] = *this->artist;
+    fields["album"] = *this->album;
+    fields["genre"] = *this->genre;
+    fields["year"] = std::to_string(this->year);
+    if (this->trackNumber > 0) {
+        fields["tracknumber"] = std::to_string(this->trackNumber);
+    }
+    for (const auto& [key, value] : this->extraFields) {
+        fields[*key] = value;
+    }
+    return fields;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <map>
+#include <vector>
+#include <utility>
 
 class Metadata {
 public:
@@ -10,10 +12,35 @@ public:
     std::string title;
     int durationInSeconds = 0;
     long fileSizeInBytes = 0;
+    // Read with ScanProfile::FAST: the duration may be a header estimate and only the
+    // standard tags were read. MediaManager re-reads such entries in the background.
+    bool estimated = false;
 
-    
+    // Standard tags. Strings are interned, so tracks of one album share them.
+    const std::string& getArtist() const { return *artist; }
+    const std::string& getAlbum() const { return *album; }
+    const std::string& getGenre() const { return *genre; }
+    int getYear() const { return year; }
+    int getTrackNumber() const { return trackNumber; }
+    void setArtist(const std::string& value);
+    void setAlbum(const std::string& value);
+    void setGenre(const std::string& value);
+    void setYear(int value);
+    void setTrackNumber(int value);
+
+    // String access by lower-case key. Standard keys map onto the typed fields above.
     virtual std::string getField(const std::string& key) const;
     void setField(const std::string& key, const std::string& value);
+    std::map<std::string, std::string> getFields() const; // Built on demand (serialisation only)
+    const std::vector<std::pair<const std::string*, std::string>>& getExtraFields() const { return extraFields; }
+
 protected:
-    std::map<std::string, std::string> fields;
-};
\ No newline at end of file
+    const std::string* artist;
+    const std::string* album;
+    const std::string* genre;
+    int year = 0;
+    int trackNumber = 0;
+
+    // Everything else, sorted by key (interned). Stays empty for most tracks.
+    std::vector<std::pair<const std::string*, std::string>> extraFields;
+};
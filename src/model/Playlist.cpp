@@ -15,14 +15,13 @@ void Playlist::addTrack(MediaFile* file) {
     if (file == nullptr) {
         return;
     }
-    auto it = std::find(tracks.begin(), tracks.end(), file);
-    if (it == tracks.end()) { // Add only if not already present
+    if (trackSet.insert(file).second) { // Add only if not already present
         tracks.push_back(file);
     }
 }
 
 bool Playlist::removeTrack(MediaFile* file) {
-    if (file == nullptr) {
+    if (file == nullptr || trackSet.erase(file) == 0) {
         return false;
     }
     auto it = std::remove(tracks.begin(), tracks.end(), file);
@@ -34,7 +33,53 @@ bool Playlist::removeTrack(MediaFile* file) {
     return false; // Element not found
 }
 
+bool Playlist::moveTrack(size_t from, size_t to) {
+    if (from >= tracks.size() || to >= tracks.size()) {
+        return false;
+    }
+    if (from < to) {
+        std::rotate(tracks.begin() + from, tracks.begin() + from + 1, tracks.begin() + to + 1);
+    } else if (from > to) {
+        std::rotate(tracks.begin() + to, tracks.begin() + from, tracks.begin() + from + 1);
+    }
+    return true;
+}
+
 const std::vector<MediaFile*>& Playlist::getTracks() const {
     return this->tracks;
 }
 
+void Playlist::setTracks(const std::vector<MediaFile*>& newTracks) {
+    tracks.clear();
+    trackSet.clear();
+    for (MediaFile* file : newTracks) {
+        addTrack(file);
+    }
+}
+
+bool Playlist::containsTrack(const MediaFile* file) const {
+    return trackSet.count(file) > 0;
+}
+
+const std::vector<std::string>& Playlist::getMissingTracks() const {
+    return this->missingTracks;
+}
+
+void Playlist::setMissingTracks(const std::vector<std::string>& paths) {
+    this->missingTracks = paths; // Unchecked: a whole unmounted root can be many thousands
+}
+
+void Playlist::addMissingTrack(const std::string& path) {
+    if (std::find(missingTracks.begin(), missingTracks.end(), path) == missingTracks.end()) {
+        missingTracks.push_back(path);
+    }
+}
+
+bool Playlist::removeMissingTrack(const std::string& path) {
+    auto it = std::find(missingTracks.begin(), missingTracks.end(), path);
+    if (it == missingTracks.end()) {
+        return false;
+    }
+    missingTracks.erase(it);
+    return true;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <unordered_set>
 #include "MediaFile.h"
 
 class Playlist {
@@ -12,10 +13,23 @@ public:
 void addTrack(MediaFile* file);
     
     bool removeTrack(MediaFile* file);
+    bool moveTrack(size_t from, size_t to); // Others shift to make room; false if out of range
 
     const std::vector<MediaFile*>& getTracks() const;
+    void setTracks(const std::vector<MediaFile*>& newTracks);
+    bool containsTrack(const MediaFile* file) const;
+
+    // Tracks in the playlist file that no library holds right now (a root or stick that
+    // is not mounted), by path. Kept so that saving does not drop them; written after
+    // the others.
+    const std::vector<std::string>& getMissingTracks() const;
+    void setMissingTracks(const std::vector<std::string>& paths);
+    void addMissingTrack(const std::string& path); // No-op if already there
+    bool removeMissingTrack(const std::string& path); // Linear; for journal replay
 
 private:
     std::string name;
     std::vector<MediaFile*> tracks;
+    std::unordered_set<const MediaFile*> trackSet; // O(1) duplicate check for addTrack
+    std::vector<std::string> missingTracks;
 };
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "model/PlaylistExchange.h"
+#include "model/MediaFile.h"
+#include "model/Metadata.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool startsWithNoCase(const std::string& text, const char* prefix) {
+        size_t i = 0;
+        for (; prefix[i] != '\0'; ++i) {
+            if (i >= text.size() || std::tolower(static_cast<unsigned char>(text[i])) != prefix[i]) return false;
+        }
+        return true;
+    }
+
+    // Without the line ending (either kind) and surrounding blanks
+    void trim(std::string& line) {
+        size_t end = line.find_last_not_of(" \t\r");
+        if (end == std::string::npos) {
+            line.clear();
+            return;
+        }
+        line.erase(end + 1);
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin > 0) line.erase(0, begin);
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    std::string percentDecode(const std::string& text, size_t from) {
+        std::string decoded;
+        decoded.reserve(text.size() - from);
+        for (size_t i = from; i < text.size(); ++i) {
+            int high, low;
+            if (text[i] == '%' && i + 2 < text.size() && (high = hexValue(text[i + 1])) >= 0 && (low = hexValue(text[i + 2])) >= 0) {
+                decoded += static_cast<char>(high * 16 + low);
+                i += 2;
+            } else {
+                decoded += text[i];
+            }
+        }
+        return decoded;
+    }
+
+    // Full path of an entry as written in the playlist; empty to skip it
+    std::string resolveEntry(const std::string& entry, const std::string& baseDir) {
+        std::string path;
+        if (startsWithNoCase(entry, "file://")) {
+            size_t start = 7;
+            if (startsWithNoCase(entry.substr(start, 9), "localhost")) start += 9;
+            path = percentDecode(entry, start);
+        } else if (entry.find("://") != std::string::npos) {
+            return ""; // A stream; not something the library holds
+        } else {
+            path = entry;
+        }
+        if (path.empty()) return "";
+        if (path[0] != '/') path = baseDir + "/" + path;
+        // Most entries are clean full paths already; only the others pay for normalising
+        if (path.find("/./") != std::string::npos || path.find("/../") != std::string::npos
+            || path.find("//") != std::string::npos || (path.size() > 1 && path.back() == '.')) {
+            path = fs::path(path).lexically_normal().string();
+        }
+        return path;
+    }
+
+    // Without line breaks, which would end the entry early
+    std::string oneLine(std::string text) {
+        std::replace(text.begin(), text.end(), '\n', ' ');
+        std::replace(text.begin(), text.end(), '\r', ' ');
+        return text;
+    }
+
+    // "Artist - Title", the title alone, or the file name when the tags are not read (yet)
+    std::string displayTitle(const MediaFile* file) {
+        const Metadata* metadata = file->getMetadata();
+        if (metadata && !metadata->title.empty()) {
+            if (metadata->getArtist().empty()) return oneLine(metadata->title);
+            return oneLine(metadata->getArtist() + " - " + metadata->title);
+        }
+        return oneLine(std::string(file->getFileName()));
+    }
+
+    int durationOf(const MediaFile* file) {
+        const Metadata* metadata = file->getMetadata();
+        return metadata && metadata->durationInSeconds > 0 ? metadata->durationInSeconds : -1; // -1: unknown
+    }
+
+    bool readM3u(std::istream& in, const std::string& baseDir, const PlaylistExchange::OnEntry& onEntry) {
+        std::string line;
+        bool first = true;
+        while (std::getline(in, line)) {
+            if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3); // Byte order mark
+            first = false;
+            trim(line);
+            if (line.empty() || line[0] == '#') continue;
+            std::string path = resolveEntry(line, baseDir);
+            if (!path.empty()) onEntry(path);
+        }
+        return true;
+    }
+
+    bool readPls(std::istream& in, const std::string& baseDir, const PlaylistExchange::OnEntry& onEntry, std::string& error) {
+        std::string line;
+        bool first = true;
+        bool inPlaylist = false;
+        bool sawSection = false;
+        while (std::getline(in, line)) {
+            if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+            first = false;
+            trim(line);
+            if (line.empty() || line[0] == ';' || line[0] == '#') continue;
+            if (line[0] == '[') {
+                inPlaylist = startsWithNoCase(line, "[playlist]");
+                sawSection = sawSection || inPlaylist;
+                continue;
+            }
+            // FileN=path; Title/Length only describe it
+            if (!inPlaylist || !startsWithNoCase(line, "file")) continue;
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) continue;
+            std::string key = line.substr(0, equals);
+            trim(key);
+            if (key.size() == 4 || !std::all_of(key.begin() + 4, key.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+                continue;
+            std::string entry = line.substr(equals + 1);
+            trim(entry);
+            std::string path = resolveEntry(entry, baseDir);
+            if (!path.empty()) onEntry(path);
+        }
+        if (!sawSection) {
+            error = "no [playlist] section";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool PlaylistExchange::formatFromPath(const std::string& path, Format& format) {
+    std::string extension = fs::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (extension == ".m3u") format = Format::M3U;
+    else if (extension == ".m3u8") format = Format::M3U8;
+    else if (extension == ".pls") format = Format::PLS;
+    else return false;
+    return true;
+}
+
+bool PlaylistExchange::read(std::istream& in, Format format, const std::string& baseDir, const OnEntry& onEntry, std::string& error) {
+    std::string base = baseDir.empty() ? "." : baseDir;
+    if (format == Format::PLS) return readPls(in, base, onEntry, error);
+    return readM3u(in, base, onEntry);
+}
+
+void PlaylistExchange::write(std::ostream& out, Format format, const std::vector<MediaFile*>& tracks, const std::string& baseDir) {
+    std::string prefix = baseDir;
+    if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+    std::string buffer;
+    buffer.reserve(64 * 1024 + 4096);
+    auto drain = [&out, &buffer](bool force) {
+        if (force || buffer.size() >= 64 * 1024) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    buffer += format == Format::PLS ? "[playlist]\n" : "#EXTM3U\n";
+    size_t number = 0;
+    for (const MediaFile* file : tracks) {
+        if (!file) continue;
+        const std::string& path = file->getFilePath();
+        if (path.find_first_of("\r\n") != std::string::npos) {
+            std::cerr << "PlaylistExchange Warning: Cannot write a path with a line break, skipping: " << oneLine(path) << std::endl;
+            continue;
+        }
+        bool relative = !prefix.empty() && path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0;
+        const char* entry = path.c_str() + (relative ? prefix.size() : 0);
+
+        if (format == Format::PLS) {
+            std::string n = std::to_string(++number);
+            buffer += "File" + n + "=";
+            buffer += entry;
+            buffer += "\nTitle" + n + "=" + displayTitle(file);
+            buffer += "\nLength" + n + "=" + std::to_string(durationOf(file)) + "\n";
+        } else {
+            buffer += "#EXTINF:" + std::to_string(durationOf(file)) + "," + displayTitle(file) + "\n";
+            buffer += entry;
+            buffer += '\n';
+        }
+        drain(false);
+    }
+    if (format == Format::PLS) buffer += "NumberOfEntries=" + std::to_string(number) + "\nVersion=2\n";
+    drain(true);
+}
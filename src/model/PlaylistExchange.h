@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <functional>
+
+class MediaFile;
+
+// Playlists in the formats other players use, read and written a line at a time.
+//   M3U / M3U8: one path per line, "#" lines are comments or #EXTINF directives.
+//               Read the same way: paths are taken as the bytes they are on disk.
+//   PLS:        an INI-style "[playlist]" section with File1=..., Title1=..., Length1=...
+namespace PlaylistExchange {
+    enum class Format { M3U, M3U8, PLS };
+
+    // From the extension of 'path' (any case); false if it is none of the above
+    bool formatFromPath(const std::string& path, Format& format);
+
+    using OnEntry = std::function<void(const std::string& path)>;
+
+    // Calls 'onEntry' with the full path of each entry, in file order. Relative paths
+    // are taken against 'baseDir' (the playlist's own directory) and normalised;
+    // file:// URLs are decoded, other URLs skipped. False (with 'error' set) if a PLS
+    // file has no [playlist] section.
+    bool read(std::istream& in, Format format, const std::string& baseDir, const OnEntry& onEntry, std::string& error);
+
+    // Tracks under 'baseDir' are written relative to it, so the playlist moves with
+    // them (e.g. on a stick); the rest as full paths. #EXTINF/Title/Length come from
+    // the metadata where it has been read.
+    void write(std::ostream& out, Format format, const std::vector<MediaFile*>& tracks, const std::string& baseDir);
+}
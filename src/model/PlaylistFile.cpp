@@ -0,0 +1,507 @@
+#include "model/PlaylistFile.h"
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    // Length of the UTF-8 sequence starting at 'i', or 0 if it is not a valid one
+    // (overlong forms and surrogates included, as json::dump() rejects them)
+    size_t utf8Length(const std::string& s, size_t i) {
+        auto byte = [&s](size_t at) { return static_cast<unsigned char>(s[at]); };
+        auto inRange = [&](size_t at, unsigned char lo, unsigned char hi) {
+            return at < s.size() && byte(at) >= lo && byte(at) <= hi;
+        };
+        unsigned char lead = byte(i);
+        if (lead < 0x80) return 1;
+        if (lead >= 0xC2 && lead <= 0xDF) return inRange(i + 1, 0x80, 0xBF) ? 2 : 0;
+        if (lead >= 0xE0 && lead <= 0xEF) {
+            unsigned char lo = lead == 0xE0 ? 0xA0 : 0x80;
+            unsigned char hi = lead == 0xED ? 0x9F : 0xBF;
+            return inRange(i + 1, lo, hi) && inRange(i + 2, 0x80, 0xBF) ? 3 : 0;
+        }
+        if (lead >= 0xF0 && lead <= 0xF4) {
+            unsigned char lo = lead == 0xF0 ? 0x90 : 0x80;
+            unsigned char hi = lead == 0xF4 ? 0x8F : 0xBF;
+            return inRange(i + 1, lo, hi) && inRange(i + 2, 0x80, 0xBF) && inRange(i + 3, 0x80, 0xBF) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    // Appends 's' as a JSON string literal, escaped as json::dump() does
+    void appendQuoted(std::string& out, const std::string& s) {
+        static const char HEX[] = "0123456789abcdef";
+        out += '"';
+        for (size_t i = 0; i < s.size(); ) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        out += "\\u00";
+                        out += HEX[c >> 4];
+                        out += HEX[c & 0xF];
+                    } else {
+                        size_t length = utf8Length(s, i);
+                        if (length == 0) throw std::runtime_error("invalid UTF-8 in \"" + s + "\"");
+                        out.append(s, i, length);
+                        i += length;
+                        continue;
+                    }
+            }
+            ++i;
+        }
+        out += '"';
+    }
+
+    // SAX events of playlists.json. Anything the layout does not expect is skipped
+    // whole, so a stray key or value cannot derail the rest of the file.
+    class PlaylistSax : public nlohmann::json_sax<json> {
+    public:
+        PlaylistSax(const std::string& sourceName, const PlaylistFile::ResolveTrack& resolveTrack,
+                    const PlaylistFile::OnPlaylist& onPlaylist, uint64_t& journal)
+            : sourceName(sourceName), resolveTrack(resolveTrack), onPlaylist(onPlaylist), journal(journal) {}
+
+        std::string error;
+
+        bool null() override { return scalar(); }
+        bool boolean(bool) override { return scalar(); }
+        bool number_integer(number_integer_t) override { return scalar(); }
+        bool number_float(number_float_t, const string_t&) override { return scalar(); }
+        bool binary(binary_t&) override { return scalar(); }
+
+        bool number_unsigned(number_unsigned_t value) override {
+            if (top() == Context::TOP_OBJECT && pendingKey == Key::JOURNAL) journal = value;
+            return scalar();
+        }
+
+        bool string(string_t& value) override {
+            if (top() == Context::PLAYLIST && pendingKey == Key::NAME) {
+                name = std::move(value);
+                hasName = true;
+                pendingKey = Key::NONE;
+                return true;
+            } else if (top() == Context::TRACKS) {
+                MediaFile* file = resolveTrack(value);
+                if (file) tracks.push_back(file);
+                else missing.push_back(std::move(value));
+                return true;
+            }
+            return scalar();
+        }
+
+        bool key(string_t& value) override {
+            if (top() == Context::TOP_OBJECT) {
+                pendingKey = value == "journal" ? Key::JOURNAL : value == "playlists" ? Key::PLAYLISTS : Key::OTHER;
+            } else if (top() == Context::PLAYLIST) {
+                pendingKey = value == "name" ? Key::NAME : value == "tracks" ? Key::TRACKS : Key::OTHER;
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) override { return start(true); }
+        bool start_array(std::size_t) override { return start(false); }
+        bool end_object() override { return end(); }
+        bool end_array() override { return end(); }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+            error = ex.what();
+            return false;
+        }
+
+        bool sawPlaylists = false;
+
+    private:
+        enum class Context { NONE, TOP_OBJECT, PLAYLISTS, PLAYLIST, TRACKS, SKIP };
+        enum class Key { NONE, JOURNAL, PLAYLISTS, NAME, TRACKS, OTHER };
+
+        Context top() const { return stack.empty() ? Context::NONE : stack.back(); }
+
+        bool scalar() {
+            Context context = top();
+            if (context == Context::PLAYLISTS) {
+                warnPlaylist();
+            } else if (context == Context::PLAYLIST && (pendingKey == Key::NAME || pendingKey == Key::TRACKS)) {
+                malformed = true;
+            } else if (context == Context::TRACKS) {
+                warnTrack();
+            }
+            pendingKey = Key::NONE;
+            return true;
+        }
+
+        bool start(bool isObject) {
+            Context context = top();
+            Context next = Context::SKIP;
+            if (context == Context::NONE) {
+                next = isObject ? Context::TOP_OBJECT : Context::PLAYLISTS; // A bare array is the old layout
+            } else if (context == Context::TOP_OBJECT && pendingKey == Key::PLAYLISTS && !isObject) {
+                next = Context::PLAYLISTS;
+            } else if (context == Context::PLAYLISTS) {
+                if (isObject) {
+                    next = Context::PLAYLIST;
+                    name.clear();
+                    tracks.clear();
+                    missing.clear();
+                    hasName = hasTracks = malformed = false;
+                } else {
+                    warnPlaylist();
+                }
+            } else if (context == Context::PLAYLIST) {
+                if (pendingKey == Key::TRACKS && !isObject) {
+                    next = Context::TRACKS;
+                    hasTracks = true;
+                } else if (pendingKey == Key::NAME || pendingKey == Key::TRACKS) {
+                    malformed = true;
+                }
+            } else if (context == Context::TRACKS) {
+                warnTrack();
+            }
+            if (next == Context::PLAYLISTS) sawPlaylists = true;
+            stack.push_back(next);
+            pendingKey = Key::NONE;
+            return true;
+        }
+
+        bool end() {
+            Context context = top();
+            stack.pop_back();
+            if (context == Context::PLAYLIST) {
+                if (hasName && hasTracks && !malformed)
+                    onPlaylist(name, tracks, missing);
+                else
+                    warnPlaylist();
+            }
+            return true;
+        }
+
+        void warnPlaylist() const {
+            std::cerr << "PlaylistManager Warning: Skipping invalid or incomplete playlist object in " << sourceName << "." << std::endl;
+        }
+
+        void warnTrack() const {
+            std::cerr << "PlaylistManager Warning: Invalid track path type in playlist '" << name << "', skipping." << std::endl;
+        }
+
+        const std::string& sourceName;
+        const PlaylistFile::ResolveTrack& resolveTrack;
+        const PlaylistFile::OnPlaylist& onPlaylist;
+        uint64_t& journal;
+
+        std::vector<Context> stack;
+        Key pendingKey = Key::NONE;
+        // The playlist being read
+        std::string name;
+        std::vector<MediaFile*> tracks;
+        std::vector<std::string> missing;
+        bool hasName = false;
+        bool hasTracks = false;
+        bool malformed = false;
+    };
+
+    const char BINARY_MAGIC[4] = { '\x89', 'M', 'P', 'L' };
+    const uint8_t BINARY_VERSION = 1;
+    const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    const uint64_t MAX_STRING = 1 << 20; // Longer names or paths mean a damaged file
+    const size_t CHUNK = 64 * 1024;
+
+    // Buffered output that hashes what it writes
+    class BinaryOut {
+    public:
+        explicit BinaryOut(std::ostream& out) : out(out) { buffer.reserve(CHUNK + 64); }
+
+        void bytes(const char* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= FNV_PRIME;
+            }
+            buffer.append(data, size);
+            if (buffer.size() >= CHUNK) drain();
+        }
+
+        void varint(uint64_t value) {
+            char encoded[10];
+            size_t length = 0;
+            do {
+                encoded[length++] = static_cast<char>((value & 0x7F) | (value >= 0x80 ? 0x80 : 0));
+                value >>= 7;
+            } while (value != 0);
+            bytes(encoded, length);
+        }
+
+        void string(std::string_view value) {
+            varint(value.size());
+            bytes(value.data(), value.size());
+        }
+
+        void finish() { // The hash itself is not hashed
+            for (int i = 0; i < 8; ++i) buffer += static_cast<char>((hash >> (8 * i)) & 0xFF);
+            drain();
+        }
+
+    private:
+        void drain() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+
+        std::ostream& out;
+        std::string buffer;
+        uint64_t hash = FNV_OFFSET;
+    };
+
+    // Buffered input that hashes what it reads. Every call fails once the data runs out.
+    class BinaryIn {
+    public:
+        explicit BinaryIn(std::istream& in) : in(in), buffer(CHUNK) {}
+
+        bool bytes(char* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                if (pos == end && !refill()) return false;
+                data[i] = buffer[pos++];
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= FNV_PRIME;
+            }
+            return true;
+        }
+
+        bool varint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                char byte;
+                if (!bytes(&byte, 1)) return false;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false; // Longer than any 64-bit value
+        }
+
+        // Appends 'size' bytes to 'value'
+        bool append(std::string& value, uint64_t size) {
+            if (size > MAX_STRING) return false;
+            size_t start = value.size();
+            value.resize(start + size);
+            return bytes(&value[start], size);
+        }
+
+        bool checkHash() {
+            uint64_t expected = hash;
+            char stored[8];
+            if (!bytes(stored, 8)) return false;
+            uint64_t found = 0;
+            for (int i = 0; i < 8; ++i) found |= static_cast<uint64_t>(static_cast<unsigned char>(stored[i])) << (8 * i);
+            return found == expected;
+        }
+
+    private:
+        bool refill() {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            end = static_cast<size_t>(in.gcount());
+            pos = 0;
+            return end > 0;
+        }
+
+        std::istream& in;
+        std::vector<char> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        uint64_t hash = FNV_OFFSET;
+    };
+
+    void writeJson(std::ostream& out, const PlaylistFile::Snapshot& snapshot) {
+        // Built up a piece at a time and handed to the stream in chunks
+        std::string buffer;
+        buffer.reserve(CHUNK + 4096);
+        auto drain = [&out, &buffer](bool force) {
+            if (force || buffer.size() >= CHUNK) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        };
+
+        size_t playlistCount = snapshot.playlistCount();
+        buffer += "{\n    \"journal\": " + std::to_string(snapshot.journal) + ",\n    \"playlists\": ";
+        buffer += playlistCount == 0 ? "[]" : "[\n";
+        std::string path;
+        for (size_t p = 0; p < playlistCount; ++p) {
+            size_t trackCount = snapshot.trackCount(p);
+            buffer += "        {\n            \"name\": ";
+            appendQuoted(buffer, snapshot.playlistName(p));
+            buffer += ",\n            \"tracks\": ";
+            buffer += trackCount == 0 ? "[]" : "[\n";
+            for (size_t t = 0; t < trackCount; ++t) {
+                path.assign(snapshot.track(p, t));
+                buffer += "                ";
+                appendQuoted(buffer, path);
+                buffer += t + 1 < trackCount ? ",\n" : "\n";
+                drain(false);
+            }
+            if (trackCount > 0) buffer += "            ]";
+            buffer += p + 1 < playlistCount ? "\n        },\n" : "\n        }\n";
+        }
+        if (playlistCount > 0) buffer += "    ]";
+        buffer += "\n}";
+        drain(true);
+    }
+
+    void writeBinary(std::ostream& out, const PlaylistFile::Snapshot& snapshot) {
+        // Path table in order of first use, and each track as an index into it
+        std::unordered_map<std::string_view, uint32_t> indexOf;
+        std::vector<std::string_view> paths;
+        std::vector<uint32_t> trackIndices;
+        size_t trackCount = 0;
+        for (size_t p = 0; p < snapshot.playlistCount(); ++p) trackCount += snapshot.trackCount(p);
+        indexOf.reserve(trackCount);
+        trackIndices.reserve(trackCount);
+        for (size_t p = 0; p < snapshot.playlistCount(); ++p) {
+            for (size_t t = 0; t < snapshot.trackCount(p); ++t) {
+                auto [it, added] = indexOf.emplace(snapshot.track(p, t), static_cast<uint32_t>(paths.size()));
+                if (added) paths.push_back(it->first);
+                trackIndices.push_back(it->second);
+            }
+        }
+
+        BinaryOut binary(out);
+        binary.bytes(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        binary.bytes(reinterpret_cast<const char*>(&BINARY_VERSION), 1);
+        binary.varint(snapshot.journal);
+        binary.varint(paths.size());
+        std::string_view previous;
+        for (std::string_view path : paths) {
+            size_t shared = 0;
+            while (shared < previous.size() && shared < path.size() && previous[shared] == path[shared]) ++shared;
+            binary.varint(shared);
+            binary.string(path.substr(shared));
+            previous = path;
+        }
+        binary.varint(snapshot.playlistCount());
+        size_t next = 0;
+        for (size_t p = 0; p < snapshot.playlistCount(); ++p) {
+            binary.string(snapshot.playlistName(p));
+            binary.varint(snapshot.trackCount(p));
+            for (size_t t = 0; t < snapshot.trackCount(p); ++t) binary.varint(trackIndices[next++]);
+        }
+        binary.finish();
+    }
+
+    bool readBinary(std::istream& in, const PlaylistFile::ResolveTrack& resolveTrack,
+                    const PlaylistFile::OnPlaylist& onPlaylist, uint64_t& journal, std::string& error) {
+        BinaryIn binary(in);
+        char magic[sizeof(BINARY_MAGIC)];
+        char version = 0;
+        if (!binary.bytes(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0
+            || !binary.bytes(&version, 1)) {
+            error = "not a playlist file";
+            return false;
+        }
+        if (static_cast<uint8_t>(version) != BINARY_VERSION) {
+            error = "unsupported binary version " + std::to_string(static_cast<uint8_t>(version));
+            return false;
+        }
+        error = "damaged or cut short";
+
+        uint64_t pathCount = 0;
+        if (!binary.varint(journal) || !binary.varint(pathCount)) return false;
+        // Each path is resolved once; the playlists then only pick from the table
+        std::vector<MediaFile*> resolved;
+        std::unordered_map<uint64_t, std::string> unresolved; // By table index
+        resolved.reserve(static_cast<size_t>(std::min<uint64_t>(pathCount, 1 << 20)));
+        std::string path;
+        for (uint64_t i = 0; i < pathCount; ++i) {
+            uint64_t shared = 0, suffix = 0;
+            if (!binary.varint(shared) || shared > path.size() || !binary.varint(suffix)) return false;
+            path.resize(static_cast<size_t>(shared));
+            if (!binary.append(path, suffix)) return false;
+            resolved.push_back(resolveTrack(path));
+            if (!resolved.back()) unresolved.emplace(i, path);
+        }
+
+        uint64_t playlistCount = 0;
+        if (!binary.varint(playlistCount)) return false;
+        std::string name;
+        std::vector<MediaFile*> tracks;
+        std::vector<std::string> missing;
+        for (uint64_t p = 0; p < playlistCount; ++p) {
+            uint64_t nameLength = 0, trackCount = 0;
+            name.clear();
+            tracks.clear();
+            missing.clear();
+            if (!binary.varint(nameLength) || !binary.append(name, nameLength) || !binary.varint(trackCount)) return false;
+            for (uint64_t t = 0; t < trackCount; ++t) {
+                uint64_t index = 0;
+                if (!binary.varint(index) || index >= resolved.size()) return false;
+                if (resolved[index]) tracks.push_back(resolved[index]);
+                else missing.push_back(unresolved[index]);
+            }
+            onPlaylist(name, tracks, missing);
+        }
+        if (!binary.checkHash()) return false;
+        error.clear();
+        return true;
+    }
+}
+
+void PlaylistFile::Snapshot::reserve(size_t tracks, size_t pathBytes) {
+    trackEnds.reserve(tracks);
+    pathData.reserve(pathBytes);
+}
+
+void PlaylistFile::Snapshot::addPlaylist(const std::string& name) {
+    playlists.push_back({ name, trackEnds.size(), 0 });
+}
+
+void PlaylistFile::Snapshot::addTrack(const std::string& path) {
+    if (playlists.empty()) return;
+    pathData += path;
+    trackEnds.push_back(pathData.size());
+    ++playlists.back().trackCount;
+}
+
+std::string_view PlaylistFile::Snapshot::track(size_t playlist, size_t index) const {
+    size_t at = playlists[playlist].firstTrack + index;
+    size_t begin = at == 0 ? 0 : trackEnds[at - 1];
+    return std::string_view(pathData).substr(begin, trackEnds[at] - begin);
+}
+
+void PlaylistFile::write(std::ostream& out, const Snapshot& snapshot, Format format) {
+    if (format == Format::BINARY)
+        writeBinary(out, snapshot);
+    else
+        writeJson(out, snapshot);
+}
+
+bool PlaylistFile::read(std::istream& in, const std::string& sourceName, const ResolveTrack& resolveTrack,
+                        const OnPlaylist& onPlaylist, uint64_t& journal, Format& format, std::string& error) {
+    journal = 0;
+    // No JSON text starts with this byte (it is not valid UTF-8 on its own)
+    if (in.peek() == static_cast<unsigned char>(BINARY_MAGIC[0])) {
+        format = Format::BINARY;
+        return readBinary(in, resolveTrack, onPlaylist, journal, error);
+    }
+
+    format = Format::JSON;
+    PlaylistSax sax(sourceName, resolveTrack, onPlaylist, journal);
+    if (!json::sax_parse(in, &sax)) {
+        error = sax.error.empty() ? "parse error" : sax.error;
+        return false;
+    }
+    if (!sax.sawPlaylists) {
+        std::cerr << "PlaylistManager Error: Invalid playlist file format in " << sourceName << ". Expected a JSON array." << std::endl;
+    }
+    return true;
+}
+
+const char* PlaylistFile::getFormatName(Format format) {
+    return format == Format::BINARY ? "binary" : "JSON";
+}
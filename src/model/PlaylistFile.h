@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+class MediaFile;
+
+// The playlist file, read and written without building a document in memory. Two
+// encodings, told apart on load by the first bytes:
+//
+// JSON, the same layout as json::dump(4):
+//   { "journal": <last journal entry included>,
+//     "playlists": [ { "name": "...", "tracks": [ "/full/path", ... ] }, ... ] }
+//   A bare array of playlists (files from before the journal) reads as journal 0.
+//   Read through nlohmann's SAX parser, resolving each track as it comes in.
+//
+// BINARY, every integer an unsigned LEB128 varint:
+//   "\x89MPL", version byte, journal,
+//   path count, then per path: bytes shared with the previous path, suffix length, suffix
+//   playlist count, then per playlist: name length, name, track count, path indices
+//   FNV-1a 64 of everything before it (8 bytes, little-endian)
+//   Each path is stored once however many playlists hold it, front-coded against the
+//   one before (paths in one album differ only in the file name), and resolved once.
+namespace PlaylistFile {
+    enum class Format { JSON, BINARY };
+
+    // What to write, copied from the playlists on the UI thread. Every path shares one
+    // buffer, so copying a large library's playlists costs a few allocations.
+    class Snapshot {
+    public:
+        uint64_t journal = 0;
+
+        void reserve(size_t tracks, size_t pathBytes); // Optional; saves regrowing the buffers
+        void addPlaylist(const std::string& name);
+        void addTrack(const std::string& path); // To the playlist added last
+
+        size_t playlistCount() const { return playlists.size(); }
+        const std::string& playlistName(size_t playlist) const { return playlists[playlist].name; }
+        size_t trackCount(size_t playlist) const { return playlists[playlist].trackCount; }
+        std::string_view track(size_t playlist, size_t index) const;
+
+    private:
+        struct Entry {
+            std::string name;
+            size_t firstTrack; // Index into trackEnds
+            size_t trackCount;
+        };
+        std::vector<Entry> playlists;
+        std::string pathData;
+        std::vector<size_t> trackEnds; // End of each path in pathData
+    };
+
+    // For JSON, throws std::runtime_error on a name or path that is not valid UTF-8,
+    // like json::dump() did: the file would not load again. BINARY takes any bytes.
+    void write(std::ostream& out, const Snapshot& snapshot, Format format = Format::JSON);
+
+    using ResolveTrack = std::function<MediaFile*(const std::string& path)>; // nullptr: not in any library
+    // 'missing': the paths 'resolveTrack' found nothing for, in file order
+    using OnPlaylist = std::function<void(const std::string& name, const std::vector<MediaFile*>& tracks,
+                                          const std::vector<std::string>& missing)>;
+
+    // Calls 'onPlaylist' for each well-formed playlist, in file order; malformed ones
+    // are skipped with a warning naming 'sourceName'. Either format; 'format' is set to
+    // the one found. False (with 'error' set) if the file is not valid JSON, or a binary
+    // file is damaged or cut short; what was read before the error has been passed on.
+    bool read(std::istream& in, const std::string& sourceName, const ResolveTrack& resolveTrack,
+              const OnPlaylist& onPlaylist, uint64_t& journal, Format& format, std::string& error);
+
+    const char* getFormatName(Format format);
+}
@@ -1,22 +1,75 @@
 #include "model/PlaylistManager.h"
 #include "model/MediaManager.h"
+#include "model/PlaylistFile.h"
+#include "model/PlaylistExchange.h"
+#include "utils/FileUtils.h"
 #include <algorithm> 
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
 #include "nlohmann/json.hpp"
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
 //Constructor 
-PlaylistManager::PlaylistManager(MediaManager* manager) : mediaManager(manager) {
+PlaylistManager::PlaylistManager(MediaManager* manager)
+    : mediaManager(manager), usbMediaManager(nullptr), loaded_(false),
+      dirty_(false), saveDelay_(500), changeCount_(0), format_(PlaylistFile::Format::JSON),
+      journalFd_(-1), journalSeq_(0), submittedSeq_(0), writtenSeq_(0),
+      journalEmpty_(true), journalEntries_(0), journalBytes_(0) {
     if (mediaManager == nullptr) {
          std::cerr << "CRITICAL: PlaylistManager initialized with null MediaManager!" << std::endl;
     }
 }
 
+PlaylistManager::~PlaylistManager() {
+    flushAutoSave();
+    closeJournal();
+    SaveStats stats = getSaveStats();
+    if (stats.changes > 0) {
+        std::cout << "PlaylistManager: " << stats.changes << " changes saved in " << stats.writes
+                  << " writes (" << stats.bytesWritten << " bytes) and " << stats.journalEntries
+                  << " journal entries (" << stats.journalBytes << " bytes)" << std::endl;
+    }
+}
+
 Playlist* PlaylistManager::createPlaylist(const std::string& name) {
+    Playlist* playlist = insertPlaylist(name);
+    if (playlist) appendJournal("create", name);
+    return playlist;
+}
+
+bool PlaylistManager::deletePlaylist(const std::string& name) {
+    if (!erasePlaylist(name)) return false;
+    appendJournal("delete", name);
+    return true;
+}
+
+bool PlaylistManager::addTrack(Playlist* playlist, MediaFile* file) {
+    if (playlist == nullptr || file == nullptr || playlist->containsTrack(file)) return false;
+    playlist->addTrack(file);
+    appendJournal("add", playlist->getName(), file->getFilePath());
+    return true;
+}
+
+bool PlaylistManager::removeTrack(Playlist* playlist, MediaFile* file) {
+    if (playlist == nullptr || !playlist->removeTrack(file)) return false;
+    appendJournal("remove", playlist->getName(), file->getFilePath());
+    return true;
+}
+
+bool PlaylistManager::moveTrack(Playlist* playlist, size_t from, size_t to) {
+    if (playlist == nullptr || !playlist->moveTrack(from, to)) return false;
+    // By path: replay finds the track wherever the tracks missing at load left it
+    appendJournal("move", playlist->getName(), playlist->getTracks()[to]->getFilePath(), to);
+    return true;
+}
+
+Playlist* PlaylistManager::insertPlaylist(const std::string& name) {
     if (getPlaylistByName(name) != nullptr) {
         std::cerr << "PlaylistManager: Playlist with name '" << name << "' already exists." << std::endl;
         return nullptr;
@@ -31,7 +84,7 @@ Playlist* PlaylistManager::createPlaylist(const std::string& name) {
     return ptr;
 }
 
-bool PlaylistManager::deletePlaylist(const std::string& name) {
+bool PlaylistManager::erasePlaylist(const std::string& name) {
     auto it = std::remove_if(playlists.begin(), playlists.end(), 
         [&name](const std::unique_ptr<Playlist>& p) {
             return p->getName() == name;
@@ -70,7 +123,7 @@ std::vector<Playlist*> PlaylistManager::getAllPlaylists() {
 }
 
 
-void PlaylistManager::saveToFile(const std::string& filename) {
+bool PlaylistManager::saveToFile(const std::string& filename) {
     std::string path_to_save = filename;
     if (path_to_save.empty()) {
         path_to_save = savePath_; 
@@ -78,125 +131,409 @@ void PlaylistManager::saveToFile(const std::string& filename) {
 
     if (path_to_save.empty()) {
         std::cerr << "PlaylistManager Error: No save path specified. Cannot save." << std::endl;
-        return;
+        return false;
     }
-    
-    json jsonData = json::array(); 
 
+    size_t failed = writer_.getStats().failed;
+    submitSave(path_to_save);
+    writer_.flush(); // Also orders it after any auto-save still being written
+    if (writer_.getStats().failed != failed) {
+        std::cerr << "PlaylistManager Error: Could not save playlists to " << path_to_save << std::endl;
+        return false;
+    }
+    std::cout << "PlaylistManager: Playlists saved to " << path_to_save << std::endl;
+    return true;
+}
+
+// Collects the playlists here (they belong to the UI thread) and leaves writing them
+// out to the writer thread
+void PlaylistManager::submitSave(const std::string& path) {
+    PlaylistFile::Snapshot snapshot;
+    size_t trackCount = 0, pathBytes = 0;
+    for (const auto& playlistPtr : playlists) {
+        if (!playlistPtr) continue;
+        trackCount += playlistPtr->getTracks().size() + playlistPtr->getMissingTracks().size();
+        for (const MediaFile* trackPtr : playlistPtr->getTracks()) {
+            if (trackPtr) pathBytes += trackPtr->getFilePath().size();
+        }
+        for (const std::string& missing : playlistPtr->getMissingTracks()) pathBytes += missing.size();
+    }
+    snapshot.reserve(trackCount, pathBytes);
     for (const auto& playlistPtr : playlists) {
         if (!playlistPtr) continue; 
-
-        json playlistObj; // JSON object for this playlist
-        playlistObj["name"] = playlistPtr->getName();
-
-        json tracksArray = json::array(); 
+        snapshot.addPlaylist(playlistPtr->getName());
         for (const MediaFile* trackPtr : playlistPtr->getTracks()) {
-            if (trackPtr) { 
-                tracksArray.push_back(trackPtr->getFilePath()); // Store the full path
-            }
+            if (trackPtr) snapshot.addTrack(trackPtr->getFilePath()); // Store the full path
         }
-        playlistObj["tracks"] = tracksArray;
-
-        jsonData.push_back(playlistObj); // Add playlist object to root array
+        for (const std::string& missing : playlistPtr->getMissingTracks()) snapshot.addTrack(missing);
     }
 
-    try {
-        fs::path p(path_to_save);
-        if (p.has_parent_path()) {
-            fs::create_directories(p.parent_path()); 
-        }
+    // Our own file records how much of the journal it includes; a copy elsewhere has none to replay
+    bool own = path == savePath_;
+    uint64_t seq = own ? journalSeq_ : 0;
+    snapshot.journal = seq;
 
-        std::ofstream outFile(path_to_save);
-        if (outFile.is_open()) {
-            outFile << jsonData.dump(4);
-            outFile.close();
-            std::cout << "PlaylistManager: Playlists saved to " << path_to_save << std::endl;
-        } else {
-            std::cerr << "PlaylistManager Error: Could not open file for saving: " << path_to_save << std::endl;
-        }
-    } catch (fs::filesystem_error& e) {
-         std::cerr << "PlaylistManager Error: Filesystem error: " << e.what() << std::endl;
-    } catch (const json::exception& e) {
-         std::cerr << "PlaylistManager Error: Failed to serialize JSON: " << e.what() << std::endl;
+    std::function<void(bool)> onWritten;
+    if (own) {
+        dirty_ = false;
+        submittedSeq_ = seq;
+        onWritten = [this, seq](bool ok) { if (ok) writtenSeq_ = seq; };
     }
+    writer_.submit(path, [snapshot = std::move(snapshot), format = format_](std::ostream& out) {
+                       PlaylistFile::write(out, snapshot, format);
+                   },
+                   std::move(onWritten));
 }
-void PlaylistManager::loadFromFile(const std::string& filename) {
+
+bool PlaylistManager::loadFromFile(const std::string& filename) {
     if (mediaManager == nullptr) {
         std::cerr << "PlaylistManager Error: Cannot load playlists - MediaManager is null." << std::endl;
-        return;
+        return false;
     }
+    flushAutoSave(); // Edits not written yet would be lost, or the file read before they land
+    closeJournal();
     savePath_ = filename;
-    std::ifstream inFile(filename);
+    loaded_ = true;
+
+    uint64_t snapshotSeq = 0;
+    bool haveSnapshot = false;
+    std::ifstream inFile(filename, std::ios::binary);
     if (!inFile.is_open()) {
         std::cout << "PlaylistManager Info: Playlist file not found or could not be opened: " << filename << ". Starting fresh." << std::endl;
-        return;
+    } else {
+        // Streamed: each track is resolved as it is read, and only the playlists are kept.
+        // They replace the current ones only once the whole file has parsed.
+        std::vector<std::unique_ptr<Playlist>> loadedPlaylists;
+        auto resolve = [this](const std::string& trackPath) {
+            MediaFile* file = resolveTrack(trackPath);
+            if (!file)
+                std::cerr << "PlaylistManager Warning: Track not found in any library (kept in the file): " << trackPath << std::endl;
+            return file;
+        };
+        auto add = [&loadedPlaylists](const std::string& name, const std::vector<MediaFile*>& tracks,
+                                      const std::vector<std::string>& missing) {
+            bool duplicate = std::any_of(loadedPlaylists.begin(), loadedPlaylists.end(),
+                [&name](const std::unique_ptr<Playlist>& p) { return p->getName() == name; });
+            if (duplicate) {
+                std::cerr << "PlaylistManager Warning: Could not create playlist '" << name << "' during load (maybe duplicate name?)." << std::endl;
+                return;
+            }
+            loadedPlaylists.push_back(std::make_unique<Playlist>(name));
+            loadedPlaylists.back()->setTracks(tracks);
+            loadedPlaylists.back()->setMissingTracks(missing);
+        };
+
+        std::string error;
+        PlaylistFile::Format found = format_;
+        if (PlaylistFile::read(inFile, filename, resolve, add, snapshotSeq, found, error)) {
+            playlists = std::move(loadedPlaylists);
+            haveSnapshot = true;
+            std::cout << "PlaylistManager: Playlists loaded successfully from " << filename << std::endl;
+            if (found != format_) {
+                std::cout << "PlaylistManager: " << filename << " is in " << PlaylistFile::getFormatName(found)
+                          << "; it will be rewritten in " << PlaylistFile::getFormatName(format_) << "." << std::endl;
+                dirty_ = true; // Not autoSave(): that would count as a change
+                lastChange_ = firstChange_ = Clock::now();
+            }
+        } else {
+            std::cerr << "PlaylistManager Error: Failed to parse " << PlaylistFile::getFormatName(found)
+                      << " playlist file " << filename << ": " << error << std::endl;
+            snapshotSeq = 0;
+        }
     }
 
+    journalSeq_ = submittedSeq_ = snapshotSeq;
+    writtenSeq_ = snapshotSeq;
+    replayJournal(snapshotSeq, !haveSnapshot);
+    openJournal();
+    return haveSnapshot || !inFile.is_open();
+}
+
+bool PlaylistManager::migrateFile(const std::string& from, const std::string& to) {
+    if (!loadFromFile(from)) return false; // Keep a file we could not read
+    closeJournal();
+    savePath_ = to;
+    std::error_code ec;
+    fs::remove(to + ".journal", ec); // Left over from an earlier file there; none of it applies
+
+    if (!saveToFile(to)) { // Records the journal so far as included: the new journal starts after it
+        std::cerr << "PlaylistManager Error: Still using " << from << std::endl;
+        savePath_ = from;
+        openJournal();
+        return false;
+    }
+    openJournal();
+    fs::remove(from, ec);
+    fs::remove(from + ".journal", ec);
+    std::cout << "PlaylistManager: Moved the playlists from " << from << " to " << to << " ("
+              << PlaylistFile::getFormatName(format_) << ")" << std::endl;
+    return true;
+}
+
+void PlaylistManager::setFileFormat(PlaylistFile::Format format) {
+    format_ = format;
+}
+
+PlaylistFile::Format PlaylistManager::getFileFormat() const {
+    return format_;
+}
+
+Playlist* PlaylistManager::importPlaylist(const std::string& filePath, const std::string& name, size_t* missing) {
+    PlaylistExchange::Format format;
+    if (!PlaylistExchange::formatFromPath(filePath, format)) {
+        std::cerr << "PlaylistManager Error: Not an M3U, M3U8 or PLS file: " << filePath << std::endl;
+        return nullptr;
+    }
+    std::string playlistName = name.empty() ? fs::path(filePath).stem().string() : name;
+    if (getPlaylistByName(playlistName) != nullptr) {
+        std::cerr << "PlaylistManager: Playlist with name '" << playlistName << "' already exists." << std::endl;
+        return nullptr;
+    }
+    std::ifstream inFile(filePath, std::ios::binary);
+    if (!inFile.is_open()) {
+        std::cerr << "PlaylistManager Error: Could not open " << filePath << std::endl;
+        return nullptr;
+    }
+
+    // Each entry is one hash lookup in the libraries' path index
+    std::vector<MediaFile*> tracks;
+    size_t notFound = 0;
+    auto add = [this, &tracks, &notFound](const std::string& trackPath) {
+        MediaFile* file = resolveTrack(trackPath);
+        if (file) tracks.push_back(file);
+        else ++notFound;
+    };
+    std::string error;
+    std::string baseDir = fs::absolute(filePath).parent_path().string();
+    if (!PlaylistExchange::read(inFile, format, baseDir, add, error)) {
+        std::cerr << "PlaylistManager Error: Could not import " << filePath << ": " << error << std::endl;
+        return nullptr;
+    }
+
+    Playlist* playlist = insertPlaylist(playlistName);
+    playlist->setTracks(tracks);
+    // Too many tracks to journal one by one: one full write instead, started now so
+    // that edits journaled after this never replay over a file without the playlist
+    autoSave();
+    if (journalFd_ >= 0) submitSave(savePath_);
+    if (missing) *missing = notFound;
+    std::cout << "PlaylistManager: Imported " << playlist->getTracks().size() << " tracks from " << filePath
+              << " into '" << playlistName << "' (" << notFound << " not in the library)" << std::endl;
+    return playlist;
+}
+
+bool PlaylistManager::exportPlaylist(const Playlist* playlist, const std::string& filePath) {
+    PlaylistExchange::Format format;
+    if (playlist == nullptr || !PlaylistExchange::formatFromPath(filePath, format)) {
+        std::cerr << "PlaylistManager Error: Not an M3U, M3U8 or PLS file: " << filePath << std::endl;
+        return false;
+    }
+    std::string baseDir = fs::absolute(filePath).parent_path().string();
+    const std::vector<MediaFile*>& tracks = playlist->getTracks();
+    bool ok = FileUtils::writeFileAtomically(filePath, [&](std::ostream& out) {
+        PlaylistExchange::write(out, format, tracks, baseDir);
+    });
+    if (ok)
+        std::cout << "PlaylistManager: Exported '" << playlist->getName() << "' to " << filePath << std::endl;
+    else
+        std::cerr << "PlaylistManager Error: Could not write " << filePath << std::endl;
+    return ok;
+}
+
+MediaFile* PlaylistManager::resolveTrack(const std::string& path) const {
+    MediaFile* file = nullptr;
+    if (mediaManager)
+        file = mediaManager->findFileByPath(path);
+    if (!file && usbMediaManager)
+        file = usbMediaManager->findFileByPath(path);
+    return file;
+}
+
+// --- Journal ---
+
+void PlaylistManager::appendJournal(const std::string& op, const std::string& playlist, const std::string& track, size_t to) {
+    if (journalFd_ < 0) {
+        if (loaded_) autoSave(); // No journal to record it in: a full save will
+        return;
+    }
+    std::string line;
     try {
-        json jsonData = json::parse(inFile);
-        inFile.close(); // Close file after parsing
+        json entry = { {"seq", journalSeq_ + 1}, {"op", op}, {"playlist", playlist} };
+        if (!track.empty()) entry["track"] = track;
+        if (op == "move") entry["to"] = to;
+        line = entry.dump() + "\n";
+    } catch (const json::exception& e) {
+        std::cerr << "PlaylistManager Error: Could not journal '" << op << "': " << e.what() << std::endl;
+        autoSave();
+        return;
+    }
+    // One append per entry: a crash can only cut the last line short, and loading drops that
+    if (write(journalFd_, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+        std::cerr << "PlaylistManager Error: Could not append to the playlist journal." << std::endl;
+        autoSave();
+        return;
+    }
+    ++journalSeq_;
+    journalEmpty_ = false;
+    ++journalEntries_;
+    journalBytes_ += line.size();
+    ++changeCount_;
+}
 
-        playlists.clear();
+void PlaylistManager::openJournal() {
+    if (savePath_.empty() || journalFd_ >= 0) return;
+    std::error_code ec;
+    fs::path p(savePath_);
+    if (p.has_parent_path()) fs::create_directories(p.parent_path(), ec);
+    std::string journalPath = savePath_ + ".journal";
+    journalFd_ = open(journalPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journalFd_ < 0)
+        std::cerr << "PlaylistManager Error: Could not open " << journalPath << "; edits are saved in full instead." << std::endl;
+}
 
-        if (!jsonData.is_array()) {
-            std::cerr << "PlaylistManager Error: Invalid playlist file format in " << filename << ". Expected a JSON array." << std::endl;
-            return;
-        }
+void PlaylistManager::closeJournal() {
+    if (journalFd_ >= 0) close(journalFd_);
+    journalFd_ = -1;
+}
 
-        for (const auto& playlistObj : jsonData) {
-            if (!playlistObj.is_object() || !playlistObj.contains("name") || !playlistObj["name"].is_string() || !playlistObj.contains("tracks") || !playlistObj["tracks"].is_array()) {
-                 std::cerr << "PlaylistManager Warning: Skipping invalid or incomplete playlist object in " << filename << "." << std::endl;
-                 continue;
-            }
+void PlaylistManager::truncateJournalIfCovered() {
+    if (journalEmpty_ || journalFd_ < 0 || writtenSeq_ < journalSeq_) return;
+    if (ftruncate(journalFd_, 0) == 0) journalEmpty_ = true;
+}
 
-            std::string name = playlistObj["name"];
-            Playlist* newPlaylist = createPlaylist(name);
-
-            if (newPlaylist) {
-                for (const auto& trackPathJson : playlistObj["tracks"]) {
-                    if (trackPathJson.is_string()) 
-                    {
-                        std::string trackPath = trackPathJson;
-                        MediaFile* file = nullptr;
-
-                        if (mediaManager)
-                            file = mediaManager->findFileByPath(trackPath);
-
-                        if (!file && usbMediaManager)
-                            file = usbMediaManager->findFileByPath(trackPath);
-
-                        if (file)
-                            newPlaylist->addTrack(file);
-                        else
-                            std::cerr << "PlaylistManager Warning: Track not found in any library: "
-                                    << trackPath << std::endl;
-                    } 
-                    else 
-                    {
-                         std::cerr << "PlaylistManager Warning: Invalid track path type in playlist '" << name << "', skipping." << std::endl;
-                    }
-                }
-            } 
-            else 
-            {
-                 std::cerr << "PlaylistManager Warning: Could not create playlist '" << name << "' during load (maybe duplicate name?)." << std::endl;
+void PlaylistManager::replayJournal(uint64_t afterSeq, bool clearFirst) {
+    std::string journalPath = savePath_ + ".journal";
+    std::ifstream in(journalPath, std::ios::binary);
+    if (!in.is_open()) return;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    in.close();
+    std::string contents = buffer.str();
+
+    // A line cut short by a crash would swallow the next entry appended after it
+    size_t complete = contents.rfind('\n');
+    complete = complete == std::string::npos ? 0 : complete + 1;
+    if (complete < contents.size()) {
+        std::error_code ec;
+        fs::resize_file(journalPath, complete, ec);
+        contents.resize(complete);
+    }
+    if (contents.empty()) return;
+    journalEmpty_ = false;
+
+    size_t replayed = 0;
+    std::istringstream lines(contents);
+    for (std::string line; std::getline(lines, line); ) {
+        json entry = json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.is_object() || !entry.contains("seq") || !entry["seq"].is_number_unsigned()
+            || !entry.contains("op") || !entry["op"].is_string() || !entry.contains("playlist") || !entry["playlist"].is_string()) {
+            std::cerr << "PlaylistManager Warning: Skipping invalid playlist journal entry." << std::endl;
+            continue;
+        }
+        uint64_t seq = entry["seq"].get<uint64_t>();
+        if (seq <= afterSeq) continue; // Already in the snapshot
+        if (clearFirst) {
+            playlists.clear(); // The journal starts from no playlists at all
+            clearFirst = false;
+        }
+        journalSeq_ = std::max(journalSeq_, seq);
+        ++replayed;
+
+        const std::string op = entry["op"];
+        const std::string name = entry["playlist"];
+        if (op == "create") {
+            insertPlaylist(name);
+            continue;
+        }
+        if (op == "delete") {
+            erasePlaylist(name);
+            continue;
+        }
+        Playlist* playlist = getPlaylistByName(name);
+        std::string trackPath = entry.contains("track") && entry["track"].is_string() ? entry["track"].get<std::string>() : "";
+        if (!playlist || trackPath.empty()) continue;
+        const std::vector<MediaFile*>& tracks = playlist->getTracks();
+        auto position = std::find_if(tracks.begin(), tracks.end(),
+            [&trackPath](const MediaFile* file) { return file && file->getFilePath() == trackPath; });
+
+        if (op == "add") {
+            MediaFile* file = resolveTrack(trackPath);
+            if (file) {
+                playlist->addTrack(file);
+                playlist->removeMissingTrack(trackPath);
+            } else {
+                std::cerr << "PlaylistManager Warning: Track not found in any library (kept in the file): " << trackPath << std::endl;
+                playlist->addMissingTrack(trackPath);
+            }
+        } else if (op == "remove") {
+            if (position != tracks.end())
+                playlist->removeTrack(*position);
+            else
+                playlist->removeMissingTrack(trackPath);
+        } else if (op == "move") {
+            if (position != tracks.end() && entry.contains("to") && entry["to"].is_number_unsigned() && !tracks.empty()) {
+                size_t to = std::min<size_t>(entry["to"].get<size_t>(), tracks.size() - 1);
+                playlist->moveTrack(static_cast<size_t>(position - tracks.begin()), to);
             }
         }
-        std::cout << "PlaylistManager: Playlists loaded successfully from " << filename << std::endl;
-
-    } catch (json::parse_error& e) {
-        std::cerr << "PlaylistManager Error: Failed to parse playlist JSON file " << filename << ": " << e.what() << std::endl;
-        if(inFile.is_open()) inFile.close(); // Ensure file is closed on error
-    } catch (const std::exception& e) {
-         std::cerr << "PlaylistManager Error: An unexpected error occurred during playlist loading: " << e.what() << std::endl;
-         if(inFile.is_open()) inFile.close();
     }
+    if (replayed > 0)
+        std::cout << "PlaylistManager: Replayed " << replayed << " journal entries from " << journalPath << std::endl;
 }
 
 void PlaylistManager::autoSave() {
-    std::cout << "[DEBUG] PlaylistManager: Auto-saving changes..." << std::endl;
-    saveToFile(); 
+    Clock::time_point now = Clock::now();
+    if (!dirty_) firstChange_ = now;
+    lastChange_ = now;
+    dirty_ = true;
+    ++changeCount_;
 }
+
+bool PlaylistManager::saveIfDue() {
+    truncateJournalIfCovered();
+    if (savePath_.empty()) return false;
+    if (journalSeq_ - submittedSeq_ >= COMPACT_AFTER_ENTRIES) {
+        std::cout << "PlaylistManager: Compacting the playlist journal into " << savePath_ << std::endl;
+        submitSave(savePath_);
+        return true;
+    }
+    if (!dirty_) return false;
+    Clock::time_point now = Clock::now();
+    // A steady stream of changes (adding a whole album) still gets written every so often
+    if (now - lastChange_ < saveDelay_ && now - firstChange_ < saveDelay_ * 10) return false;
+    std::cout << "PlaylistManager: Auto-saving playlists to " << savePath_ << std::endl;
+    submitSave(savePath_);
+    return true;
+}
+
+void PlaylistManager::flushAutoSave() {
+    if (!savePath_.empty() && (dirty_ || journalSeq_ > submittedSeq_)) submitSave(savePath_);
+    writer_.flush();
+    truncateJournalIfCovered();
+}
+
+bool PlaylistManager::hasUnsavedChanges() const {
+    return dirty_;
+}
+
+void PlaylistManager::setSaveDelay(std::chrono::milliseconds delay) {
+    saveDelay_ = delay;
+}
+
+PlaylistManager::SaveStats PlaylistManager::getSaveStats() const {
+    BackgroundFileWriter::Stats written = writer_.getStats();
+    SaveStats stats;
+    stats.changes = changeCount_;
+    stats.writes = written.written;
+    stats.bytesWritten = written.bytesWritten;
+    stats.journalEntries = journalEntries_;
+    stats.journalBytes = journalBytes_;
+    return stats;
+}
+bool PlaylistManager::isLoaded() const {
+    return loaded_;
+}
+
 void PlaylistManager::setUSBMediaManager(MediaManager* usbManager) {
     usbMediaManager = usbManager;
 }
@@ -221,7 +558,20 @@ void PlaylistManager::removeTracksFromPathPrefix(const std::string& pathPrefix)
             }
         }
 
-        const_cast<std::vector<MediaFile*>&>(playlistPtr->getTracks()) = cleanedTracks;
+        playlistPtr->setTracks(cleanedTracks);
     }
 }
 
+
+
+bool PlaylistManager::removeTrackFromAll(MediaFile* file) {
+    if (file == nullptr) return false;
+
+    bool changed = false;
+    for (auto& playlistPtr : playlists) {
+        if (playlistPtr && playlistPtr->removeTrack(file)) {
+            changed = true;
+        }
+    }
+    return changed;
+}
\ No newline at end of file
@@ -2,28 +2,116 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
 #include "Playlist.h"
+#include "utils/BackgroundFileWriter.h"
+#include "model/PlaylistFile.h"
 
 #include "model/MediaManager.h"
 class PlaylistManager {
+public:
+    // Write amplification: many changes should end up in few full writes
+    struct SaveStats {
+        size_t changes = 0;                  // Journaled edits plus autoSave() calls
+        size_t writes = 0;                   // Playlist files written, auto-saved or not
+        unsigned long long bytesWritten = 0;
+        size_t journalEntries = 0;
+        unsigned long long journalBytes = 0;
+    };
+
+    // Journal entries after which saveIfDue() writes a fresh snapshot
+    static constexpr uint64_t COMPACT_AFTER_ENTRIES = 1000;
+
 private:
     std::vector<std::unique_ptr<Playlist>> playlists;
     MediaManager* mediaManager;
     MediaManager* usbMediaManager;
     std::string savePath_;
+    bool loaded_;
+
+    // Auto-save state: changes are written once they have settled (see saveIfDue)
+    using Clock = std::chrono::steady_clock;
+    bool dirty_;
+    Clock::time_point firstChange_;
+    Clock::time_point lastChange_;
+    std::chrono::milliseconds saveDelay_;
+    size_t changeCount_;
+    PlaylistFile::Format format_; // Of the files written
+
+    // Journal: edits made through this class are appended to '<save path>.journal' as
+    // they happen, one JSON line each, and loadFromFile() replays them over the
+    // snapshot. A snapshot records the last entry it includes; the journal is emptied
+    // once a snapshot on disk covers all of it.
+    int journalFd_;
+    uint64_t journalSeq_;   // Last entry appended (or replayed)
+    uint64_t submittedSeq_; // Covered by the last snapshot handed to the writer
+    std::atomic<uint64_t> writtenSeq_; // ...and by the last one on disk; set by the writer thread
+    bool journalEmpty_;
+    size_t journalEntries_;
+    unsigned long long journalBytes_;
+
+    BackgroundFileWriter writer_; // Last: its callbacks use the members above
+
+    void submitSave(const std::string& path);
+    void appendJournal(const std::string& op, const std::string& playlist, const std::string& track = "", size_t to = 0);
+    void openJournal();
+    void closeJournal();
+    void truncateJournalIfCovered();
+    void replayJournal(uint64_t afterSeq, bool clearFirst);
+    // Edits without journaling, for loading and replay
+    Playlist* insertPlaylist(const std::string& name);
+    bool erasePlaylist(const std::string& name);
+    MediaFile* resolveTrack(const std::string& path) const;
 public:
     explicit PlaylistManager(MediaManager* manager);
+    ~PlaylistManager(); // Writes pending changes; the libraries must still be there
+    // Edits. Once loadFromFile() has run, each one is journaled.
     Playlist* createPlaylist(const std::string& name);
     Playlist* getPlaylistByName(const std::string& name);
     bool deletePlaylist(const std::string& name);
+    bool addTrack(Playlist* playlist, MediaFile* file); // False if it was there already
+    bool removeTrack(Playlist* playlist, MediaFile* file);
+    bool moveTrack(Playlist* playlist, size_t from, size_t to);
 
     std::vector<Playlist*> getAllPlaylists();
-    void saveToFile(const std::string& filename = "");
-    void loadFromFile(const std::string& filename);
+    bool saveToFile(const std::string& filename = ""); // Synchronous; false if the write failed
+    // Writes pending changes first. Reads either format. False if the file is there
+    // but could not be read (the playlists are then only what the journal holds).
+    bool loadFromFile(const std::string& filename);
+    // Loads 'from', writes it to 'to' in the current format and carries on there,
+    // removing 'from' and its journal. False (still on 'from') if either step failed.
+    bool migrateFile(const std::string& from, const std::string& to);
+    // Format of the files written from now on; a file loaded in the other one is
+    // rewritten in this one by the next save
+    void setFileFormat(PlaylistFile::Format format);
+    PlaylistFile::Format getFileFormat() const;
+    // Marks the playlists changed in a way the journal does not record (tracks dropped
+    // by the library watcher). They are written in the background once no change
+    // came for the save delay (or the changes have gone on for ten times that).
     void autoSave();
+    // Polled by the UI loop: starts that write, or a compaction of a long journal;
+    // true if it did
+    bool saveIfDue();
+    // Writes pending changes now, folding the journal into the snapshot, and waits
+    // for every write
+    void flushAutoSave();
+    bool hasUnsavedChanges() const;
+    void setSaveDelay(std::chrono::milliseconds delay);
+    SaveStats getSaveStats() const;
+    // M3U/M3U8/PLS, by the file's extension. Import creates playlist 'name' (the file
+    // name without extension if empty) from the entries found in either library;
+    // 'missing' counts the others. nullptr if the file could not be read or the name
+    // is taken. Export writes tracks under the file's directory as relative paths.
+    Playlist* importPlaylist(const std::string& filePath, const std::string& name = "", size_t* missing = nullptr);
+    bool exportPlaylist(const Playlist* playlist, const std::string& filePath);
+
+    bool isLoaded() const; // False until loadFromFile has run (libraries may still be scanning)
     void setUSBMediaManager(MediaManager* usbManager);
 
     void removeTracksFromPathPrefix(const std::string& pathPrefix);
+    bool removeTrackFromAll(MediaFile* file); // True if any playlist changed
 
 
 };
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "model/SearchIndex.h"
+#include "model/MediaFile.h"
+#include "model/Metadata.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // Title, artist, album, file name
+    const int FIELD_WEIGHTS[] = { 8, 6, 4, 2 };
+    const int FIELD_COUNT = 4;
+    const int MAX_WORD_SCORE = FIELD_WEIGHTS[0] * 3; // Word at the very start of the title
+
+    bool isWordByte(unsigned char c) {
+        return c >= 0x80 || std::isalnum(c); // UTF-8 sequences count as word characters
+    }
+
+    char lowerByte(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    uint32_t trigramKey(const char* p) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+               static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+    }
+
+    // Prefix keys live above the 24-bit trigram range
+    uint32_t prefixKey(const char* p, size_t len) {
+        uint32_t key = (len == 1) ? 0x01000000u : 0x02000000u;
+        key |= static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 8;
+        if (len == 2) key |= static_cast<unsigned char>(p[1]);
+        return key;
+    }
+
+    // Calls fn(begin, length) for each word of 'text'
+    template <typename Fn>
+    void forEachWord(const std::string& text, Fn fn) {
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !isWordByte(text[i])) ++i;
+            size_t start = i;
+            while (i < text.size() && isWordByte(text[i])) ++i;
+            if (i > start) fn(start, i - start);
+        }
+    }
+
+    std::vector<std::string> splitQuery(const std::string& query) {
+        std::string lowered(query);
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(), lowerByte);
+        std::vector<std::string> words;
+        forEachWord(lowered, [&](size_t start, size_t len) { words.push_back(lowered.substr(start, len)); });
+        return words;
+    }
+
+    bool isWordStart(const std::string& text, size_t pos) {
+        return pos == 0 || !isWordByte(text[pos - 1]);
+    }
+
+    // First occurrence of 'word' in text[begin, end) that starts a word, or npos
+    size_t findWordPrefix(const std::string& text, const std::string& word, size_t begin, size_t end) {
+        for (size_t pos = text.find(word, begin); pos != std::string::npos && pos + word.size() <= end;
+             pos = text.find(word, pos + 1)) {
+            if (isWordStart(text, pos)) return pos;
+        }
+        return std::string::npos;
+    }
+}
+
+SearchIndex::Document SearchIndex::makeDocument(MediaFile* file) {
+    Document document;
+    document.file = file;
+    Metadata* meta = file->getMetadata();
+    if (meta) {
+        document.text = meta->title + FIELD_SEPARATOR + meta->getArtist() + FIELD_SEPARATOR + meta->getAlbum();
+    } else {
+        document.text = std::string(2, FIELD_SEPARATOR);
+    }
+    document.text += FIELD_SEPARATOR;
+    document.text.append(file->getFileName());
+    std::transform(document.text.begin(), document.text.end(), document.text.begin(), lowerByte);
+    size_t fieldEnd = 0;
+    for (int field = 0; field < FIELD_COUNT; ++field) {
+        fieldEnd = document.text.find(FIELD_SEPARATOR, fieldEnd + (field > 0 ? 1 : 0));
+        if (fieldEnd == std::string::npos) fieldEnd = document.text.size();
+        document.fieldEnds[field] = static_cast<uint32_t>(fieldEnd);
+    }
+    return document;
+}
+
+void SearchIndex::add(MediaFile* file) {
+    if (!file || documentIds.count(file)) return;
+
+    Document document = makeDocument(file);
+    std::vector<uint32_t> keys;
+    forEachWord(document.text, [&](size_t start, size_t len) {
+        const char* word = document.text.data() + start;
+        keys.push_back(prefixKey(word, 1));
+        if (len >= 2) keys.push_back(prefixKey(word, 2));
+        for (size_t i = 0; i + 3 <= len; ++i) {
+            keys.push_back(trigramKey(word + i));
+        }
+    });
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    uint32_t id = static_cast<uint32_t>(documents.size());
+    for (uint32_t key : keys) {
+        postings[key].push_back(id);
+    }
+    documents.push_back(std::move(document));
+    documentIds[file] = id;
+}
+
+void SearchIndex::update(MediaFile* file) {
+    remove(file);
+    add(file);
+}
+
+void SearchIndex::remove(MediaFile* file) {
+    auto it = documentIds.find(file);
+    if (it == documentIds.end()) return;
+
+    Document& document = documents[it->second];
+    document.file = nullptr;
+    std::string().swap(document.text);
+    documentIds.erase(it);
+    ++removedCount;
+
+    // Stale ids are skipped at query time; rebuild once they dominate the postings
+    if (removedCount > 1024 && removedCount > documents.size() / 2) {
+        compact();
+    }
+}
+
+void SearchIndex::clear() {
+    documents.clear();
+    documentIds.clear();
+    postings.clear();
+    removedCount = 0;
+}
+
+size_t SearchIndex::size() const {
+    return documentIds.size();
+}
+
+void SearchIndex::compact() {
+    std::vector<MediaFile*> live;
+    live.reserve(documentIds.size());
+    for (const auto& document : documents) {
+        if (document.file) live.push_back(document.file);
+    }
+    clear();
+    for (MediaFile* file : live) {
+        add(file);
+    }
+}
+
+std::vector<uint32_t> SearchIndex::exportPostings(const std::vector<MediaFile*>& files) const {
+    std::vector<uint32_t> positionOf(documents.size(), UINT32_MAX); // Document id -> position in 'files'
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto it = documentIds.find(files[i]);
+        if (it != documentIds.end()) positionOf[it->second] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> ids;
+    for (const auto& [key, list] : postings) {
+        ids.clear();
+        for (uint32_t id : list) {
+            if (positionOf[id] != UINT32_MAX) ids.push_back(positionOf[id]);
+        }
+        if (ids.empty()) continue;
+        std::sort(ids.begin(), ids.end()); // Renumbering can reorder them
+        words.push_back(key);
+        words.push_back(static_cast<uint32_t>(ids.size()));
+        words.insert(words.end(), ids.begin(), ids.end());
+    }
+    return words;
+}
+
+bool SearchIndex::restore(const std::vector<MediaFile*>& files, const uint32_t* postingWords, size_t wordCount) {
+    clear();
+    documents.reserve(files.size());
+    documentIds.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        documents.push_back(makeDocument(files[i]));
+        documentIds[files[i]] = static_cast<uint32_t>(i);
+    }
+
+    for (size_t pos = 0; pos < wordCount; ) {
+        if (wordCount - pos < 2 || postingWords[pos + 1] > wordCount - pos - 2) {
+            clear();
+            return false;
+        }
+        uint32_t key = postingWords[pos];
+        uint32_t count = postingWords[pos + 1];
+        const uint32_t* ids = postingWords + pos + 2;
+        for (uint32_t k = 0; k < count; ++k) {
+            if (ids[k] >= files.size() || (k > 0 && ids[k] <= ids[k - 1])) {
+                clear();
+                return false;
+            }
+        }
+        postings[key].assign(ids, ids + count);
+        pos += 2 + count;
+    }
+    return true;
+}
+
+int SearchIndex::scoreDocument(const Document& document, const std::vector<std::string>& words) const {
+    const std::string& text = document.text;
+    int score = 0;
+    for (const auto& word : words) {
+        int best = 0;
+        size_t fieldBegin = 0;
+        for (int field = 0; field < FIELD_COUNT; ++field) {
+            size_t fieldEnd = document.fieldEnds[field];
+            size_t pos = findWordPrefix(text, word, fieldBegin, fieldEnd);
+            int fieldScore = 0;
+            if (pos != std::string::npos) {
+                fieldScore = FIELD_WEIGHTS[field] * 2;
+                if (pos == fieldBegin) fieldScore += FIELD_WEIGHTS[field]; // Field starts with the word
+            } else if (word.size() >= 3) {
+                pos = text.find(word, fieldBegin);
+                if (pos != std::string::npos && pos + word.size() <= fieldEnd) fieldScore = FIELD_WEIGHTS[field];
+            }
+            best = std::max(best, fieldScore);
+            if (best == MAX_WORD_SCORE) break;
+            fieldBegin = fieldEnd + 1;
+        }
+        if (best == 0) return 0; // Every word has to match
+        score += best;
+    }
+    return score;
+}
+
+std::vector<MediaFile*> SearchIndex::search(const std::string& query, size_t limit) const {
+    std::vector<MediaFile*> results;
+    std::vector<std::string> words = splitQuery(query);
+    if (words.empty() || limit == 0) return results;
+
+    // Scan the shortest posting list among all the keys the query needs, then verify
+    const std::vector<uint32_t>* candidates = nullptr;
+    for (const auto& word : words) {
+        std::vector<uint32_t> keys;
+        if (word.size() < 3) {
+            keys.push_back(prefixKey(word.data(), word.size()));
+        } else {
+            for (size_t i = 0; i + 3 <= word.size(); ++i) keys.push_back(trigramKey(word.data() + i));
+        }
+        for (uint32_t key : keys) {
+            auto it = postings.find(key);
+            if (it == postings.end()) return results; // Some word can't match anything
+            if (!candidates || it->second.size() < candidates->size()) candidates = &it->second;
+        }
+    }
+
+    // Candidates come in id order, so once 'limit' documents have the best possible
+    // score nothing later can outrank them. Keeps one-letter queries cheap.
+    const int maxScore = MAX_WORD_SCORE * static_cast<int>(words.size());
+    size_t perfectCount = 0;
+    std::vector<std::pair<int, uint32_t>> scored; // (score, id)
+    for (uint32_t id : *candidates) {
+        const Document& document = documents[id];
+        if (!document.file) continue;
+        int score = scoreDocument(document, words);
+        if (score == 0) continue;
+        scored.emplace_back(score, id);
+        if (score == maxScore && ++perfectCount == limit) break;
+    }
+
+    // Highest score first, ties in insertion (library) order
+    auto better = [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    size_t count = std::min(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(), better);
+
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back(documents[scored[i].second].file);
+    }
+    return results;
+}
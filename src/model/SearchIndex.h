@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class MediaFile;
+
+// Type-ahead search over title, artist, album and file name.
+// Words are indexed by trigram (substring matches for query words of 3+ chars)
+// and by their 1- and 2-character prefixes (for shorter query words).
+// Every query word must match; results are ranked by where they matched.
+// Not thread-safe: MediaManager owns it and uses it on the UI thread only.
+class SearchIndex {
+public:
+    void add(MediaFile* file);
+    void update(MediaFile* file); // Re-reads the searchable fields after a tag edit or rename
+    void remove(MediaFile* file);
+    void clear();
+
+    std::vector<MediaFile*> search(const std::string& query, size_t limit) const;
+    size_t size() const;
+
+    // Snapshot support. Postings are flattened as [key, count, id...]... with ids
+    // renumbered to positions in 'files'; restore() takes the same 'files' back.
+    std::vector<uint32_t> exportPostings(const std::vector<MediaFile*>& files) const;
+    bool restore(const std::vector<MediaFile*>& files, const uint32_t* postingWords, size_t wordCount);
+
+private:
+    struct Document {
+        MediaFile* file; // nullptr once removed; postings are cleaned up by compact()
+        std::string text; // Lower-cased fields separated by FIELD_SEPARATOR
+        uint32_t fieldEnds[4]; // End offset of title, artist, album, file name in 'text'
+    };
+
+    static const char FIELD_SEPARATOR = '\x1f';
+
+    std::vector<Document> documents;
+    std::unordered_map<MediaFile*, uint32_t> documentIds;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings; // key -> ascending document ids
+    size_t removedCount = 0;
+
+    void compact();
+    static Document makeDocument(MediaFile* file);
+    int scoreDocument(const Document& document, const std::vector<std::string>& words) const;
+};
@@ -0,0 +1,209 @@
+#include "utils/AudioHash.h"
+#include "model/MediaManager.h"
+#include "model/LibraryCache.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/**
+ * The format tests build small synthetic files: the hasher only looks at container
+ * structure, so no real audio is needed. The hashing job runs on a copy of
+ * 'test_media/' (see test_media_manager.cpp) plus a retagged copy of one track.
+ */
+
+using Bytes = std::string;
+
+static Bytes le32(uint32_t v) { return Bytes{ char(v), char(v >> 8), char(v >> 16), char(v >> 24) }; }
+static Bytes be32(uint32_t v) { return Bytes{ char(v >> 24), char(v >> 16), char(v >> 8), char(v) }; }
+
+static Bytes id3v2(size_t bodySize) {
+    Bytes tag = "ID3";
+    tag += Bytes{ 4, 0, 0 };
+    tag += Bytes{ char((bodySize >> 21) & 0x7f), char((bodySize >> 14) & 0x7f), char((bodySize >> 7) & 0x7f), char(bodySize & 0x7f) };
+    return tag + Bytes(bodySize, 'T');
+}
+
+static Bytes id3v1(const std::string& title) {
+    Bytes tag = "TAG" + title;
+    tag.resize(128, ' ');
+    return tag;
+}
+
+static Bytes apeTag(const std::string& items) {
+    Bytes footer = "APETAGEX" + le32(2000) + le32(static_cast<uint32_t>(items.size() + 32)) + le32(1) + le32(0) + Bytes(8, '\0');
+    return items + footer;
+}
+
+static Bytes oggPage(int64_t granule, uint32_t serial, uint32_t sequence, const Bytes& payload) {
+    Bytes page = "OggS";
+    page += Bytes{ 0, 0 };
+    for (int i = 0; i < 8; ++i) page += char(granule >> (8 * i));
+    page += le32(serial) + le32(sequence) + le32(0xdeadbeef); // CRC is not checked
+    Bytes lacing;
+    size_t left = payload.size();
+    do {
+        lacing += char(std::min<size_t>(left, 255));
+        left = left >= 255 ? left - 255 : 0;
+    } while (lacing.back() == char(255) || left > 0);
+    page += char(lacing.size());
+    return page + lacing + payload;
+}
+
+static uint64_t hashOf(const Bytes& content) {
+    const std::string path = "./test_audio_hash.tmp";
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    uint64_t hash = AudioHash::hashFile(path);
+    fs::remove(path);
+    return hash;
+}
+
+static Bytes pseudoRandom(size_t size, uint32_t seed) {
+    Bytes data(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = char(seed >> 24);
+    }
+    return data;
+}
+
+int main() {
+    std::cout << "🧪 Running tests for AudioHash..." << std::endl;
+
+    // --- Test: XXH64 reference values ---
+    assert(AudioHash::hashBytes("", 0) == 0xEF46DB3751D8E999ULL);
+    assert(AudioHash::hashBytes("abc", 3) == 0x44BC2CF5AD770999ULL);
+
+    // --- Test: streaming over several reads matches the one-shot hash ---
+    Bytes frames = pseudoRandom(600 * 1024 + 13, 1);
+    assert(hashOf(frames) == AudioHash::hashBytes(frames.data(), frames.size()));
+
+    // --- Test: MP3 tags at either end are skipped ---
+    uint64_t bare = hashOf(frames);
+    assert(hashOf(id3v2(40) + frames) == bare);
+    assert(hashOf(id3v2(4000) + id3v2(10) + frames + id3v1("Retagged")) == bare);
+    assert(hashOf(frames + apeTag("Title=x") + id3v1("Both")) == bare);
+    Bytes lyrics = "LYRICSBEGINabcdef";
+    assert(hashOf(frames + lyrics + "000017LYRICS200") == bare);
+    // A damaged APE footer (size 0) is not a tag: hashed as audio, and the hash returns
+    Bytes head = pseudoRandom(1000, 7);
+    Bytes zeroApe = "APETAGEX" + Bytes(24, '\0');
+    assert(hashOf(head + zeroApe) == AudioHash::hashBytes((head + zeroApe).data(), head.size() + zeroApe.size()));
+    Bytes edited = frames;
+    edited[1000] ^= 1;
+    assert(hashOf(id3v2(40) + edited) != bare); // Audio changes do count
+
+    // --- Test: FLAC metadata blocks are skipped ---
+    Bytes flacFrames = pseudoRandom(5000, 2);
+    Bytes streamInfo = Bytes{ 0, 0, 0, 34 } + Bytes(34, 'S');
+    auto comment = [](const std::string& text) { return Bytes{ char(0x84), 0, 0, char(text.size()) } + text; };
+    assert(hashOf("fLaC" + streamInfo + comment("TITLE=a") + flacFrames) ==
+           hashOf("fLaC" + streamInfo + comment("TITLE=something longer") + flacFrames));
+    assert(hashOf(id3v2(20) + "fLaC" + streamInfo + comment("x") + flacFrames) ==
+           AudioHash::hashBytes(flacFrames.data(), flacFrames.size()));
+
+    // --- Test: Ogg header pages and page headers are skipped ---
+    Bytes audio1 = pseudoRandom(4000, 3), audio2 = pseudoRandom(700, 4);
+    auto ogg = [&](const Bytes& comments, uint32_t serial) {
+        return oggPage(0, serial, 0, "\x01vorbis ident") + oggPage(0, serial, 1, "\x03vorbis" + comments) +
+               oggPage(4096, serial, 2, audio1) + oggPage(8192, serial, 3, audio2);
+    };
+    assert(hashOf(ogg("TITLE=a", 1)) == hashOf(ogg("TITLE=b and more", 99)));
+    assert(hashOf(ogg("TITLE=a", 1)) == AudioHash::hashBytes((audio1 + audio2).data(), audio1.size() + audio2.size()));
+
+    // --- Test: only the MP4 'mdat' atom and the WAV 'data' chunk count ---
+    Bytes mdat = pseudoRandom(3000, 5);
+    auto mp4 = [&](const std::string& title) {
+        Bytes moov = "udta" + title;
+        return be32(16) + "ftypM4A " + be32(0) + be32(8 + moov.size()) + "moov" + moov + be32(8 + mdat.size()) + "mdat" + mdat;
+    };
+    assert(hashOf(mp4("a")) == hashOf(mp4("a much longer title")));
+    assert(hashOf(mp4("a")) == AudioHash::hashBytes(mdat.data(), mdat.size()));
+
+    Bytes pcm = pseudoRandom(1001, 6);
+    auto wav = [&](const std::string& info) {
+        Bytes body = "WAVE" + Bytes("fmt ") + le32(16) + Bytes(16, 'f') + "LIST" + le32(info.size()) + info + "data" + le32(pcm.size()) + pcm;
+        return "RIFF" + le32(body.size()) + body;
+    };
+    assert(hashOf(wav("INFOINAM")) == hashOf(wav("INFOINAMlonger")));
+    assert(hashOf(wav("INFO")) == AudioHash::hashBytes(pcm.data(), pcm.size()));
+
+    // --- Test: failures and the read callback ---
+    assert(AudioHash::hashFile("./does/not/exist.mp3") == 0);
+    {
+        const std::string path = "./test_audio_hash_cb.tmp";
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << frames;
+        size_t seen = 0;
+        assert(AudioHash::hashFile(path, [&seen](size_t bytes) { seen += bytes; return true; }) == bare);
+        assert(seen == frames.size());
+        assert(AudioHash::hashFile(path, [](size_t) { return false; }) == 0); // Abandoned
+        fs::remove(path);
+    }
+
+    // --- Test: the hashing job finds a retagged copy and resumes from the cache ---
+    {
+        const fs::path root = fs::absolute("test_hash_media");
+        const std::string cacheFile = "./test_hash_cache.json";
+        fs::remove_all(root);
+        fs::remove(cacheFile);
+        fs::copy("./test_media", root, fs::copy_options::recursive);
+        std::ifstream original(root / "t1.mp3", std::ios::binary);
+        Bytes content((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+        std::ofstream(root / "t1 copy.mp3", std::ios::binary) << content + id3v1("Copy"); // Same audio, one more tag
+
+        TagLibWrapper tagUtil;
+        auto waitForHashing = [](MediaManager& manager) {
+            for (int i = 0; i < 10000 && manager.isHashing(); ++i) {
+                manager.applyPendingFiles();
+                usleep(1000);
+            }
+            assert(!manager.isHashing());
+        };
+
+        LibraryCache cache(cacheFile);
+        MediaManager manager(&tagUtil);
+        manager.setLibraryCache(&cache);
+        manager.loadFromDirectory(root.string());
+        MediaFile* a = manager.findFileByPath((root / "t1.mp3").string());
+        MediaFile* b = manager.findFileByPath((root / "t1 copy.mp3").string());
+        assert(a && b);
+        assert(manager.startHashing(2, 64 * 1024 * 1024));
+        waitForHashing(manager);
+        assert(manager.getHashedCount() == manager.getHashTotal());
+        assert(a->getContentHash() != 0 && a->getContentHash() == b->getContentHash());
+        std::vector<std::vector<MediaFile*>> groups = manager.findDuplicates();
+        auto withA = std::find_if(groups.begin(), groups.end(), [a](const std::vector<MediaFile*>& group) {
+            return std::find(group.begin(), group.end(), a) != group.end();
+        });
+        assert(withA != groups.end() && std::find(withA->begin(), withA->end(), b) != withA->end());
+
+        LibraryCache reloaded(cacheFile);
+        assert(reloaded.load());
+        MediaManager resumed(&tagUtil);
+        resumed.setLibraryCache(&reloaded);
+        resumed.loadFromDirectory(root.string());
+        assert(resumed.startHashing() == false); // Everything came back from the cache
+        assert(resumed.findDuplicates().size() == groups.size());
+
+        // A rewritten file is hashed again
+        content[content.size() / 2] ^= 1;
+        std::ofstream(root / "t1 copy.mp3", std::ios::binary | std::ios::trunc) << content;
+        fs::last_write_time(root / "t1 copy.mp3", fs::file_time_type::clock::now() + std::chrono::seconds(5));
+        MediaFile* refreshed = resumed.addOrUpdateFile((root / "t1 copy.mp3").string());
+        assert(refreshed && refreshed->getContentHash() == 0);
+        assert(resumed.startHashing());
+        waitForHashing(resumed);
+        assert(refreshed->getContentHash() != 0 && refreshed->getContentHash() != a->getContentHash());
+
+        fs::remove_all(root);
+        fs::remove(cacheFile);
+    }
+
+    std::cout << "✅ AudioHash tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "utils/BackgroundFileWriter.h"
+#include "model/PlaylistManager.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/**
+ * The playlist section uses the tracks in 'test_media/' (see test_media_manager.cpp).
+ */
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+int main() {
+    std::cout << "🧪 Running tests for BackgroundFileWriter..." << std::endl;
+
+    const fs::path dir = fs::absolute("test_background_writes");
+    fs::remove_all(dir);
+    const fs::path target = dir / "nested" / "out.txt";
+
+    {
+        BackgroundFileWriter writer;
+
+        // --- Test: a write lands in full, with no temp file left behind ---
+        writer.submit(target.string(), [] { return std::string("first"); });
+        writer.flush();
+        assert(readFile(target) == "first");
+        assert(!fs::exists(target.string() + ".tmp"));
+
+        // --- Test: writes waiting behind a slow one are merged, the newest wins ---
+        writer.submit((dir / "slow.txt").string(), [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return std::string("slow");
+        });
+        for (int i = 0; i < 50; ++i) {
+            writer.submit(target.string(), [i] { return "version " + std::to_string(i); });
+        }
+        writer.flush();
+        assert(readFile(target) == "version 49");
+        assert(readFile(dir / "slow.txt") == "slow");
+        BackgroundFileWriter::Stats stats = writer.getStats();
+        assert(stats.submitted == 52 && stats.written == 3 && stats.failed == 0);
+        assert(stats.bytesWritten == std::string("first").size() + 4 + std::string("version 49").size());
+
+        // --- Test: failures are counted, and the old file is kept ---
+        writer.submit((target / "x").string(), [] { return std::string("x"); }); // Under a file
+        writer.submit(target.string(), []() -> std::string { throw std::runtime_error("no content"); });
+        writer.flush();
+        assert(writer.getStats().failed == 2);
+        assert(readFile(target) == "version 49");
+
+        // --- Test: the destructor writes what is queued ---
+        writer.submit(target.string(), [] { return std::string("on shutdown"); });
+    }
+    assert(readFile(target) == "on shutdown");
+
+    // --- Test: playlist auto-saves are debounced ---
+    {
+        TagLibWrapper tagUtil;
+        MediaManager library(&tagUtil);
+        library.loadFromDirectory("./test_media");
+        assert(library.getTotalFileCount() > 0);
+        const std::string playlistFile = (dir / "playlists.json").string();
+        size_t trackCount = 0;
+
+        {
+            PlaylistManager playlists(&library);
+            playlists.loadFromFile(playlistFile); // Not there yet: starts empty
+            playlists.setSaveDelay(std::chrono::milliseconds(200));
+            Playlist* playlist = playlists.createPlaylist("Everything"); // Journaled, one change
+            const int ADDS = 200;
+            for (int i = 0; i < ADDS; ++i) {
+                playlist->addTrack(library.at(i % library.getTotalFileCount())); // Repeats are ignored
+                playlists.autoSave();
+                assert(!playlists.saveIfDue()); // Changes keep coming
+            }
+            trackCount = playlist->getTracks().size();
+            assert(playlists.hasUnsavedChanges() && !fs::exists(playlistFile));
+            usleep(250000);
+            assert(playlists.saveIfDue() && !playlists.hasUnsavedChanges());
+            assert(!playlists.saveIfDue());
+            playlists.flushAutoSave();
+
+            PlaylistManager::SaveStats saved = playlists.getSaveStats();
+            assert(saved.changes == ADDS + 1 && saved.writes == 1);
+            assert(saved.bytesWritten == fs::file_size(playlistFile));
+
+            // --- Test: what is still pending is written on destruction ---
+            playlists.createPlaylist("Later");
+        }
+
+        PlaylistManager reloaded(&library);
+        reloaded.loadFromFile(playlistFile);
+        assert(reloaded.getAllPlaylists().size() == 2);
+        assert(reloaded.getPlaylistByName("Everything")->getTracks().size() == trackCount);
+        assert(reloaded.getPlaylistByName("Later") != nullptr);
+    }
+
+    fs::remove_all(dir);
+    std::cout << "✅ BackgroundFileWriter tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "view/BulkTagEdit.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+
+int main() {
+    std::cout << "🧪 Running tests for BulkTagEdit..." << std::endl;
+
+    AudioMetadata first, second;
+    first.setArtist("Artist A");
+    second.setArtist("Artist B");
+    first.setField("genre", "Rock");
+    second.setField("genre", "Rock");
+    std::vector<const Metadata*> targets = { &first, &second };
+    const size_t ARTIST = 0, GENRE = 2;
+
+    // --- Test: fields the files disagree on show as "(various)" ---
+    {
+        BulkTagEdit edit(targets);
+        assert(edit.getFields()[ARTIST].various && edit.getDisplayValue(ARTIST) == "(various)");
+        assert(!edit.getFields()[GENRE].various && edit.getDisplayValue(GENRE) == "Rock");
+    }
+
+    // --- Test: ENTER on "(various)" with nothing typed changes nothing ---
+    {
+        BulkTagEdit edit(targets);
+        edit.enter(ARTIST, "");
+        AudioMetadata changes;
+        assert(edit.apply(changes) == 0);
+        assert(edit.getDisplayValue(ARTIST) == "(various)");
+    }
+
+    // --- Test: confirming a shared value unchanged is not an edit ---
+    {
+        BulkTagEdit edit(targets);
+        edit.enter(GENRE, "Rock");
+        AudioMetadata changes;
+        assert(edit.apply(changes) == 0);
+    }
+
+    // --- Test: a typed value is written, and only that field ---
+    {
+        BulkTagEdit edit(targets);
+        edit.enter(ARTIST, "Both");
+        AudioMetadata changes;
+        assert(edit.apply(changes) == TagLibWrapper::ARTIST);
+        assert(changes.getArtist() == "Both");
+
+        // Typing nothing over it afterwards goes back to each file's own value
+        edit.enter(ARTIST, "");
+        assert(edit.apply(changes) == 0 && edit.getDisplayValue(ARTIST) == "(various)");
+    }
+
+    // --- Test: clearing on purpose empties the field in every file ---
+    {
+        BulkTagEdit edit(targets);
+        edit.clear(ARTIST);
+        edit.clear(GENRE);
+        AudioMetadata changes;
+        changes.setArtist("stale");
+        assert(edit.apply(changes) == (TagLibWrapper::ARTIST | TagLibWrapper::GENRE));
+        assert(changes.getArtist().empty() && changes.getField("genre").empty());
+        assert(edit.getDisplayValue(ARTIST) == "(cleared)");
+    }
+
+    std::cout << "✅ BulkTagEdit tests passed!" << std::endl;
+    return 0;
+}
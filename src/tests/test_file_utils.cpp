@@ -0,0 +1,118 @@
+#include "utils/FileUtils.h"
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <set>
+#include <sys/stat.h>
+
+namespace {
+    void touch(const fs::path& p) {
+        std::ofstream(p) << "x";
+    }
+
+    // Reference order: the previous recursive_directory_iterator walk, minus pruned folders
+    std::vector<std::string> serialWalk(const fs::path& root) {
+        std::vector<std::string> out;
+        for (auto it = fs::recursive_directory_iterator(root); it != fs::recursive_directory_iterator(); ++it) {
+            std::string name = it->path().filename().string();
+            if (it->is_directory() && name[0] == '.') { it.disable_recursion_pending(); continue; }
+            if (it->is_regular_file() && name.rfind("._", 0) != 0 && FileUtils::isMediaFile(it->path().string())) {
+                out.push_back(it->path().string());
+            }
+        }
+        return out;
+    }
+
+    // Serial depth-first walk that follows directory links: each directory is listed
+    // at the first place it is reached, later links to it are skipped
+    void serialWalkFollowingLinks(const fs::path& dir, std::set<std::pair<dev_t, ino_t>>& seen, std::vector<std::string>& out) {
+        struct stat st;
+        if (stat(dir.c_str(), &st) != 0 || !seen.insert({ st.st_dev, st.st_ino }).second) return;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            std::string name = entry.path().filename().string();
+            if (entry.is_directory()) {
+                if (name[0] != '.') serialWalkFollowingLinks(entry.path(), seen, out);
+            } else if (entry.is_regular_file() && name.rfind("._", 0) != 0 && FileUtils::isMediaFile(entry.path().string())) {
+                out.push_back(entry.path().string());
+            }
+        }
+    }
+}
+
+int main() {
+    std::cout << "🧪 Running tests for FileUtils..." << std::endl;
+
+    // --- Test: isMediaFile ---
+    assert(FileUtils::isMediaFile("/music/song.mp3"));
+    assert(FileUtils::isMediaFile("/music/SONG.FLAC"));
+    assert(FileUtils::isMediaFile("clip.Mp4"));
+    assert(!FileUtils::isMediaFile("/music/cover.jpg"));
+    assert(!FileUtils::isMediaFile("/music/noext"));
+    assert(!FileUtils::isMediaFile("/music.mp3/noext"));
+    assert(!FileUtils::isMediaFile("/music/trailing."));
+    assert(!FileUtils::isMediaFile("/music/song.mp3.part"));
+
+    // --- Test: walk order, pruning, symlink loops ---
+    fs::path root = fs::temp_directory_path() / "test_file_utils_tree";
+    fs::remove_all(root);
+    for (int d = 0; d < 6; ++d) {
+        fs::path dir = root / ("album" + std::to_string(d)) / "disc1";
+        fs::create_directories(dir);
+        for (int f = 0; f < 5; ++f) touch(dir / ("track" + std::to_string(f) + ".mp3"));
+        touch(dir.parent_path() / "cover.jpg");
+        touch(dir.parent_path() / "bonus.ogg");
+    }
+    touch(root / "top.wav");
+    touch(root / "._top.wav");
+    fs::create_directories(root / ".Trash-1000");
+    touch(root / ".Trash-1000" / "deleted.mp3");
+    fs::create_directories(root / "System Volume Information");
+    touch(root / "System Volume Information" / "junk.mp3");
+    fs::create_directory_symlink(root, root / "album0" / "loop");
+
+    std::vector<std::string> files = FileUtils::getMediaFilesRecursive(root.string(), 4);
+    assert(files.size() == 6 * 6 + 1);
+    for (const auto& f : files) {
+        assert(f.find(".Trash-1000") == std::string::npos);
+        assert(f.find("System Volume Information") == std::string::npos);
+        assert(f.find("/loop/") == std::string::npos); // Root already visited
+        assert(f.find("._") == std::string::npos);
+    }
+
+    // Deterministic and identical to a serial depth-first walk
+    fs::remove(root / "album0" / "loop");
+    fs::remove_all(root / "System Volume Information");
+    std::vector<std::string> parallel = FileUtils::getMediaFilesRecursive(root.string(), 8);
+    assert(parallel == serialWalk(root));
+    assert(parallel == FileUtils::getMediaFilesRecursive(root.string() + "/", 1));
+
+    // Links to one directory from several places: it is listed once, at its first
+    // depth-first place, even when a shallower link is reached sooner by another thread
+    fs::path shared = fs::temp_directory_path() / "test_file_utils_shared";
+    fs::remove_all(shared);
+    for (int d = 0; d < 6; ++d) {
+        fs::path target = shared / ("set" + std::to_string(d));
+        fs::create_directories(target);
+        touch(target / "linked.mp3");
+        fs::path deep = root / ("album" + std::to_string(d)) / "disc1" / "a" / "b" / "c";
+        fs::create_directories(deep);
+        fs::create_directory_symlink(target, deep / "link");
+        fs::create_directory_symlink(target, root / ("shortcut" + std::to_string(d)));
+    }
+    fs::create_directory_symlink(root / "album1", root / "album2" / "again");
+    std::set<std::pair<dev_t, ino_t>> seen;
+    std::vector<std::string> expected;
+    serialWalkFollowingLinks(root, seen, expected);
+    assert(expected.size() == 6 * 6 + 1 + 6);
+    for (int run = 0; run < 20; ++run) assert(FileUtils::getMediaFilesRecursive(root.string(), 8) == expected);
+    fs::remove_all(shared);
+
+    // --- Test: invalid root ---
+    assert(FileUtils::getMediaFilesRecursive((root / "missing").string()).empty());
+
+    fs::remove_all(root);
+    std::cout << "✅ FileUtils tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "model/LibraryCache.h"
+#include "model/AudioMetadata.h"
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <cstdio>
+#include <memory>
+
+int main() {
+    std::cout << "🧪 Running tests for LibraryCache..." << std::endl;
+
+    const std::string cacheFile = "./test_library_cache.json";
+    std::remove(cacheFile.c_str());
+
+    // --- Test: store + save ---
+    {
+        LibraryCache cache(cacheFile);
+        assert(cache.load() == false); // No file yet
+        assert(cache.size() == 0);
+
+        AudioMetadata meta;
+        meta.title = "Song";
+        meta.durationInSeconds = 215;
+        meta.fileSizeInBytes = 4096;
+        meta.setField("artist", "Someone");
+        meta.setField("year", "1999");
+
+        cache.store("/music/a/song.mp3", 4096, 111, &meta);
+        cache.storeFailure("/music/a/broken.mp3", 10, 222);
+        cache.store("/other/b.mp3", 1, 1, &meta);
+        assert(cache.size() == 3);
+        assert(cache.save() == true);
+    }
+
+    // --- Test: load + lookup ---
+    LibraryCache cache(cacheFile);
+    assert(cache.load() == true);
+    assert(cache.size() == 3);
+
+    std::unique_ptr<Metadata> out;
+    assert(cache.lookup("/music/a/song.mp3", 4096, 111, out) == true);
+    assert(out != nullptr);
+    assert(dynamic_cast<AudioMetadata*>(out.get()) != nullptr);
+    assert(out->title == "Song");
+    assert(out->durationInSeconds == 215);
+    assert(out->getField("artist") == "Someone");
+    assert(out->getField("year") == "1999");
+
+    // Stale entries miss
+    assert(cache.lookup("/music/a/song.mp3", 4096, 112, out) == false);
+    assert(cache.lookup("/music/a/song.mp3", 4097, 111, out) == false);
+    assert(cache.lookup("/music/a/missing.mp3", 1, 1, out) == false);
+
+    // Known-bad files hit with null metadata
+    assert(cache.lookup("/music/a/broken.mp3", 10, 222, out) == true);
+    assert(out == nullptr);
+
+    // --- Test: prune only touches the given root ---
+    cache.prune("/music", { "/music/a/song.mp3" });
+    assert(cache.size() == 2);
+    assert(cache.lookup("/music/a/broken.mp3", 10, 222, out) == false);
+    assert(cache.lookup("/other/b.mp3", 1, 1, out) == true);
+
+    // --- Test: a sibling root whose name starts the same is not under it ---
+    cache.storeFailure("/mnt/disk1/a.mp3", 1, 1);
+    cache.storeFailure("/mnt/disk10/b.mp3", 1, 1);
+    cache.prune("/mnt/disk1", {});
+    assert(cache.lookup("/mnt/disk1/a.mp3", 1, 1, out) == false);
+    assert(cache.lookup("/mnt/disk10/b.mp3", 1, 1, out) == true);
+    cache.prune("/mnt/disk10/", {});
+    assert(cache.lookup("/mnt/disk10/b.mp3", 1, 1, out) == false);
+
+    // --- Test: saveLater() waits for the changes to settle ---
+    std::remove(cacheFile.c_str());
+    cache.saveLater();
+    assert(!cache.saveIfDue()); // Just changed
+    assert(!std::ifstream(cacheFile).is_open());
+    assert(cache.save());
+    assert(std::ifstream(cacheFile).is_open());
+    assert(!cache.saveIfDue()); // The save above covered it
+
+    // --- Test: a failed save is retried by the next one, and never leaves a partial file ---
+    {
+        const std::string blocker = "./test_cache_blocker";
+        std::ofstream(blocker) << "a file where the cache directory should be";
+        LibraryCache blocked(blocker + "/cache.json");
+        blocked.storeFailure("/music/x.mp3", 1, 1);
+        assert(!blocked.save());
+        std::remove(blocker.c_str());
+        assert(blocked.save()); // Still dirty after the failure
+        assert(!std::ifstream(blocker + "/cache.json.tmp").is_open());
+        LibraryCache reloaded(blocker + "/cache.json");
+        assert(reloaded.load() && reloaded.size() == 1);
+        std::remove((blocker + "/cache.json").c_str());
+        std::remove(blocker.c_str());
+    }
+
+    std::remove(cacheFile.c_str());
+    std::cout << "✅ LibraryCache tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "model/MediaManager.h"
+#include "model/LibrarySnapshot.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/**
+ * Uses the real FileUtils and TagLibWrapper on a copy of 'test_media/'
+ * (see test_media_manager.cpp), so the snapshot check has files to stat.
+ */
+
+static void waitForCheck(MediaManager& manager) {
+    for (int i = 0; i < 10000 && manager.isCheckingSnapshot(); ++i) {
+        manager.applyPendingFiles();
+        usleep(1000);
+    }
+    assert(!manager.isCheckingSnapshot());
+}
+
+int main() {
+    std::cout << "🧪 Running tests for LibrarySnapshot..." << std::endl;
+
+    const fs::path root = fs::absolute("test_snapshot_media");
+    const std::string snapshotFile = "./test_library.snapshot";
+    fs::remove_all(root);
+    fs::remove(snapshotFile);
+    fs::copy("./test_media", root, fs::copy_options::recursive);
+
+    TagLibWrapper tagUtil;
+    int fileCount = 0;
+    std::string editedPath;
+
+    // --- Test: a scan writes the snapshot ---
+    {
+        MediaManager scanned(&tagUtil);
+        scanned.setSnapshotFile(snapshotFile);
+        assert(scanned.loadFromSnapshot(root.string()) == false); // Nothing written yet
+        scanned.loadFromDirectory(root.string());
+        fileCount = scanned.getTotalFileCount();
+        assert(fileCount > 1);
+        scanned.flushSnapshot(); // Written on a worker
+        assert(fs::exists(snapshotFile));
+
+        // In-memory edits and the sort order are saved too
+        MediaFile* edited = scanned.at(0);
+        editedPath = edited->getFilePath();
+        edited->getMetadata()->title = "Snapshot Title";
+        edited->getMetadata()->setArtist("Zz Last");
+        edited->getMetadata()->setField("comment", "kept");
+        scanned.notifyMetadataChanged(edited);
+        scanned.setSortOrder(SortOrder::ARTIST);
+        assert(scanned.saveSnapshot());
+        scanned.flushSnapshot();
+
+        // --- Test: a snapshot that could not be written is written by the next save ---
+        const std::string elsewhere = snapshotFile + ".retry";
+        scanned.setSnapshotFile(snapshotFile + "/not a directory"); // Under a plain file
+        scanned.notifyMetadataChanged(edited);
+        assert(scanned.saveSnapshot());
+        scanned.flushSnapshot();
+        scanned.setSnapshotFile(elsewhere);
+        assert(scanned.saveSnapshot()); // The library did not change since, but nothing was saved
+        scanned.flushSnapshot();
+        assert(fs::exists(elsewhere));
+        fs::remove(elsewhere);
+        scanned.setSnapshotFile(snapshotFile);
+
+        // --- Test: restore gives the same library, order and search results ---
+        MediaManager restored(&tagUtil);
+        restored.setSnapshotFile(snapshotFile);
+        assert(restored.loadFromSnapshot(root.string()));
+        assert(restored.getTotalFileCount() == fileCount);
+        assert(restored.getSortOrder() == SortOrder::ARTIST);
+        for (int i = 0; i < fileCount; ++i) {
+            assert(restored.at(i)->getFilePath() == scanned.at(i)->getFilePath());
+            assert(restored.at(i)->getMetadata()->title == scanned.at(i)->getMetadata()->title);
+            assert(restored.at(i)->getMetadata()->durationInSeconds == scanned.at(i)->getMetadata()->durationInSeconds);
+        }
+        MediaFile* back = restored.findFileByPath(editedPath);
+        assert(back && restored.indexOf(back) == scanned.indexOf(edited));
+        assert(back->getMetadata()->getField("comment") == "kept");
+        assert(restored.search("snapshot title", 10) == std::vector<MediaFile*>({ back }));
+
+        // --- Test: an unchanged disk leaves the restored library alone ---
+        waitForCheck(restored);
+        assert(restored.getTotalFileCount() == fileCount);
+        assert(back->getMetadata()->title == "Snapshot Title");
+    }
+
+    // --- Test: the check picks up files added, removed and rewritten since ---
+    {
+        std::string removedPath;
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file() && entry.path().string() != editedPath) {
+                removedPath = entry.path().string();
+                break;
+            }
+        }
+        fs::copy_file(removedPath, root / "added copy.mp3");
+        fs::remove(removedPath);
+        fs::last_write_time(editedPath, fs::file_time_type::clock::now() + std::chrono::seconds(5)); // Same bytes, new mtime
+
+        MediaManager checked(&tagUtil);
+        checked.setSnapshotFile(snapshotFile);
+        assert(checked.loadFromSnapshot(root.string()));
+        assert(checked.findFileByPath(removedPath) != nullptr); // Still the snapshot's view
+        waitForCheck(checked);
+        assert(checked.getTotalFileCount() == fileCount);
+        assert(checked.findFileByPath(removedPath) == nullptr);
+        assert(checked.findFileByPath((root / "added copy.mp3").string()) != nullptr);
+        assert(checked.findFileByPath(editedPath)->getMetadata()->title != "Snapshot Title"); // Re-read from disk
+    }
+
+    // --- Test: the check rewrote the snapshot ---
+    {
+        LibrarySnapshot snapshot;
+        assert(snapshot.open(snapshotFile));
+        assert(snapshot.getRecordCount() == static_cast<size_t>(fileCount));
+        assert(snapshot.getRoots() == std::vector<std::string>({ root.string() }));
+    }
+
+    // --- Test: roots are stored as a list, whatever characters their paths hold ---
+    {
+        const std::string listFile = snapshotFile + ".roots";
+        std::vector<std::string> roots = { "/mnt/line\nbreak", "/mnt/disk1", "/mnt/disk1 copy" };
+        assert(LibrarySnapshot::Writer(roots).save(listFile));
+        LibrarySnapshot snapshot;
+        assert(snapshot.open(listFile));
+        assert(snapshot.getRoots() == roots && snapshot.getRecordCount() == 0);
+        snapshot.close();
+        std::remove(listFile.c_str());
+    }
+
+    // --- Test: another root or a damaged file is refused ---
+    {
+        MediaManager other(&tagUtil);
+        other.setSnapshotFile(snapshotFile);
+        assert(other.loadFromSnapshot("/somewhere/else") == false);
+        assert(other.loadFromSnapshot(std::vector<std::string>({ root.string(), "/somewhere/else" })) == false);
+
+        std::fstream file(snapshotFile, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(fs::file_size(snapshotFile) / 2));
+        char byte = 0;
+        file.read(&byte, 1);
+        file.seekp(static_cast<std::streamoff>(fs::file_size(snapshotFile) / 2));
+        byte = static_cast<char>(byte ^ 0x40);
+        file.write(&byte, 1);
+        file.close();
+        assert(other.loadFromSnapshot(root.string()) == false);
+        assert(other.getTotalFileCount() == 0);
+    }
+
+    fs::remove_all(root);
+    fs::remove(snapshotFile);
+    std::cout << "✅ LibrarySnapshot tests passed!" << std::endl;
+    return 0;
+}
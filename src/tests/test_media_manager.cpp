@@ -1,9 +1,12 @@
 #include "model/MediaManager.h"
 #include "utils/TagLibWrapper.h" // We need the real wrapper
+#include "model/LibraryCache.h"
 #include <iostream>
 #include <cassert>
 #include <memory>
 #include <cmath>
+#include <filesystem>
+#include <unistd.h>
 
 /**
  * ================== !! QUAN TRỌNG !! ==================
@@ -55,6 +58,322 @@ int main() {
 
     std::cout << "  > Page 1, Item 1: " << page1[0]->getFileName() << std::endl;
 
+    // --- Test: Parallel load matches serial load ---
+    MediaManager serial(&tagUtil);
+    serial.setScanThreadCount(1);
+    serial.loadFromDirectory(testPath);
+
+    MediaManager parallel(&tagUtil);
+    parallel.setScanThreadCount(4);
+    parallel.loadFromDirectory(testPath);
+
+    assert(serial.getTotalFileCount() == parallel.getTotalFileCount());
+    std::vector<MediaFile*> serialAll = serial.getPage(1, fileCount);
+    std::vector<MediaFile*> parallelAll = parallel.getPage(1, fileCount);
+    for (size_t i = 0; i < serialAll.size(); ++i) {
+        assert(serialAll[i]->getFilePath() == parallelAll[i]->getFilePath());
+        assert(serialAll[i]->getMetadata()->title == parallelAll[i]->getMetadata()->title);
+        assert(serialAll[i]->getMetadata()->durationInSeconds == parallelAll[i]->getMetadata()->durationInSeconds);
+    }
+
+    // --- Test: Background load ends with the same library ---
+    MediaManager background(&tagUtil);
+    background.startBackgroundLoad(testPath);
+    while (background.isLoading()) {
+        background.applyPendingFiles();
+        usleep(1000);
+    }
+    assert(background.getTotalFileCount() == fileCount);
+    assert(background.getDiscoveredFileCount() >= fileCount);
+    std::vector<MediaFile*> backgroundAll = background.getPage(1, fileCount);
+    for (size_t i = 0; i < serialAll.size(); ++i) {
+        assert(serialAll[i]->getFilePath() == backgroundAll[i]->getFilePath());
+    }
+
+    // --- Test: Lazy mode reads tags on demand and in the background ---
+    {
+        MediaManager lazy(&tagUtil);
+        lazy.setLazyMetadata(true);
+        lazy.loadFromDirectory(testPath);
+        assert(lazy.getTotalFileCount() >= fileCount); // Unreadable files are kept until their tags are read
+        assert(lazy.getPendingMetadataCount() == lazy.getTotalFileCount());
+
+        MediaFile* first = lazy.at(0);
+        assert(first->isMetadataPending() && !first->getMetadata()->title.empty()); // File name stands in
+        assert(lazy.ensureMetadata(lazy.range(0, 1)));
+        assert(!first->isMetadataPending() && !lazy.ensureMetadata(first));
+        assert(first->getMetadata()->title == serial.findFileByPath(first->getFilePath())->getMetadata()->title);
+
+        // The page on screen and the next one are read in the background; asking again on
+        // every redraw does not hold it up
+        auto firstPagesPending = [&lazy] {
+            for (MediaFile* file : lazy.range(0, 4)) if (file->isMetadataPending()) return true;
+            return false;
+        };
+        for (int i = 0; i < 10000 && firstPagesPending(); ++i) {
+            lazy.prefetchPage(lazy.range(0, 2), 0, 2);
+            lazy.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(!firstPagesPending());
+
+        // Choosing a tag sort order reads the rest in the background; the order converges
+        lazy.prefetchAround(0, 1);
+        lazy.setSortOrder(SortOrder::ARTIST);
+        for (int i = 0; i < 10000 && lazy.getPendingMetadataCount() > 0; ++i) {
+            lazy.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(lazy.getPendingMetadataCount() == 0);
+        serial.setSortOrder(SortOrder::ARTIST);
+        for (int i = 0; i < fileCount; ++i) {
+            assert(lazy.at(i)->getFilePath() == serial.at(i)->getFilePath());
+        }
+        serial.setSortOrder(SortOrder::DATE_ADDED);
+    }
+
+    // --- Test: Fast scans are refined in the background ---
+    {
+        const std::string cacheFile = "./test_scan_profile_cache.json";
+        std::remove(cacheFile.c_str());
+        LibraryCache cache(cacheFile);
+        MediaManager fast(&tagUtil);
+        fast.setLibraryCache(&cache);
+        fast.setScanProfile(ScanProfile::FAST);
+        fast.loadFromDirectory(testPath);
+        assert(fast.getTotalFileCount() == fileCount);
+        assert(fast.at(0)->getMetadata()->estimated && fast.at(0)->getMetadata()->getExtraFields().empty());
+        assert(fast.getRefinePendingCount() == fileCount);
+
+        for (int i = 0; i < 10000 && fast.getRefinePendingCount() > 0; ++i) {
+            fast.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(fast.getRefinePendingCount() == 0);
+        for (int i = 0; i < fileCount; ++i) {
+            // Refining reads ACCURATE, so compare with an accurate read of its own
+            const Metadata* refined = fast.at(i)->getMetadata();
+            std::unique_ptr<Metadata> full = tagUtil.readTags(fast.at(i)->getFilePath(), ScanProfile::ACCURATE);
+            assert(full && !refined->estimated && refined->title == full->title);
+            assert(refined->durationInSeconds == full->durationInSeconds);
+            assert(refined->getExtraFields().size() == full->getExtraFields().size());
+        }
+
+        // The refined reads replaced the estimates in the cache, so a balanced scan uses them
+        MediaManager balanced(&tagUtil);
+        balanced.setLibraryCache(&cache);
+        balanced.loadFromDirectory(testPath);
+        assert(!balanced.at(0)->getMetadata()->estimated && balanced.getRefinePendingCount() == 0);
+        std::remove(cacheFile.c_str());
+    }
+
+    // --- Test: Several roots merge into one library; each can be rescanned or dropped alone ---
+    {
+        namespace fs = std::filesystem;
+        const fs::path base = fs::absolute("test_roots_media");
+        const std::string cacheFile = "./test_roots_cache.json";
+        fs::remove_all(base);
+        std::remove(cacheFile.c_str());
+        const std::string rootA = (base / "a").string(), rootB = (base / "b").string();
+        fs::create_directories(rootA);
+        fs::create_directories(rootB);
+        std::vector<std::string> tracks;
+        for (const auto& entry : fs::directory_iterator(testPath)) {
+            if (entry.path().extension() == ".mp3") tracks.push_back(entry.path().string());
+        }
+        assert(tracks.size() >= 3);
+        fs::copy_file(tracks[0], rootA + "/one.mp3");
+        fs::copy_file(tracks[1], rootA + "/two.mp3");
+        fs::copy_file(tracks[2], rootB + "/three.mp3");
+
+        LibraryCache cache(cacheFile);
+        MediaManager merged(&tagUtil);
+        merged.setLibraryCache(&cache);
+        merged.startBackgroundLoad(std::vector<std::string>({ rootA, rootB }));
+        assert(!merged.addRoot(rootA + "/nested")); // Roots may not overlap
+        while (merged.isLoading()) {
+            merged.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(merged.getTotalFileCount() == 3);
+        assert(merged.getRoots() == std::vector<std::string>({ rootA, rootB }));
+        MediaFile* one = merged.findFileByPath(rootA + "/one.mp3");
+        assert(one && merged.getSourceRoot(one) == rootA);
+        assert(merged.getSourceRoot(merged.findFileByPath(rootB + "/three.mp3")) == rootB);
+        assert(merged.ownsPath(rootB + "/new.mp3") && !merged.ownsPath(base.string() + "/elsewhere.mp3"));
+
+        // Rescanning B picks up its changes and leaves A's entries alone, even stale ones
+        fs::copy_file(tracks[0], rootB + "/four.mp3");
+        fs::remove(rootB + "/three.mp3");
+        fs::remove(rootA + "/two.mp3");
+        assert(merged.rescanRoot(rootB));
+        assert(!merged.rescanRoot(rootB)); // Already running
+        while (merged.isLoading()) {
+            merged.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(merged.findFileByPath(rootB + "/three.mp3") == nullptr);
+        assert(merged.getSourceRoot(merged.findFileByPath(rootB + "/four.mp3")) == rootB);
+        assert(merged.findFileByPath(rootA + "/two.mp3") != nullptr);
+        assert(merged.findFileByPath(rootA + "/one.mp3") == one); // Unchanged entries are kept as they are
+
+        // After lost watcher events every root is rescanned in the background
+        fs::copy_file(tracks[1], rootB + "/five.mp3");
+        merged.syncWithDirectory();
+        assert(merged.isLoading() && merged.findFileByPath(rootB + "/five.mp3") == nullptr);
+        while (merged.isLoading()) {
+            merged.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(merged.getSourceRoot(merged.findFileByPath(rootB + "/five.mp3")) == rootB);
+        assert(merged.findFileByPath(rootA + "/two.mp3") == nullptr);
+        fs::copy_file(tracks[1], rootA + "/two.mp3"); // Back for the removeRoot count below
+        merged.syncWithDirectory();
+        merged.syncWithDirectory(); // Busy: queued, not started twice
+        while (merged.isLoading()) {
+            merged.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(merged.findFileByPath(rootA + "/two.mp3") != nullptr);
+        fs::remove(rootB + "/five.mp3");
+        merged.removeFile(rootB + "/five.mp3");
+
+        // Dropping A removes its entries only
+        int removedCount = 0;
+        merged.setOnFileRemovedCallback([&removedCount](MediaFile*) { ++removedCount; });
+        assert(merged.removeRoot(rootA) && !merged.removeRoot(rootA));
+        assert(removedCount == 2 && merged.getTotalFileCount() == 1);
+        assert(merged.getRoots() == std::vector<std::string>({ rootB }));
+        assert(merged.at(0)->getFilePath() == rootB + "/four.mp3");
+        assert(merged.findFileByPath(rootA + "/one.mp3") == nullptr && !merged.ownsPath(rootA + "/one.mp3"));
+
+        fs::remove_all(base);
+        std::remove(cacheFile.c_str());
+    }
+
+    // --- Test: Roots whose names share a prefix keep each other's cache entries ---
+    {
+        namespace fs = std::filesystem;
+        const fs::path base = fs::absolute("test_sibling_roots");
+        const std::string cacheFile = "./test_sibling_cache.json";
+        fs::remove_all(base);
+        std::remove(cacheFile.c_str());
+        const std::string disk1 = (base / "disk1").string(), disk10 = (base / "disk10").string();
+        fs::create_directories(disk1);
+        fs::create_directories(disk10);
+        fs::copy_file(testPath + "/t1.mp3", disk1 + "/one.mp3");
+        fs::copy_file(testPath + "/t2.mp3", disk10 + "/ten.mp3");
+        {
+            LibraryCache cache(cacheFile);
+            MediaManager siblings(&tagUtil);
+            siblings.setLibraryCache(&cache);
+            siblings.startBackgroundLoad(std::vector<std::string>({ disk10, disk1 }));
+            while (siblings.isLoading()) {
+                siblings.applyPendingFiles();
+                usleep(1000);
+            }
+            assert(siblings.getTotalFileCount() == 2);
+        }
+        LibraryCache saved(cacheFile); // Written once both scans were done
+        saved.load();
+        assert(saved.size() == 2);
+        fs::remove_all(base);
+        std::remove(cacheFile.c_str());
+    }
+
+    // --- Test: Path index follows renames (keys view the entry's own path) ---
+    {
+        MediaManager index(&tagUtil);
+        MediaFile* a = index.addMediaFile(std::make_unique<MediaFile>("/lib/a/one.mp3", std::make_unique<Metadata>()));
+        index.addMediaFile(std::make_unique<MediaFile>("/lib/a/two.mp3", std::make_unique<Metadata>()));
+        assert(a->getFileName() == "one.mp3");
+        assert(index.addMediaFile(std::make_unique<MediaFile>("/lib/a/one.mp3", std::make_unique<Metadata>())) == a);
+        assert(index.getTotalFileCount() == 2);
+
+        assert(index.renameFile("/lib/a/one.mp3", "/lib/a/renamed.mp3"));
+        assert(index.findFileByPath("/lib/a/one.mp3") == nullptr);
+        assert(index.findFileByPath("/lib/a/renamed.mp3") == a);
+        assert(a->getFileName() == "renamed.mp3");
+
+        assert(index.renameDirectory("/lib/a", "/lib/b") == 2);
+        assert(index.findFileByPath("/lib/b/renamed.mp3") == a);
+        assert(index.findFileByPath("/lib/b/two.mp3") != nullptr);
+        assert(index.removeFile("/lib/b/two.mp3"));
+        assert(index.findFileByPath("/lib/b/two.mp3") == nullptr);
+        assert(index.getTotalFileCount() == 1);
+    }
+
+    // --- Test: Sort orders are kept in step with adds, edits and removals ---
+    {
+        MediaManager sorted(&tagUtil);
+        auto add = [&](const std::string& path, const std::string& artist, int year, int duration) {
+            auto meta = std::make_unique<Metadata>();
+            meta->setArtist(artist);
+            meta->setYear(year);
+            meta->durationInSeconds = duration;
+            return sorted.addMediaFile(std::make_unique<MediaFile>(path, std::move(meta)));
+        };
+        MediaFile* c = add("/lib/c.mp3", "cher", 1998, 240);
+        MediaFile* a = add("/lib/a.mp3", "ABBA", 1976, 180);
+        MediaFile* b = add("/lib/b.mp3", "", 0, 300); // Unknown artist/year sort last
+
+        assert(sorted.getPage(1, 10)[0] == c); // DATE_ADDED: insertion order
+        sorted.setSortOrder(SortOrder::ARTIST);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, c, b }));
+        sorted.setSortOrder(SortOrder::DURATION);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, c, b }));
+        sorted.setSortOrder(SortOrder::FILE_NAME);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, b, c }));
+        sorted.setSortOrder(SortOrder::YEAR);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, c, b }));
+
+        // Materialised views are patched, not rebuilt
+        MediaFile* d = add("/lib/d.mp3", "Beck", 1994, 200);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, d, c, b }));
+        sorted.setSortOrder(SortOrder::ARTIST);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, d, c, b }));
+        assert(sorted.getPage(2, 3) == std::vector<MediaFile*>({ b }));
+
+        a->getMetadata()->setArtist("Zappa");
+        sorted.notifyMetadataChanged(a);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ d, c, a, b }));
+
+        // A bulk edit is re-sorted once for every file it touched
+        d->getMetadata()->setArtist("Zz Top");
+        b->getMetadata()->setArtist("Air");
+        sorted.notifyMetadataChanged(std::vector<MediaFile*>({ d, b }));
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ b, c, a, d }));
+        d->getMetadata()->setArtist("Beck");
+        b->getMetadata()->setArtist("");
+        sorted.notifyMetadataChanged(std::vector<MediaFile*>({ d, b }));
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ d, c, a, b }));
+
+        assert(sorted.removeFile("/lib/c.mp3"));
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ d, a, b }));
+        sorted.setSortOrder(SortOrder::YEAR);
+        assert(sorted.getPage(1, 10) == std::vector<MediaFile*>({ a, d, b })); // Year view saw the same edits
+
+        // --- Indexed access follows the same order ---
+        assert(sorted.at(0) == a && sorted.at(2) == b && sorted.at(3) == nullptr);
+        assert(sorted.indexOf(d) == 1 && sorted.indexOf(nullptr) == -1);
+        MediaFileRange tail = sorted.range(1, 10);
+        assert(tail.size() == 2 && tail[0] == d && tail[1] == b);
+        assert(sorted.range(3, 10).empty());
+        sorted.setSortOrder(SortOrder::DATE_ADDED);
+        assert(sorted.indexOf(a) == 0 && sorted.indexOf(d) == 2);
+        MediaFile other("/elsewhere/x.mp3", std::make_unique<Metadata>());
+        assert(sorted.indexOf(&other) == -1);
+        sorted.setSortOrder(SortOrder::ARTIST);
+        assert(sorted.indexOf(&other) == -1);
+
+        // Deletes in one batch leave the rest in order; unknown paths are skipped
+        add("/lib/e.mp3", "Eno", 1975, 250);
+        assert(sorted.removeFiles({ "/lib/a.mp3", "/lib/missing.mp3", "/lib/b.mp3" }) == 2);
+        assert(sorted.getTotalFileCount() == 2 && sorted.findFileByPath("/lib/a.mp3") == nullptr);
+        assert(sorted.getPage(1, 10)[0] == d && sorted.at(1)->getFilePath() == "/lib/e.mp3");
+        assert(sorted.removeFiles({ "/lib/missing.mp3" }) == 0);
+    }
+
     // --- Test: clearLibrary ---
     mm.clearLibrary();
     assert(mm.getTotalFileCount() == 0);
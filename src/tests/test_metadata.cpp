@@ -0,0 +1,50 @@
+#include "model/AudioMetadata.h"
+#include <iostream>
+#include <cassert>
+
+int main() {
+    std::cout << "🧪 Running tests for Metadata..." << std::endl;
+
+    // --- Test: Defaults ---
+    AudioMetadata meta;
+    assert(meta.getField("artist").empty());
+    assert(meta.getField("year") == "0");
+    assert(meta.getField("tracknumber").empty());
+    assert(meta.getField("missing").empty());
+
+    // --- Test: Standard keys map to typed fields ---
+    meta.setField("title", "Song");
+    meta.setField("artist", "Someone");
+    meta.setField("album", "Record");
+    meta.setField("year", "1999");
+    meta.setField("tracknumber", "3/12");
+    assert(meta.title == "Song");
+    assert(meta.getArtist() == "Someone");
+    assert(meta.getField("album") == "Record");
+    assert(meta.getYear() == 1999);
+    assert(meta.getTrackNumber() == 3);
+    meta.setField("year", "not a year");
+    assert(meta.getYear() == 0);
+
+    // --- Test: Standard strings are interned and shared ---
+    AudioMetadata other;
+    other.setArtist("Someone");
+    assert(&other.getArtist() == &meta.getArtist());
+
+    // --- Test: Extended fields (sorted vector) ---
+    meta.setField("publisher", "Label");
+    meta.setField("composer", "Writer");
+    meta.setField("publisher", "Other Label");
+    assert(meta.getField("publisher") == "Other Label");
+    assert(meta.getField("composer") == "Writer");
+
+    auto fields = meta.getFields();
+    assert(fields.size() == 7); // artist, album, genre, year, tracknumber + 2 extras
+    assert(fields["artist"] == "Someone");
+    assert(fields["tracknumber"] == "3");
+    assert(fields["composer"] == "Writer");
+    assert(fields.count("title") == 0); // Title is serialised separately
+
+    std::cout << "✅ Metadata tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "model/PlaylistExchange.h"
+#include "model/PlaylistManager.h"
+#include "model/MediaManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * The library is built in memory: the tracks need not exist on disk.
+ */
+
+static std::vector<std::string> readAll(const std::string& text, PlaylistExchange::Format format, const std::string& baseDir) {
+    std::vector<std::string> paths;
+    std::string error;
+    std::istringstream in(text);
+    assert(PlaylistExchange::read(in, format, baseDir, [&paths](const std::string& path) { paths.push_back(path); }, error));
+    return paths;
+}
+
+static std::vector<std::string> trackPaths(const Playlist* playlist) {
+    std::vector<std::string> paths;
+    for (const MediaFile* file : playlist->getTracks()) paths.push_back(file->getFilePath());
+    return paths;
+}
+
+int main() {
+    std::cout << "🧪 Running tests for PlaylistExchange..." << std::endl;
+    using PlaylistExchange::Format;
+
+    // --- Test: formats come from the extension ---
+    Format format;
+    assert(PlaylistExchange::formatFromPath("/x/Mix.M3U", format) && format == Format::M3U);
+    assert(PlaylistExchange::formatFromPath("mix.m3u8", format) && format == Format::M3U8);
+    assert(PlaylistExchange::formatFromPath("mix.pls", format) && format == Format::PLS);
+    assert(!PlaylistExchange::formatFromPath("mix.json", format));
+
+    // --- Test: M3U entries, relative ones against the playlist's directory ---
+    std::vector<std::string> paths = readAll(
+        "\xEF\xBB\xBF#EXTM3U\r\n"
+        "#EXTINF:215,Artist - Title\r\n"
+        "/music/a.mp3\r\n"
+        "\r\n"
+        "  b.mp3  \n"
+        "sub/../c.mp3\n"
+        "../other/./d.mp3\n"
+        "file:///music/with%20space.mp3\n"
+        "file://localhost/music/e.mp3\n"
+        "http://radio.example/stream\n"
+        "# comment\n"
+        "/music/last.mp3", // No final line break
+        Format::M3U8, "/lists");
+    assert((paths == std::vector<std::string>{ "/music/a.mp3", "/lists/b.mp3", "/lists/c.mp3", "/other/d.mp3",
+                                               "/music/with space.mp3", "/music/e.mp3", "/music/last.mp3" }));
+
+    // --- Test: PLS entries in file order; other sections and keys are ignored ---
+    paths = readAll("[other]\nFile1=/not/this.mp3\n[playlist]\nNumberOfEntries=3\nFile1=/music/a.mp3\nTitle1=A\n"
+                    "Length1=100\nfile2 = rel.mp3\nFileX=/bad.mp3\nFile3=http://stream\nVersion=2\n",
+                    Format::PLS, "/lists");
+    assert((paths == std::vector<std::string>{ "/music/a.mp3", "/lists/rel.mp3" }));
+    std::string error;
+    std::istringstream notPls("/music/a.mp3\n");
+    assert(!PlaylistExchange::read(notPls, Format::PLS, "/lists", [](const std::string&) {}, error) && !error.empty());
+
+    // --- Test: written relative under the base directory, full elsewhere, and read back ---
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    const fs::path dir = fs::absolute("test_playlist_exchange");
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::vector<MediaFile*> tracks;
+    for (const std::string& path : { (dir / "music/one.mp3").string(), (dir / "music/two.flac").string(), std::string("/elsewhere/three.ogg") }) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = "Title of " + fs::path(path).stem().string();
+        meta->setArtist(path == "/elsewhere/three.ogg" ? "" : "Artist");
+        meta->durationInSeconds = 180;
+        tracks.push_back(library.addMediaFile(std::make_unique<MediaFile>(path, std::move(meta))));
+    }
+    std::vector<std::string> expected = { tracks[0]->getFilePath(), tracks[1]->getFilePath(), tracks[2]->getFilePath() };
+
+    std::ostringstream m3u;
+    PlaylistExchange::write(m3u, Format::M3U, tracks, dir.string());
+    assert(m3u.str().find("#EXTINF:180,Artist - Title of one\nmusic/one.mp3\n") != std::string::npos);
+    assert(m3u.str().find("#EXTINF:180,Title of three\n/elsewhere/three.ogg\n") != std::string::npos);
+    assert(readAll(m3u.str(), Format::M3U, dir.string()) == expected);
+
+    std::ostringstream pls;
+    PlaylistExchange::write(pls, Format::PLS, tracks, dir.string());
+    assert(pls.str().find("File2=music/two.flac\nTitle2=Artist - Title of two\nLength2=180\n") != std::string::npos);
+    assert(pls.str().find("NumberOfEntries=3\n") != std::string::npos);
+    assert(readAll(pls.str(), Format::PLS, dir.string()) == expected);
+
+    // --- Test: PlaylistManager import and export ---
+    {
+        PlaylistManager playlists(&library);
+        Playlist* mix = playlists.createPlaylist("Mix");
+        for (MediaFile* track : tracks) playlists.addTrack(mix, track);
+        for (const char* name : { "mix.m3u", "mix.m3u8", "mix.pls" }) {
+            const std::string file = (dir / name).string();
+            assert(playlists.exportPlaylist(mix, file));
+            size_t missing = 99;
+            Playlist* imported = playlists.importPlaylist(file, std::string("Imported ") + name, &missing);
+            assert(imported && missing == 0 && trackPaths(imported) == expected);
+        }
+        assert(!playlists.importPlaylist((dir / "mix.m3u").string(), "Mix")); // Name taken
+        assert(!playlists.importPlaylist((dir / "missing.m3u").string()));
+        assert(!playlists.exportPlaylist(mix, (dir / "mix.txt").string()));
+
+        // Entries not in the library are counted and left out; a repeated one is kept once
+        std::ofstream((dir / "Partial.m3u").string()) << "music/one.mp3\n/nowhere.mp3\nmusic/one.mp3\n";
+        size_t missing = 0;
+        Playlist* partial = playlists.importPlaylist((dir / "Partial.m3u").string(), "", &missing);
+        assert(partial && partial->getName() == "Partial" && missing == 1);
+        assert(trackPaths(partial) == std::vector<std::string>{ expected[0] });
+    }
+
+    fs::remove_all(dir);
+    std::cout << "✅ PlaylistExchange tests passed!" << std::endl;
+    return 0;
+}
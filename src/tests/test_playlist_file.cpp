@@ -0,0 +1,147 @@
+#include "model/PlaylistFile.h"
+#include "model/MediaFile.h"
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <map>
+#include <memory>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+int main() {
+    std::cout << "🧪 Running tests for PlaylistFile..." << std::endl;
+
+    // Tracks the reader can resolve; anything else is "not in the library"
+    std::map<std::string, std::unique_ptr<MediaFile>> library;
+    for (const std::string path : { "/music/a.mp3", "/music/quote \"b\".mp3", "/music/tab\tand\\slash.mp3",
+                                    "/music/\xC3\xA9t\xC3\xA9 \xF0\x9F\x8E\xB5.flac", "/music/ctrl\x01.ogg" }) {
+        library[path] = std::make_unique<MediaFile>(path, nullptr);
+    }
+    auto resolve = [&library](const std::string& path) -> MediaFile* {
+        auto it = library.find(path);
+        return it != library.end() ? it->second.get() : nullptr;
+    };
+
+    // --- Test: the writer emits exactly what json::dump(4) does ---
+    PlaylistFile::Snapshot snapshot;
+    snapshot.journal = 42;
+    json expected = { {"journal", 42}, {"playlists", json::array()} };
+    auto addPlaylist = [&](const std::string& name, const std::vector<std::string>& tracks) {
+        snapshot.addPlaylist(name);
+        json playlist = { {"name", name}, {"tracks", json::array()} };
+        for (const auto& track : tracks) {
+            snapshot.addTrack(track);
+            playlist["tracks"].push_back(track);
+        }
+        expected["playlists"].push_back(playlist);
+    };
+
+    std::ostringstream empty;
+    PlaylistFile::write(empty, snapshot);
+    assert(empty.str() == expected.dump(4));
+
+    std::vector<std::string> everything;
+    for (const auto& [path, file] : library) everything.push_back(path);
+    addPlaylist("All \"of\" them", everything);
+    addPlaylist("Empty", {});
+    addPlaylist("\xE2\x98\x85 Favourites", { "/music/a.mp3", "/music/missing.mp3" });
+    std::ostringstream written;
+    PlaylistFile::write(written, snapshot);
+    assert(written.str() == expected.dump(4));
+
+    // --- Test: names json::dump() would refuse are refused ---
+    PlaylistFile::Snapshot invalid;
+    invalid.addPlaylist("Broken");
+    invalid.addTrack("/music/latin1 \xE9.mp3");
+    std::ostringstream discarded;
+    bool threw = false;
+    try { PlaylistFile::write(discarded, invalid); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+
+    // --- Test: reading back, with tracks resolved as they stream in ---
+    std::vector<std::pair<std::string, std::vector<MediaFile*>>> read;
+    std::vector<std::vector<std::string>> readMissing;
+    auto collect = [&read, &readMissing](const std::string& name, const std::vector<MediaFile*>& tracks,
+                                         const std::vector<std::string>& missing) {
+        read.emplace_back(name, tracks);
+        readMissing.push_back(missing);
+    };
+    uint64_t journal = 0;
+    PlaylistFile::Format format = PlaylistFile::Format::BINARY;
+    std::string error;
+    std::istringstream in(written.str());
+    assert(PlaylistFile::read(in, "test", resolve, collect, journal, format, error));
+    assert(journal == 42 && format == PlaylistFile::Format::JSON && read.size() == 3);
+    assert(read[0].first == "All \"of\" them" && read[0].second.size() == library.size());
+    for (size_t i = 0; i < everything.size(); ++i) assert(read[0].second[i]->getFilePath() == everything[i]);
+    assert(read[1].first == "Empty" && read[1].second.empty());
+    assert(read[2].second.size() == 1 && read[2].second[0] == library["/music/a.mp3"].get());
+    assert(readMissing[2] == std::vector<std::string>{ "/music/missing.mp3" }); // Passed on by path
+
+    // --- Test: the layout from before the journal, and malformed entries, are read around ---
+    read.clear();
+    std::istringstream legacy(R"([
+        {"name": "Ok", "tracks": ["/music/a.mp3", 7, ["nested"]], "extra": {"x": [1, 2]}},
+        {"name": 3, "tracks": []},
+        {"tracks": ["/music/a.mp3"], "name": "Keys swapped"},
+        "not a playlist",
+        {"name": "No tracks"}
+    ])");
+    assert(PlaylistFile::read(legacy, "legacy", resolve, collect, journal, format, error));
+    assert(journal == 0 && read.size() == 2);
+    assert(read[0].first == "Ok" && read[0].second.size() == 1);
+    assert(read[1].first == "Keys swapped" && read[1].second.size() == 1);
+
+    // --- Test: a file cut short reports the error, after what came before it ---
+    read.clear();
+    std::istringstream truncated(written.str().substr(0, written.str().size() / 2));
+    assert(!PlaylistFile::read(truncated, "truncated", resolve, collect, journal, format, error));
+    assert(!error.empty() && read.size() <= 1);
+
+    // --- Test: the binary encoding reads back the same, and smaller ---
+    std::ostringstream binary;
+    PlaylistFile::write(binary, snapshot, PlaylistFile::Format::BINARY);
+    assert(binary.str().size() < written.str().size());
+    read.clear();
+    readMissing.clear();
+    std::istringstream binaryIn(binary.str());
+    assert(PlaylistFile::read(binaryIn, "binary", resolve, collect, journal, format, error));
+    assert(journal == 42 && format == PlaylistFile::Format::BINARY && read.size() == 3);
+    assert(read[0].first == "All \"of\" them" && read[0].second.size() == library.size());
+    for (size_t i = 0; i < everything.size(); ++i) assert(read[0].second[i]->getFilePath() == everything[i]);
+    assert(read[1].first == "Empty" && read[1].second.empty());
+    assert(read[2].first == "\xE2\x98\x85 Favourites");
+    assert(read[2].second.size() == 1 && read[2].second[0] == library["/music/a.mp3"].get());
+    assert(readMissing[0].empty() && readMissing[2] == std::vector<std::string>{ "/music/missing.mp3" });
+
+    // Bytes JSON could not hold are kept as they are
+    std::ostringstream rawBinary;
+    PlaylistFile::write(rawBinary, invalid, PlaylistFile::Format::BINARY);
+    library["/music/latin1 \xE9.mp3"] = std::make_unique<MediaFile>("/music/latin1 \xE9.mp3", nullptr);
+    read.clear();
+    std::istringstream rawIn(rawBinary.str());
+    assert(PlaylistFile::read(rawIn, "raw", resolve, collect, journal, format, error));
+    assert(read.size() == 1 && read[0].second.size() == 1 && read[0].second[0]->getFilePath() == "/music/latin1 \xE9.mp3");
+
+    // --- Test: a damaged or cut short binary file is refused ---
+    std::string bytes = binary.str();
+    for (size_t at : { bytes.size() / 3, bytes.size() / 2, bytes.size() - 1 }) {
+        std::string damaged = bytes;
+        damaged[at] ^= 0x20;
+        std::istringstream damagedIn(damaged);
+        assert(!PlaylistFile::read(damagedIn, "damaged", resolve, collect, journal, format, error) && !error.empty());
+    }
+    for (size_t length : { size_t(3), size_t(6), bytes.size() / 2, bytes.size() - 1 }) {
+        std::istringstream cut(bytes.substr(0, length));
+        assert(!PlaylistFile::read(cut, "cut", resolve, collect, journal, format, error) && !error.empty());
+    }
+    std::string newer = bytes;
+    newer[4] = 99; // Version
+    std::istringstream newerIn(newer);
+    assert(!PlaylistFile::read(newerIn, "newer", resolve, collect, journal, format, error));
+    assert(error.find("version") != std::string::npos);
+
+    std::cout << "✅ PlaylistFile tests passed!" << std::endl;
+    return 0;
+}
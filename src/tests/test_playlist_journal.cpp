@@ -0,0 +1,204 @@
+#include "model/PlaylistManager.h"
+#include "model/MediaManager.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * Uses the tracks in 'test_media/' (see test_media_manager.cpp). A crash is simulated
+ * by copying the playlist files, as they are at that moment, to another directory.
+ */
+
+static std::vector<std::string> trackPaths(Playlist* playlist) {
+    std::vector<std::string> paths;
+    if (!playlist) return paths;
+    for (const MediaFile* file : playlist->getTracks()) paths.push_back(file->getFilePath());
+    return paths;
+}
+
+static size_t lineCount(const fs::path& path) {
+    std::ifstream in(path);
+    size_t lines = 0;
+    for (std::string line; std::getline(in, line); ) ++lines;
+    return lines;
+}
+
+// The playlist file and journal as on disk now, in 'crashDir'
+static std::string copyFiles(const fs::path& dir, const fs::path& crashDir, bool withSnapshot = true) {
+    fs::create_directories(crashDir);
+    if (withSnapshot) fs::copy_file(dir / "playlists.json", crashDir / "playlists.json");
+    fs::copy_file(dir / "playlists.json.journal", crashDir / "playlists.json.journal");
+    return (crashDir / "playlists.json").string();
+}
+
+int main() {
+    std::cout << "🧪 Running tests for the playlist journal..." << std::endl;
+
+    const fs::path dir = fs::absolute("test_playlist_journal");
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string playlistFile = (dir / "playlists.json").string();
+    const fs::path journalFile = playlistFile + ".journal";
+
+    TagLibWrapper tagUtil;
+    MediaManager library(&tagUtil);
+    library.loadFromDirectory("./test_media");
+    assert(library.getTotalFileCount() >= 4);
+
+    std::vector<std::string> expected;
+    {
+        PlaylistManager playlists(&library);
+        playlists.loadFromFile(playlistFile);
+
+        // --- Test: every edit is one journal line, and nothing is rewritten ---
+        Playlist* mix = playlists.createPlaylist("Mix");
+        for (size_t i = 0; i < 4; ++i) assert(playlists.addTrack(mix, library.at(i)));
+        assert(!playlists.addTrack(mix, library.at(0))); // Already there: not journaled
+        assert(playlists.moveTrack(mix, 3, 0));
+        assert(!playlists.moveTrack(mix, 0, 9));
+        assert(playlists.removeTrack(mix, library.at(1)));
+        playlists.createPlaylist("Gone");
+        assert(playlists.deletePlaylist("Gone"));
+        expected = trackPaths(mix);
+        assert(expected.size() == 3 && expected[0] == library.at(3)->getFilePath());
+
+        PlaylistManager::SaveStats stats = playlists.getSaveStats();
+        assert(stats.journalEntries == 9 && stats.writes == 0 && !fs::exists(playlistFile));
+        assert(lineCount(journalFile) == 9);
+        assert(stats.journalBytes / stats.journalEntries < 256); // No matter how long the playlists get
+
+        // --- Test: a journal without any snapshot is replayed from scratch ---
+        {
+            PlaylistManager replayed(&library);
+            replayed.loadFromFile(copyFiles(dir, dir / "crash1", false));
+            assert(replayed.getAllPlaylists().size() == 1 && replayed.getPlaylistByName("Gone") == nullptr);
+            assert(trackPaths(replayed.getPlaylistByName("Mix")) == expected);
+        }
+
+        // --- Test: compaction writes a snapshot and empties the journal ---
+        fs::copy_file(journalFile, dir / "old.journal");
+        playlists.flushAutoSave();
+        assert(fs::exists(playlistFile) && fs::file_size(journalFile) == 0);
+        assert(playlists.getSaveStats().writes == 1);
+
+        // --- Test: a crash between the snapshot and emptying the journal replays nothing twice ---
+        {
+            std::string crashed = copyFiles(dir, dir / "crash2");
+            fs::copy_file(dir / "old.journal", dir / "crash2" / "playlists.json.journal", fs::copy_options::overwrite_existing);
+            PlaylistManager replayed(&library);
+            replayed.loadFromFile(crashed);
+            assert(trackPaths(replayed.getPlaylistByName("Mix")) == expected); // The move is not applied again
+        }
+
+        // --- Test: a line cut short by a crash is dropped, and later entries still count ---
+        assert(playlists.addTrack(mix, library.at(1)));
+        expected.push_back(library.at(1)->getFilePath());
+        {
+            std::string crashed = copyFiles(dir, dir / "crash3");
+            const fs::path crashedJournal = dir / "crash3" / "playlists.json.journal";
+            std::ofstream(crashedJournal, std::ios::app) << "{\"seq\":99,\"op\":\"add\",\"playl";
+            {
+                PlaylistManager replayed(&library);
+                replayed.loadFromFile(crashed);
+                Playlist* replayedMix = replayed.getPlaylistByName("Mix");
+                assert(trackPaths(replayedMix) == expected);
+                assert(lineCount(crashedJournal) == 1);
+                assert(replayed.moveTrack(replayedMix, 0, 3));
+                assert(lineCount(crashedJournal) == 2);
+            }
+            PlaylistManager reloaded(&library);
+            reloaded.loadFromFile(crashed);
+            std::vector<std::string> moved = trackPaths(reloaded.getPlaylistByName("Mix"));
+            assert(moved.size() == 4 && moved[3] == expected[0]);
+        }
+
+        // --- Test: a long journal is compacted by the poll ---
+        assert(!playlists.saveIfDue());
+        for (uint64_t i = 1; i < PlaylistManager::COMPACT_AFTER_ENTRIES; i += 2) {
+            assert(playlists.removeTrack(mix, library.at(2)));
+            assert(playlists.addTrack(mix, library.at(2)));
+        }
+        expected.erase(std::find(expected.begin(), expected.end(), library.at(2)->getFilePath()));
+        expected.push_back(library.at(2)->getFilePath());
+        assert(playlists.saveIfDue());
+        playlists.flushAutoSave();
+        assert(fs::file_size(journalFile) == 0 && playlists.getSaveStats().writes == 2);
+        assert(!playlists.saveIfDue());
+
+        // --- Test: edits left in the journal are folded in on destruction ---
+        playlists.createPlaylist("Last");
+    }
+    assert(fs::file_size(journalFile) == 0);
+    {
+        PlaylistManager reloaded(&library);
+        reloaded.loadFromFile(playlistFile);
+        assert(reloaded.getAllPlaylists().size() == 2 && reloaded.getPlaylistByName("Last"));
+        assert(trackPaths(reloaded.getPlaylistByName("Mix")) == expected);
+    }
+
+    // --- Test: a playlist file from before the journal still loads ---
+    {
+        const std::string legacyFile = (dir / "legacy.json").string();
+        std::ofstream(legacyFile) << "[{\"name\": \"Old\", \"tracks\": [\"" << expected[0] << "\"]}]";
+        PlaylistManager legacy(&library);
+        legacy.loadFromFile(legacyFile);
+        assert(trackPaths(legacy.getPlaylistByName("Old")) == std::vector<std::string>{ expected[0] });
+    }
+
+    // --- Test: tracks of a library that is not there are kept through edits and saves ---
+    {
+        MediaManager unmounted(&tagUtil); // As if the root holding the tracks were gone
+        PlaylistManager playlists(&unmounted);
+        playlists.loadFromFile(playlistFile);
+        Playlist* mix = playlists.getPlaylistByName("Mix");
+        assert(mix && mix->getTracks().empty() && mix->getMissingTracks() == expected);
+        playlists.createPlaylist("While away"); // An edit, so the snapshot is rewritten
+        playlists.flushAutoSave();
+    }
+    {
+        PlaylistManager reloaded(&library);
+        reloaded.loadFromFile(playlistFile);
+        assert(trackPaths(reloaded.getPlaylistByName("Mix")) == expected);
+        assert(reloaded.getPlaylistByName("Mix")->getMissingTracks().empty());
+        assert(reloaded.getPlaylistByName("While away"));
+        assert(reloaded.deletePlaylist("While away"));
+    }
+
+    // --- Test: a save that could not be written is reported ---
+    {
+        PlaylistManager playlists(&library);
+        assert(!playlists.saveToFile("/proc/no such dir/playlists.json"));
+        assert(playlists.saveToFile((dir / "copy.json").string()));
+    }
+
+    // --- Test: moving to the binary format keeps the playlists and the journal going ---
+    const std::string binaryFile = (dir / "playlists.bin").string();
+    {
+        PlaylistManager playlists(&library);
+        playlists.loadFromFile(playlistFile);
+        playlists.createPlaylist("Pending");
+    }
+    {
+        PlaylistManager playlists(&library);
+        playlists.setFileFormat(PlaylistFile::Format::BINARY);
+        assert(playlists.migrateFile(playlistFile, binaryFile));
+        assert(!fs::exists(playlistFile) && !fs::exists(journalFile));
+        assert(playlists.getPlaylistByName("Pending") && trackPaths(playlists.getPlaylistByName("Mix")) == expected);
+        playlists.createPlaylist("After"); // Journaled next to the new file
+        assert(lineCount(binaryFile + ".journal") == 1);
+    }
+    {
+        PlaylistManager reloaded(&library);
+        reloaded.loadFromFile(binaryFile); // Read as binary whatever the format setting
+        assert(reloaded.getAllPlaylists().size() == 4 && reloaded.getPlaylistByName("After"));
+        assert(trackPaths(reloaded.getPlaylistByName("Mix")) == expected);
+    }
+
+    fs::remove_all(dir);
+    std::cout << "✅ Playlist journal tests passed!" << std::endl;
+    return 0;
+}
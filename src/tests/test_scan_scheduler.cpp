@@ -0,0 +1,109 @@
+#include "utils/ScanScheduler.h"
+#include "model/MediaManager.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+
+/**
+ * The last test scans 'test_media/' (see test_media_manager.cpp).
+ */
+
+int main() {
+    std::cout << "🧪 Running tests for ScanScheduler..." << std::endl;
+
+    ScanScheduler scheduler;
+    int screen = 0, other = 0; // Owners are just addresses
+    std::atomic<bool> notCancelled(false);
+
+    // --- Test: equal priorities never wait ---
+    scheduler.beginScan(&screen);
+    assert(scheduler.waitTurn(&other, notCancelled));
+    assert(scheduler.getPriority(&other) == ScanPriority::NORMAL);
+
+    // --- Test: a background reader waits until the foreground scan ends ---
+    scheduler.setPriority(&screen, ScanPriority::FOREGROUND);
+    scheduler.setPriority(&other, ScanPriority::BACKGROUND);
+    assert(scheduler.waitTurn(&screen, notCancelled)); // Nothing above it
+    std::atomic<bool> passed(false);
+    std::thread reader([&] {
+        assert(scheduler.waitTurn(&other, notCancelled));
+        passed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(!passed && scheduler.isWaiting(&other));
+    scheduler.endScan(&screen);
+    reader.join();
+    assert(passed && !scheduler.isWaiting(&other));
+
+    // --- Test: losing the priority releases the waiter too ---
+    scheduler.beginScan(&screen);
+    passed = false;
+    reader = std::thread([&] {
+        assert(scheduler.waitTurn(&other, notCancelled));
+        passed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(!passed);
+    scheduler.setPriority(&screen, ScanPriority::NORMAL);
+    scheduler.setPriority(&other, ScanPriority::NORMAL);
+    reader.join();
+    assert(passed);
+
+    // --- Test: cancelling a waiting reader ---
+    scheduler.setPriority(&screen, ScanPriority::FOREGROUND);
+    scheduler.setPriority(&other, ScanPriority::BACKGROUND);
+    std::atomic<bool> cancelled(false);
+    reader = std::thread([&] { assert(!scheduler.waitTurn(&other, cancelled)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    cancelled = true;
+    reader.join();
+    scheduler.endScan(&screen);
+    scheduler.removeOwner(&screen);
+    scheduler.removeOwner(&other);
+
+    // --- Test: two libraries on one scheduler both finish; a cancelled scan stops at once ---
+    {
+        TagLibWrapper tagUtil;
+        MediaManager onScreen(&tagUtil), behind(&tagUtil);
+        onScreen.setScanScheduler(&scheduler);
+        behind.setScanScheduler(&scheduler);
+        onScreen.setScanPriority(ScanPriority::FOREGROUND);
+        behind.setScanPriority(ScanPriority::BACKGROUND);
+        onScreen.startBackgroundLoad("./test_media");
+        behind.startBackgroundLoad("./test_media");
+        for (int i = 0; i < 10000 && (onScreen.isLoading() || behind.isLoading()); ++i) {
+            onScreen.applyPendingFiles();
+            behind.applyPendingFiles();
+            usleep(1000);
+        }
+        assert(!onScreen.isLoading() && !behind.isLoading());
+        assert(onScreen.getTotalFileCount() > 0 && behind.getTotalFileCount() == onScreen.getTotalFileCount());
+
+        ScanProgress idle = behind.getScanProgress();
+        assert(idle.discovered == 0 && !idle.walking && !idle.waiting); // Only running scans count
+
+        // --- Test: the status line the library views show ---
+        ScanProgress progress;
+        progress.walking = true;
+        assert(progress.getStatusText() == "Scanning...");
+        progress.discovered = 4000;
+        progress.processed = 120;
+        assert(progress.getStatusText() == "Scanning... 120/4000 files");
+        progress.walking = false;
+        assert(progress.getStatusText() == "Loading... 120/4000 files");
+        progress.waiting = true;
+        assert(progress.getStatusText() == "Waiting... 120/4000 files");
+
+        behind.startBackgroundLoad("./test_media");
+        behind.cancelBackgroundLoad();
+        assert(!behind.isLoading());
+        behind.applyPendingFiles();
+        assert(behind.getTotalFileCount() <= onScreen.getTotalFileCount());
+    }
+
+    std::cout << "✅ ScanScheduler tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "model/MediaManager.h"
+#include "model/AudioMetadata.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <memory>
+
+namespace {
+    MediaFile* addTrack(MediaManager& mm, const std::string& path, const std::string& title,
+                        const std::string& artist, const std::string& album) {
+        auto meta = std::make_unique<AudioMetadata>();
+        meta->title = title;
+        meta->setArtist(artist);
+        meta->setAlbum(album);
+        return mm.addMediaFile(std::make_unique<MediaFile>(path, std::move(meta)));
+    }
+}
+
+int main() {
+    std::cout << "🧪 Running tests for SearchIndex..." << std::endl;
+
+    TagLibWrapper tagUtil;
+    MediaManager mm(&tagUtil);
+    MediaFile* yesterday = addTrack(mm, "/lib/01 yesterday.mp3", "Yesterday", "The Beatles", "Help!");
+    MediaFile* help = addTrack(mm, "/lib/02 help.mp3", "Help!", "The Beatles", "Help!");
+    MediaFile* daytripper = addTrack(mm, "/lib/03 day tripper.mp3", "Day Tripper", "The Beatles", "Singles");
+    MediaFile* helpless = addTrack(mm, "/lib/04 helpless.mp3", "Helpless", "Neil Young", "Deja Vu");
+    MediaFile* video = mm.addMediaFile(std::make_unique<MediaFile>("/lib/Holiday_Clip.MP4", std::make_unique<Metadata>()));
+
+    // --- Test: Substring, case-insensitive ---
+    std::vector<MediaFile*> results = mm.search("TRIPP");
+    assert(results.size() == 1 && results[0] == daytripper);
+
+    // --- Test: Every word must match, across fields ---
+    results = mm.search("beatles day");
+    assert(results.size() == 2); // "Day Tripper", and "Yesterday" as a substring
+    assert(results[0] == daytripper);
+    assert(mm.search("beatles neil").empty());
+
+    // --- Test: Ranking (title beats album; word start beats mid-word) ---
+    results = mm.search("help");
+    assert(results.size() == 3);
+    assert(results[0] == help); // Title and album start with "help"
+    assert(results[1] == helpless); // Title prefix
+    assert(results[2] == yesterday); // Album only
+    assert(mm.search("help", 1).size() == 1);
+
+    // --- Test: Short words match word prefixes only ---
+    results = mm.search("ye");
+    assert(results.size() == 1 && results[0] == yesterday);
+    assert(mm.search("y").size() == 2); // "Yesterday", "Young" (not "da-y")
+    assert(mm.search("ip").empty()); // Inside "Tripper", but not a word start
+    assert(mm.search("elp").size() == 3); // 3+ chars also match inside words
+
+    // --- Test: File names are searchable ---
+    results = mm.search("holiday clip");
+    assert(results.size() == 1 && results[0] == video);
+
+    // --- Test: Kept up to date on edits, renames and removals ---
+    uint64_t generation = mm.getGeneration();
+    helpless->getMetadata()->title = "Old Man";
+    mm.notifyMetadataChanged(helpless);
+    assert(mm.getGeneration() != generation);
+    assert(mm.search("old man").size() == 1);
+    results = mm.search("help");
+    assert(results.size() == 3 && results.back() == helpless); // Now only via its file name
+
+    assert(mm.renameFile("/lib/Holiday_Clip.MP4", "/lib/vacation.mp4"));
+    assert(mm.search("holiday").empty());
+    assert(mm.search("vacation").size() == 1);
+
+    assert(mm.removeFile("/lib/02 help.mp3"));
+    results = mm.search("help");
+    assert(results.size() == 2 && results[0] == yesterday);
+
+    mm.clearLibrary();
+    assert(mm.search("beatles").empty());
+    assert(mm.search("").empty());
+
+    std::cout << "✅ SearchIndex tests passed!" << std::endl;
+    return 0;
+}
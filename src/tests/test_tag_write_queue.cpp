@@ -0,0 +1,98 @@
+#include "utils/TagWriteQueue.h"
+#include "utils/TagLibWrapper.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * Writes to copies of the tracks in 'test_media/' (see test_media_manager.cpp).
+ */
+
+int main() {
+    std::cout << "🧪 Running tests for TagWriteQueue..." << std::endl;
+
+    const fs::path dir = fs::absolute("test_tag_write_media");
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string track = (dir / "t1.mp3").string();
+    fs::copy_file("./test_media/t1.mp3", track);
+
+    TagLibWrapper tagUtil;
+
+    // --- Test: only changed fields count ---
+    std::unique_ptr<Metadata> original = tagUtil.readTags(track);
+    assert(original);
+    Metadata edited = *original;
+    assert(TagLibWrapper::changedFields(*original, edited) == 0);
+    edited.title = "Queued title";
+    edited.setArtist("Queued artist");
+    assert(TagLibWrapper::changedFields(*original, edited) == (TagLibWrapper::TITLE | TagLibWrapper::ARTIST));
+
+    {
+        TagWriteQueue queue(&tagUtil);
+        assert(!queue.enqueue(track, edited, 0)); // Nothing to write
+        assert(queue.getPendingCount() == 0);
+
+        // --- Test: repeated edits to one file are merged while they wait ---
+        const int EDITS = 20;
+        for (int i = 0; i < EDITS; ++i) {
+            edited.setYear(2000 + i);
+            assert(queue.enqueue(track, edited, TagLibWrapper::TITLE | (i == EDITS - 1 ? TagLibWrapper::YEAR : 0)));
+        }
+        assert(queue.enqueue(track, edited, TagLibWrapper::ARTIST));
+        queue.flush("/some/other/stick"); // Nothing of ours under there: returns at once
+        queue.flush(dir.string());
+        assert(queue.getPendingCount() == 0 && !queue.isPending(track));
+
+        std::vector<TagWriteQueue::Result> results = queue.takeResults();
+        assert(!results.empty() && results.size() <= static_cast<size_t>(EDITS + 1));
+        unsigned written = 0;
+        for (const auto& result : results) {
+            assert(result.path == track && result.ok);
+            written |= result.fields;
+        }
+        assert(written == (TagLibWrapper::TITLE | TagLibWrapper::ARTIST | TagLibWrapper::YEAR));
+        assert(queue.takeResults().empty());
+
+        std::unique_ptr<Metadata> reread = tagUtil.readTags(track);
+        assert(reread && reread->title == "Queued title" && reread->getArtist() == "Queued artist");
+        assert(reread->getYear() == 2000 + EDITS - 1);
+        assert(reread->getAlbum() == original->getAlbum()); // Not part of any edit
+
+        // --- Test: failures are reported per file ---
+        assert(queue.enqueue((dir / "missing.mp3").string(), edited, TagLibWrapper::TITLE));
+        queue.flush();
+        results = queue.takeResults();
+        assert(results.size() == 1 && !results[0].ok);
+
+        // --- Test: a bulk edit of several files, one device at a time or several ---
+        std::vector<std::string> copies;
+        for (int i = 1; i <= 5; ++i) {
+            copies.push_back((dir / ("bulk" + std::to_string(i) + ".mp3")).string());
+            fs::copy_file("./test_media/t" + std::to_string(i) + ".mp3", copies.back());
+        }
+        for (int limit : { 1, 3 }) {
+            queue.setDeviceLimit(dir.string(), limit);
+            edited.setAlbum("Bulk album " + std::to_string(limit));
+            for (const auto& copy : copies) assert(queue.enqueue(copy, edited, TagLibWrapper::ALBUM));
+            queue.flush(dir.string());
+            results = queue.takeResults();
+            assert(results.size() == copies.size());
+            for (const auto& result : results) assert(result.ok && result.fields == TagLibWrapper::ALBUM);
+            // The limits only go up, so the peak so far is this round's
+            assert(queue.getPeakRunning(copies.front()) >= 1 && queue.getPeakRunning(copies.front()) <= limit);
+            for (const auto& copy : copies) assert(tagUtil.readTags(copy)->getAlbum() == "Bulk album " + std::to_string(limit));
+        }
+
+        // --- Test: the destructor finishes what is queued ---
+        edited.title = "Written on shutdown";
+        assert(queue.enqueue(track, edited, TagLibWrapper::TITLE));
+    }
+    assert(tagUtil.readTags(track)->title == "Written on shutdown");
+
+    fs::remove_all(dir);
+    std::cout << "✅ TagWriteQueue tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include "utils/AudioHash.h"
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    // --- XXH64 (streaming) ---
+    const uint64_t PRIME1 = 11400714785074694791ULL;
+    const uint64_t PRIME2 = 14029467366897019727ULL;
+    const uint64_t PRIME3 = 1609587929392839161ULL;
+    const uint64_t PRIME4 = 9650029242287828579ULL;
+    const uint64_t PRIME5 = 2870177450012600261ULL;
+
+    uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    uint64_t read64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    uint32_t read32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    uint64_t round64(uint64_t acc, uint64_t input) {
+        acc += input * PRIME2;
+        acc = rotl(acc, 31);
+        return acc * PRIME1;
+    }
+
+    uint64_t mergeRound(uint64_t acc, uint64_t value) {
+        acc ^= round64(0, value);
+        return acc * PRIME1 + PRIME4;
+    }
+
+    class Xxh64 {
+    public:
+        void update(const unsigned char* data, size_t size) {
+            total += size;
+            if (buffered + size < 32) {
+                std::memcpy(buffer + buffered, data, size);
+                buffered += size;
+                return;
+            }
+            if (buffered > 0) {
+                size_t fill = 32 - buffered;
+                std::memcpy(buffer + buffered, data, fill);
+                stripe(buffer);
+                data += fill;
+                size -= fill;
+                buffered = 0;
+            }
+            for (; size >= 32; data += 32, size -= 32) stripe(data);
+            std::memcpy(buffer, data, size);
+            buffered = size;
+        }
+
+        uint64_t digest() const {
+            uint64_t h;
+            if (total >= 32) {
+                h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+                for (int i = 0; i < 4; ++i) h = mergeRound(h, v[i]);
+            } else {
+                h = PRIME5;
+            }
+            h += total;
+
+            const unsigned char* p = buffer;
+            size_t left = buffered;
+            for (; left >= 8; p += 8, left -= 8) {
+                h ^= round64(0, read64(p));
+                h = rotl(h, 27) * PRIME1 + PRIME4;
+            }
+            if (left >= 4) {
+                h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+                h = rotl(h, 23) * PRIME2 + PRIME3;
+                p += 4;
+                left -= 4;
+            }
+            for (; left > 0; ++p, --left) {
+                h ^= (*p) * PRIME5;
+                h = rotl(h, 11) * PRIME1;
+            }
+
+            h ^= h >> 33;
+            h *= PRIME2;
+            h ^= h >> 29;
+            h *= PRIME3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        uint64_t v[4] = { PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 };
+        unsigned char buffer[32];
+        size_t buffered = 0;
+        uint64_t total = 0;
+
+        void stripe(const unsigned char* p) {
+            for (int i = 0; i < 4; ++i) v[i] = round64(v[i], read64(p + i * 8));
+        }
+    };
+
+    uint32_t readBE32(const unsigned char* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    uint32_t readLE32(const unsigned char* p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    // Feeds chosen byte ranges of one file into the hash
+    class PayloadHasher {
+    public:
+        PayloadHasher(int fd, uint64_t fileSize, const AudioHash::ReadCallback& onRead)
+            : fileSize(fileSize), fd(fd), onRead(onRead), buffer(256 * 1024) {}
+
+        bool readAt(uint64_t offset, unsigned char* out, size_t size) {
+            if (offset > fileSize || size > fileSize - offset) return false;
+            while (size > 0) {
+                ssize_t n = pread(fd, out, size, static_cast<off_t>(offset));
+                if (n <= 0) return false;
+                out += n;
+                offset += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        bool hashRange(uint64_t offset, uint64_t size) {
+            hashedAny = true;
+            while (size > 0) {
+                size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, buffer.size()));
+                if (!readAt(offset, buffer.data(), chunk)) return false;
+                state.update(buffer.data(), chunk);
+                if (onRead && !onRead(chunk)) return false;
+                offset += chunk;
+                size -= chunk;
+            }
+            return true;
+        }
+
+        bool hashOgg(uint64_t pos, uint64_t end);
+        bool hashFlac(uint64_t pos, uint64_t end);
+        bool hashMp4(uint64_t pos, uint64_t end);
+        bool hashRiff(uint64_t pos, uint64_t end);
+
+        uint64_t fileSize;
+        bool hashedAny = false;
+        Xxh64 state;
+
+    private:
+        int fd;
+        const AudioHash::ReadCallback& onRead;
+        std::vector<unsigned char> buffer;
+    };
+
+    // Page payloads only: page headers carry a serial number, sequence and CRC that a
+    // tag editor rewrites. Header packets (where the comments live) end on a page with
+    // granule 0 and the first audio packet starts a fresh page, so everything before the
+    // first page with a real granule position is skipped.
+    bool PayloadHasher::hashOgg(uint64_t pos, uint64_t end) {
+        bool inAudio = false;
+        unsigned char header[27 + 255];
+        while (pos + 27 <= end) {
+            if (!readAt(pos, header, 27) || std::memcmp(header, "OggS", 4) != 0) break;
+            unsigned segments = header[26];
+            if (!readAt(pos + 27, header + 27, segments)) break;
+            uint64_t payload = 0;
+            for (unsigned i = 0; i < segments; ++i) payload += header[27 + i];
+
+            int64_t granule;
+            std::memcpy(&granule, header + 6, 8);
+            if (!inAudio && granule != 0 && granule != -1) inAudio = true;
+
+            uint64_t payloadPos = pos + 27 + segments;
+            if (payloadPos + payload > end) break;
+            if (inAudio && !hashRange(payloadPos, payload)) return false;
+            pos = payloadPos + payload;
+        }
+        return true;
+    }
+
+    bool PayloadHasher::hashFlac(uint64_t pos, uint64_t end) {
+        pos += 4; // "fLaC"
+        unsigned char block[4];
+        bool last = false;
+        while (!last && pos + 4 <= end) {
+            if (!readAt(pos, block, 4)) return false;
+            last = (block[0] & 0x80) != 0;
+            pos += 4 + ((uint64_t(block[1]) << 16) | (uint64_t(block[2]) << 8) | block[3]);
+        }
+        return pos >= end || hashRange(pos, end - pos);
+    }
+
+    bool PayloadHasher::hashMp4(uint64_t pos, uint64_t end) {
+        unsigned char atom[16];
+        while (pos + 8 <= end) {
+            if (!readAt(pos, atom, 8)) return false;
+            uint64_t size = readBE32(atom);
+            uint64_t headerSize = 8;
+            if (size == 1) {
+                if (pos + 16 > end || !readAt(pos + 8, atom + 8, 8)) return false;
+                size = (uint64_t(readBE32(atom + 8)) << 32) | readBE32(atom + 12);
+                headerSize = 16;
+            } else if (size == 0) {
+                size = end - pos; // Runs to the end of the file
+            }
+            if (size < headerSize) break;
+            if (std::memcmp(atom + 4, "mdat", 4) == 0) {
+                uint64_t dataSize = std::min(size, end - pos) - headerSize;
+                if (!hashRange(pos + headerSize, dataSize)) return false;
+            }
+            if (size > end - pos) break;
+            pos += size;
+        }
+        return true;
+    }
+
+    bool PayloadHasher::hashRiff(uint64_t pos, uint64_t end) {
+        pos += 12; // "RIFF" size "WAVE"
+        unsigned char chunk[8];
+        while (pos + 8 <= end) {
+            if (!readAt(pos, chunk, 8)) return false;
+            uint64_t size = readLE32(chunk + 4);
+            if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!hashRange(pos + 8, std::min(size, end - pos - 8))) return false;
+            }
+            pos += 8 + size + (size & 1);
+        }
+        return true;
+    }
+}
+
+uint64_t AudioHash::hashBytes(const void* data, size_t size) {
+    Xxh64 state;
+    state.update(static_cast<const unsigned char*>(data), size);
+    return state.digest();
+}
+
+uint64_t AudioHash::hashFile(const std::string& filePath, const ReadCallback& onRead) {
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return 0;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    PayloadHasher hasher(fd, static_cast<uint64_t>(st.st_size), onRead);
+    uint64_t begin = 0;
+    uint64_t end = hasher.fileSize;
+    unsigned char probe[128];
+
+    // Leading ID3v2 tags (there can be more than one)
+    while (end - begin >= 10 && hasher.readAt(begin, probe, 10) && std::memcmp(probe, "ID3", 3) == 0) {
+        uint64_t size = (uint64_t(probe[6] & 0x7f) << 21) | (uint64_t(probe[7] & 0x7f) << 14) |
+                        (uint64_t(probe[8] & 0x7f) << 7) | (probe[9] & 0x7f);
+        uint64_t total = 10 + size + ((probe[5] & 0x10) ? 10 : 0); // Footer flag
+        if (total > end - begin) break;
+        begin += total;
+    }
+
+    // Trailing ID3v1, APEv2 and Lyrics3v2 tags, in any order
+    for (bool stripped = true; stripped; ) {
+        stripped = false;
+        uint64_t length = end - begin;
+        if (length >= 128 && hasher.readAt(end - 128, probe, 3) && std::memcmp(probe, "TAG", 3) == 0) {
+            end -= 128;
+            stripped = true;
+        } else if (length >= 32 && hasher.readAt(end - 32, probe, 32) && std::memcmp(probe, "APETAGEX", 8) == 0) {
+            uint64_t size = readLE32(probe + 12) + ((readLE32(probe + 20) & 0x80000000u) ? 32 : 0); // + header
+            if (size >= 32 && size <= length) { // The size counts the footer; less is a damaged tag
+                end -= size;
+                stripped = true;
+            }
+        } else if (length >= 15 && hasher.readAt(end - 15, probe, 15) && std::memcmp(probe + 6, "LYRICS200", 9) == 0) {
+            uint64_t size = 0;
+            for (int i = 0; i < 6; ++i) size = size * 10 + (probe[i] >= '0' && probe[i] <= '9' ? probe[i] - '0' : 0);
+            if (size + 15 <= length) {
+                end -= size + 15;
+                stripped = true;
+            }
+        }
+    }
+
+    bool ok = true;
+    if (end - begin >= 12 && hasher.readAt(begin, probe, 12)) {
+        if (std::memcmp(probe, "fLaC", 4) == 0) {
+            ok = hasher.hashFlac(begin, end);
+        } else if (std::memcmp(probe, "OggS", 4) == 0) {
+            ok = hasher.hashOgg(begin, end);
+        } else if (std::memcmp(probe, "RIFF", 4) == 0 && std::memcmp(probe + 8, "WAVE", 4) == 0) {
+            ok = hasher.hashRiff(begin, end);
+        } else if (std::memcmp(probe + 4, "ftyp", 4) == 0) {
+            ok = hasher.hashMp4(begin, end);
+        }
+    }
+    if (ok && !hasher.hashedAny) {
+        ok = hasher.hashRange(begin, end - begin); // MP3/AAC frames, or a container we could not follow
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); // Background job: leave the page cache to playback
+    close(fd);
+    if (!ok) return 0;
+    uint64_t hash = hasher.state.digest();
+    return hash != 0 ? hash : 1;
+}
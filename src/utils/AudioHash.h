@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// Content hash of a file's audio payload, for spotting the same recording under
+// several paths. Tag regions are left out so retagging does not change the hash:
+// ID3v2 at the start, ID3v1/APEv2/Lyrics3 at the end, FLAC metadata blocks,
+// Ogg header pages (and all Ogg page headers), MP4 atoms other than 'mdat' and
+// RIFF chunks other than 'data'. XXH64, so not meant to resist tampering.
+namespace AudioHash {
+    // Called after each read with the number of bytes just read. Return false to abandon the file.
+    using ReadCallback = std::function<bool(size_t bytesRead)>;
+
+    // 0 if the file could not be read or the callback gave up (a real hash is never 0)
+    uint64_t hashFile(const std::string& filePath, const ReadCallback& onRead = nullptr);
+
+    uint64_t hashBytes(const void* data, size_t size); // One-shot XXH64, seed 0
+}
@@ -0,0 +1,81 @@
+#include "utils/BackgroundFileWriter.h"
+#include "utils/FileUtils.h"
+#include <algorithm>
+#include <iostream>
+
+BackgroundFileWriter::BackgroundFileWriter()
+    : writing(false), stopping(false), thread(&BackgroundFileWriter::worker, this)
+{}
+
+BackgroundFileWriter::~BackgroundFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true; // The worker drains the queue before it returns
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void BackgroundFileWriter::submit(const std::string& path, std::function<std::string()> render,
+                                  std::function<void(bool ok)> onWritten) {
+    submit(path, [render = std::move(render)](std::ostream& out) { out << render(); }, std::move(onWritten));
+}
+
+void BackgroundFileWriter::submit(const std::string& path, std::function<void(std::ostream&)> write,
+                                  std::function<void(bool ok)> onWritten) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.submitted;
+        // A write already running has rendered its content; only a waiting one can take the newer one
+        auto it = std::find_if(queue.begin(), queue.end(), [&path](const Job& job) { return job.path == path; });
+        if (it != queue.end()) {
+            it->write = std::move(write);
+            it->onWritten = std::move(onWritten);
+            return;
+        }
+        queue.push_back({ path, std::move(write), std::move(onWritten) });
+    }
+    wake.notify_one();
+}
+
+void BackgroundFileWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+BackgroundFileWriter::Stats BackgroundFileWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void BackgroundFileWriter::worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !queue.empty() || stopping; });
+        if (queue.empty()) return; // Stopping, and nothing left to write
+
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+
+        lock.unlock();
+        unsigned long long bytes = 0;
+        bool ok = false;
+        try {
+            ok = FileUtils::writeFileAtomically(job.path, job.write, &bytes);
+        } catch (const std::exception& e) {
+            std::cerr << "BackgroundFileWriter Error: Could not produce " << job.path << ": " << e.what() << std::endl;
+        }
+        if (job.onWritten) job.onWritten(ok);
+        lock.lock();
+
+        writing = false;
+        if (ok) {
+            ++stats.written;
+            stats.bytesWritten += bytes;
+        } else {
+            ++stats.failed;
+        }
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Writes files on a worker thread with FileUtils::writeFileAtomically(). The content is
+// produced by a callback run on the worker, returned whole or streamed to the file, so
+// serializing a large document does not stall the caller either; it must only use what
+// it owns (capture by value). A file submitted again while its previous write is still
+// waiting is written once, with the newest content.
+class BackgroundFileWriter {
+public:
+    struct Stats {
+        size_t submitted = 0;               // submit() calls
+        size_t written = 0;                 // Files actually written
+        size_t failed = 0;
+        unsigned long long bytesWritten = 0;
+    };
+
+    BackgroundFileWriter();
+    ~BackgroundFileWriter(); // Writes whatever is still waiting
+
+    BackgroundFileWriter(const BackgroundFileWriter&) = delete;
+    BackgroundFileWriter& operator=(const BackgroundFileWriter&) = delete;
+
+    // 'onWritten' runs on the worker once the file is written (or failed). A merged
+    // submission replaces the callback of the one it supersedes.
+    void submit(const std::string& path, std::function<std::string()> render,
+                std::function<void(bool ok)> onWritten = nullptr);
+    void submit(const std::string& path, std::function<void(std::ostream&)> write,
+                std::function<void(bool ok)> onWritten = nullptr);
+    void flush(); // Blocks until every submitted write has finished
+    Stats getStats() const;
+
+private:
+    struct Job {
+        std::string path;
+        std::function<void(std::ostream&)> write;
+        std::function<void(bool)> onWritten;
+    };
+
+    void worker();
+
+    std::deque<Job> queue;
+    bool writing;
+    bool stopping;
+    Stats stats;
+    mutable std::mutex mutex;
+    std::condition_variable wake;     // A job was queued, or stopping
+    std::condition_variable finished; // A write finished
+    std::thread thread;               // Last: starts once the rest is set up
+};
@@ -1,66 +1,238 @@
 #include "FileUtils.h"
+#include "utils/ThreadPool.h"
 #include <filesystem> 
 #include <iostream>
-#include <set>
+#include <fstream>
 #include <string>
 #include <algorithm> 
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
 
+#include <fcntl.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
 #include <linux/limits.h> 
 
 namespace {
-    std::string toLower(std::string s) {
-        std::transform(s.begin(), s.end(), s.begin(),
-                       [](unsigned char c){ return std::tolower(c); });
-        return s;
-    }
-} 
-
-bool FileUtils::isMediaFile(const std::string& filePath) {
-    static const std::set<std::string> mediaExtensions = {
-        ".mp3", ".wav", ".flac", ".aac", ".ogg", ".m4a",
-        ".mp4", ".mkv", ".avi", ".mov", ".wmv", ".flv"
+    const char* const MEDIA_EXTENSIONS[] = {
+        "mp3", "wav", "flac", "aac", "ogg", "m4a",
+        "mp4", "mkv", "avi", "mov", "wmv", "flv"
     };
 
-    try {
-        std::string ext = std::filesystem::path(filePath).extension().string();
-        return mediaExtensions.count(toLower(ext));
-    } catch (std::exception& e) {
-        std::cerr << "Error checking file extension: " << e.what() << std::endl;
+    // Case-insensitive extension check on the raw name, without allocating
+    bool hasMediaExtension(const char* name, size_t len) {
+        const char* dot = nullptr;
+        for (size_t i = len; i-- > 0; ) {
+            if (name[i] == '.') { dot = name + i; break; }
+            if (name[i] == '/') break;
+        }
+        if (!dot || dot == name + len - 1) return false;
+
+        size_t extLen = (name + len) - (dot + 1);
+        if (extLen > 4) return false;
+
+        char ext[5];
+        for (size_t i = 0; i < extLen; ++i) {
+            ext[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(dot[1 + i])));
+        }
+        ext[extLen] = '\0';
+
+        for (const char* candidate : MEDIA_EXTENSIONS) {
+            if (std::strcmp(ext, candidate) == 0) return true;
+        }
         return false;
     }
-}
 
-std::vector<std::string> FileUtils::getMediaFilesRecursive(const std::string& rootPath) {
-    std::vector<std::string> mediaFiles;
-    
-    try {
-        // Create a path object
-        std::filesystem::path fsRootPath(rootPath);
-        
-        // Check if the path exists and is a directory
-        if (!std::filesystem::exists(fsRootPath) || !std::filesystem::is_directory(fsRootPath)) {
-            std::cerr << "Error: Path is not a valid directory: " << rootPath << std::endl;
-            return mediaFiles; // Return empty vector
+    // Hidden directories (.git, .Trash-1000, .Spotlight-V100, ...) and OS bookkeeping folders
+    bool isPrunedDirectory(const char* name) {
+        if (name[0] == '.') return true;
+        return std::strcmp(name, "System Volume Information") == 0 ||
+               std::strcmp(name, "$RECYCLE.BIN") == 0 ||
+               std::strcmp(name, "lost+found") == 0;
+    }
+
+    // First line of a sysfs attribute of the block device, or of its parent disk for a partition
+    std::string readBlockAttribute(const fs::path& device, const char* name) {
+        for (const fs::path& dir : { device, device.parent_path() }) {
+            std::ifstream in(dir / name);
+            std::string value;
+            if (in && std::getline(in, value)) return value;
         }
+        return "";
+    }
+
+    struct linux_dirent64 {
+        ino64_t d_ino;
+        off64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[];
+    };
+
+    // Open directory fd shared with child tasks, so they can openat() relative to it
+    struct DirHandle {
+        int fd;
+        static std::atomic<int> liveCount;
+        explicit DirHandle(int fd) : fd(fd) { ++liveCount; }
+        ~DirHandle() { close(fd); --liveCount; }
+    };
+    std::atomic<int> DirHandle::liveCount(0);
+
+    // Parent fds kept open for openat(); above this children fall back to full-path opens
+    const int MAX_RETAINED_DIR_FDS = 128;
+
+    // One directory's results. Children are spliced in at the position they were
+    // found, so flattening gives the same pre-order as a serial depth-first walk.
+    struct DirNode {
+        const DirNode* parent = nullptr;
+        bool identified = false; // dev/ino are known
+        dev_t dev = 0;
+        ino_t ino = 0;
+        std::vector<std::string> files;
+        std::vector<std::pair<size_t, std::unique_ptr<DirNode>>> children;
+    };
+
+    class DirectoryWalker {
+    public:
+        DirectoryWalker(size_t threads, const std::atomic<bool>* cancelled) : pool(threads), cancelled(cancelled) {}
+
+        std::vector<std::string> walk(const std::string& rootPath) {
+            DirNode root;
+            std::string base = rootPath;
+            while (base.size() > 1 && base.back() == '/') base.pop_back();
+
+            pool.enqueue([this, &root, base]() { processDirectory(&root, base, nullptr, base); });
+            pool.waitIdle();
+
+            std::vector<std::string> out;
+            DevInoSet seen;
+            flatten(root, out, seen);
+            return out;
+        }
+
+    private:
+        void processDirectory(DirNode* node, std::string dirPath, std::shared_ptr<DirHandle> parent, std::string name) {
+            if (isCancelled()) return; // Queued directories drain without being opened
+            int fd = parent ? openat(parent->fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+                            : open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            parent.reset(); // Release the parent fd as early as possible
+            if (fd < 0) {
+                std::cerr << "FileUtils Warning: Cannot open directory " << dirPath << ": " << strerror(errno) << std::endl;
+                return;
+            }
+            auto handle = std::make_shared<DirHandle>(fd);
+
+            // A directory reached again below itself is a symlink loop. Other repeats
+            // (sibling links to one directory) are walked and dropped by flatten(), so
+            // which path is kept does not depend on which thread got there first.
+            struct stat st;
+            if (fstat(fd, &st) == 0) {
+                for (const DirNode* up = node->parent; up; up = up->parent) {
+                    if (up->identified && up->dev == st.st_dev && up->ino == st.st_ino) return;
+                }
+                node->dev = st.st_dev;
+                node->ino = st.st_ino;
+                node->identified = true;
+            }
+
+            alignas(linux_dirent64) char buffer[32 * 1024];
+            while (!isCancelled()) {
+                long nread = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+                if (nread < 0) {
+                    std::cerr << "FileUtils Warning: getdents64 failed on " << dirPath << ": " << strerror(errno) << std::endl;
+                    break;
+                }
+                if (nread == 0) break;
+
+                for (long pos = 0; pos < nread; ) {
+                    auto* entry = reinterpret_cast<linux_dirent64*>(buffer + pos);
+                    pos += entry->d_reclen;
 
-        // Use recursive_directory_iterator to scan all subdirectories
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(fsRootPath)) {
-            // Check if it's a regular file (not a directory, symlink, etc.)
-            if (entry.is_regular_file()) {
-                std::string pathString = entry.path().string();
-                if (isMediaFile(pathString)) {
-                    mediaFiles.push_back(pathString);
+                    const char* entryName = entry->d_name;
+                    if (entryName[0] == '.' && (entryName[1] == '\0' || (entryName[1] == '.' && entryName[2] == '\0'))) continue;
+
+                    unsigned char type = entry->d_type;
+                    if (type == DT_LNK || type == DT_UNKNOWN) {
+                        // Only these need a stat: follow the link / ask the filesystem
+                        struct stat target;
+                        if (fstatat(fd, entryName, &target, 0) != 0) continue; // Dangling link
+                        type = S_ISDIR(target.st_mode) ? DT_DIR : (S_ISREG(target.st_mode) ? DT_REG : DT_UNKNOWN);
+                    }
+
+                    if (type == DT_REG) {
+                        size_t len = std::strlen(entryName);
+                        if (entryName[0] == '.' && entryName[1] == '_') continue; // macOS AppleDouble junk
+                        if (hasMediaExtension(entryName, len)) {
+                            node->files.push_back(dirPath + "/" + entryName);
+                        }
+                    } else if (type == DT_DIR && !isPrunedDirectory(entryName)) {
+                        auto child = std::make_unique<DirNode>();
+                        child->parent = node;
+                        DirNode* childPtr = child.get();
+                        node->children.emplace_back(node->files.size(), std::move(child));
+
+                        std::shared_ptr<DirHandle> retained =
+                            DirHandle::liveCount < MAX_RETAINED_DIR_FDS ? handle : nullptr;
+                        std::string childPath = dirPath + "/" + entryName;
+                        std::string childName = entryName;
+                        pool.enqueue([this, childPtr, childPath, retained, childName]() {
+                            processDirectory(childPtr, childPath, retained, childName);
+                        });
+                    }
                 }
             }
         }
-    } catch (std::filesystem::filesystem_error& e) {
-        std::cerr << "Filesystem error: " << e.what() << std::endl;
-    } catch (std::exception& e) {
-        std::cerr << "An unexpected error occurred: " << e.what() << std::endl;
+
+        bool isCancelled() const {
+            return cancelled && cancelled->load(std::memory_order_relaxed);
+        }
+
+        struct DevInoHash {
+            size_t operator()(const std::pair<dev_t, ino_t>& key) const {
+                return std::hash<unsigned long long>()(key.first) * 31 + std::hash<unsigned long long>()(key.second);
+            }
+        };
+        using DevInoSet = std::unordered_set<std::pair<dev_t, ino_t>, DevInoHash>;
+
+        // Each physical directory is listed once, at its first place in depth-first order
+        static void flatten(DirNode& node, std::vector<std::string>& out, DevInoSet& seen) {
+            if (node.identified && !seen.insert({ node.dev, node.ino }).second) return;
+            size_t next = 0;
+            for (auto& [position, child] : node.children) {
+                for (; next < position; ++next) out.push_back(std::move(node.files[next]));
+                flatten(*child, out, seen);
+            }
+            for (; next < node.files.size(); ++next) out.push_back(std::move(node.files[next]));
+        }
+
+        ThreadPool pool;
+        const std::atomic<bool>* cancelled; // Optional
+    };
+} 
+
+bool FileUtils::isMediaFile(const std::string& filePath) {
+    return hasMediaExtension(filePath.c_str(), filePath.size());
+}
+
+std::vector<std::string> FileUtils::getMediaFilesRecursive(const std::string& rootPath, int threads,
+                                                          const std::atomic<bool>* cancelled) {
+    struct stat st;
+    if (stat(rootPath.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        std::cerr << "Error: Path is not a valid directory: " << rootPath << std::endl;
+        return {};
     }
 
-    return mediaFiles;
+    // Directory reads are mostly I/O latency (especially on USB), so more walkers than cores still help
+    size_t walkerThreads = threads > 0 ? threads : std::max<size_t>(4, ThreadPool::defaultThreadCount());
+    DirectoryWalker walker(walkerThreads, cancelled);
+    return walker.walk(rootPath);
 }
 
 fs::path FileUtils::getProjectRootPath() {
@@ -76,4 +248,69 @@ fs::path FileUtils::getProjectRootPath() {
     fs::path exePath(result);
     
     return exePath.parent_path().parent_path(); 
-}
\ No newline at end of file
+}
+
+bool FileUtils::getFileStat(const std::string& filePath, long long& sizeInBytes, long long& mtimeNs) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+    sizeInBytes = static_cast<long long>(st.st_size);
+    mtimeNs = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+int FileUtils::getReaderThreadCount(const std::string& path) {
+    const int SLOW_DEVICE_READERS = 2;
+    int defaultCount = static_cast<int>(ThreadPool::defaultThreadCount());
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return defaultCount;
+
+    std::error_code ec;
+    fs::path device = fs::canonical("/sys/dev/block/" + std::to_string(major(st.st_dev)) + ":"
+                                    + std::to_string(minor(st.st_dev)), ec);
+    if (ec) return defaultCount; // Not a block device (tmpfs, network, overlay, ...)
+    if (readBlockAttribute(device, "queue/rotational") == "1" || readBlockAttribute(device, "removable") == "1") {
+        return std::min(SLOW_DEVICE_READERS, defaultCount);
+    }
+    return defaultCount;
+}
+
+bool FileUtils::writeFileAtomically(const std::string& filePath, const std::string& contents) {
+    return writeFileAtomically(filePath, [&contents](std::ostream& out) { out.write(contents.data(), contents.size()); });
+}
+
+bool FileUtils::writeFileAtomically(const std::string& filePath, const std::function<void(std::ostream&)>& writeContents,
+                                    unsigned long long* bytesWritten) {
+    std::string tempPath = filePath + ".tmp";
+    std::error_code ec;
+    fs::path p(filePath);
+    if (p.has_parent_path()) fs::create_directories(p.parent_path(), ec);
+
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "FileUtils Error: Could not open " << tempPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    try {
+        writeContents(out);
+    } catch (...) {
+        out.close();
+        unlink(tempPath.c_str());
+        throw;
+    }
+    std::streamoff size = out.tellp();
+    out.close();
+    bool ok = static_cast<bool>(out);
+    // The data must be on disk before the rename makes it the file, or a crash can leave it empty
+    int fd = ok ? open(tempPath.c_str(), O_RDONLY | O_CLOEXEC) : -1;
+    ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    if (!ok || rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        std::cerr << "FileUtils Error: Failed writing " << filePath << ": " << std::strerror(errno) << std::endl;
+        unlink(tempPath.c_str());
+        return false;
+    }
+    if (bytesWritten) *bytesWritten = static_cast<unsigned long long>(size);
+    return true;
+}
@@ -1,10 +1,28 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <atomic>
+#include <functional>
+#include <ostream>
 #include <filesystem>
 namespace fs = std::filesystem;
 namespace FileUtils {
-    std::vector<std::string> getMediaFilesRecursive(const std::string& rootPath);
+    // Parallel getdents64 walk. Skips hidden/system directories, follows directory
+    // symlinks once per (dev, inode). Order matches a serial depth-first walk.
+    // Setting '*cancelled' stops the walk early, with what was found so far.
+    std::vector<std::string> getMediaFilesRecursive(const std::string& rootPath, int threads = 0,
+                                                    const std::atomic<bool>* cancelled = nullptr);
     bool isMediaFile(const std::string& filePath);
     fs::path getProjectRootPath();
+    // Size in bytes and modification time (ns since epoch) from a single stat() call
+    bool getFileStat(const std::string& filePath, long long& sizeInBytes, long long& mtimeNs);
+    // Tag-reading threads that suit the disk holding 'path' (from sysfs): two for spinning
+    // and removable disks, where parallel reads mostly add seeks, one per core otherwise
+    int getReaderThreadCount(const std::string& path);
+    // Writes beside the target, syncs, and renames over it: readers (and a crash) see
+    // either the old file or the new one, never a truncated one
+    bool writeFileAtomically(const std::string& filePath, const std::string& contents);
+    // Same, with the contents streamed out by 'writeContents' (exceptions from it are rethrown)
+    bool writeFileAtomically(const std::string& filePath, const std::function<void(std::ostream&)>& writeContents,
+                             unsigned long long* bytesWritten = nullptr);
 }
\ No newline at end of file
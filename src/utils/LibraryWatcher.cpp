@@ -0,0 +1,212 @@
+#include "utils/LibraryWatcher.h"
+#include "utils/FileUtils.h"
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <map>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+    // How long an unpaired IN_MOVED_FROM waits for its IN_MOVED_TO (at least until the next poll)
+    const auto MOVE_PAIR_TIMEOUT = std::chrono::milliseconds(200);
+
+    bool isUnder(const std::string& path, const std::string& dir) {
+        return path.size() > dir.size() && path.compare(0, dir.size(), dir) == 0 && path[dir.size()] == '/';
+    }
+}
+
+LibraryWatcher::LibraryWatcher() : inotifyFd(-1) {}
+
+LibraryWatcher::~LibraryWatcher() {
+    if (inotifyFd >= 0) {
+        close(inotifyFd); // Also drops every watch
+    }
+}
+
+bool LibraryWatcher::init() {
+    if (inotifyFd >= 0) return true;
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        std::cerr << "LibraryWatcher Error: inotify_init1 failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LibraryWatcher::addRoot(const std::string& rootPath) {
+    if (inotifyFd < 0 && !init()) return false;
+    if (isWatching(rootPath)) return true;
+
+    std::error_code ec;
+    if (!fs::is_directory(rootPath, ec)) {
+        std::cerr << "LibraryWatcher Error: Not a directory: " << rootPath << std::endl;
+        return false;
+    }
+
+    roots.push_back(rootPath);
+    addWatchRecursive(rootPath, nullptr);
+    std::cout << "LibraryWatcher: Watching " << rootPath << " (" << watchDirs.size() << " directories total)" << std::endl;
+    return true;
+}
+
+void LibraryWatcher::removeRoot(const std::string& rootPath) {
+    auto it = std::find(roots.begin(), roots.end(), rootPath);
+    if (it == roots.end()) return;
+    roots.erase(it);
+
+    for (auto m = pendingMoves.begin(); m != pendingMoves.end(); ) {
+        m = isUnder(m->second.path, rootPath) ? pendingMoves.erase(m) : std::next(m);
+    }
+    for (auto w = watchDirs.begin(); w != watchDirs.end(); ) {
+        if (w->second == rootPath || isUnder(w->second, rootPath)) {
+            inotify_rm_watch(inotifyFd, w->first);
+            w = watchDirs.erase(w);
+        } else {
+            ++w;
+        }
+    }
+    std::cout << "LibraryWatcher: Stopped watching " << rootPath << std::endl;
+}
+
+bool LibraryWatcher::isWatching(const std::string& rootPath) const {
+    return std::find(roots.begin(), roots.end(), rootPath) != roots.end();
+}
+
+void LibraryWatcher::addWatchRecursive(const std::string& dirPath, std::vector<LibraryEvent>* newFiles) {
+    int wd = inotify_add_watch(inotifyFd, dirPath.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        std::cerr << "LibraryWatcher Warning: Cannot watch " << dirPath << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    watchDirs[wd] = dirPath;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(dirPath, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code typeEc;
+        if (it->is_symlink(typeEc)) continue;
+        if (it->is_directory(typeEc)) {
+            addWatchRecursive(it->path().string(), newFiles);
+        } else if (newFiles && it->is_regular_file(typeEc) && FileUtils::isMediaFile(it->path().string())) {
+            // Files that landed before the watch existed would otherwise be missed
+            newFiles->push_back({ LibraryEvent::FILE_CHANGED, it->path().string(), "" });
+        }
+    }
+}
+
+void LibraryWatcher::removeWatchesUnder(const std::string& dirPath) {
+    for (auto w = watchDirs.begin(); w != watchDirs.end(); ) {
+        if (w->second == dirPath || isUnder(w->second, dirPath)) {
+            inotify_rm_watch(inotifyFd, w->first);
+            w = watchDirs.erase(w);
+        } else {
+            ++w;
+        }
+    }
+}
+
+void LibraryWatcher::renameWatchesUnder(const std::string& oldDir, const std::string& newDir) {
+    for (auto& [wd, path] : watchDirs) {
+        if (path == oldDir) {
+            path = newDir;
+        } else if (isUnder(path, oldDir)) {
+            path = newDir + path.substr(oldDir.size());
+        }
+    }
+}
+
+void LibraryWatcher::reportMovedOut(const std::string& path, bool isDir, std::vector<LibraryEvent>& events) {
+    if (isDir) {
+        removeWatchesUnder(path);
+        events.push_back({ LibraryEvent::DIR_DELETED, path, "" });
+    } else if (FileUtils::isMediaFile(path)) {
+        events.push_back({ LibraryEvent::FILE_DELETED, path, "" });
+    }
+}
+
+std::vector<LibraryEvent> LibraryWatcher::poll() {
+    std::vector<LibraryEvent> events;
+    if (inotifyFd < 0) return events;
+
+    const auto now = std::chrono::steady_clock::now();
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while (true) {
+        ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0) break; // EAGAIN: queue drained
+
+        for (char* ptr = buffer; ptr < buffer + len; ) {
+            auto* ev = reinterpret_cast<struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                events.push_back({ LibraryEvent::QUEUE_OVERFLOW, "", "" });
+                continue;
+            }
+
+            auto dirIt = watchDirs.find(ev->wd);
+            if (dirIt == watchDirs.end()) continue;
+
+            if (ev->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                if (ev->mask & IN_IGNORED) watchDirs.erase(dirIt);
+                continue;
+            }
+            if (ev->len == 0) continue;
+
+            std::string path = dirIt->second + "/" + ev->name;
+            bool isDir = (ev->mask & IN_ISDIR) != 0;
+
+            if (ev->mask & IN_MOVED_FROM) {
+                pendingMoves[ev->cookie] = { path, isDir, now, false };
+            } else if (ev->mask & IN_MOVED_TO) {
+                auto from = pendingMoves.find(ev->cookie);
+                if (from != pendingMoves.end()) {
+                    if (isDir) {
+                        renameWatchesUnder(from->second.path, path);
+                        events.push_back({ LibraryEvent::DIR_RENAMED, path, from->second.path });
+                    } else if (FileUtils::isMediaFile(path) || FileUtils::isMediaFile(from->second.path)) {
+                        events.push_back({ LibraryEvent::FILE_RENAMED, path, from->second.path });
+                    }
+                    pendingMoves.erase(from);
+                } else if (isDir) {
+                    addWatchRecursive(path, &events); // Moved in from outside the tree
+                } else if (FileUtils::isMediaFile(path)) {
+                    events.push_back({ LibraryEvent::FILE_CHANGED, path, "" });
+                }
+            } else if (ev->mask & IN_CREATE) {
+                // Files are reported on IN_CLOSE_WRITE once fully written; only new dirs matter here
+                if (isDir) addWatchRecursive(path, &events);
+            } else if (ev->mask & IN_CLOSE_WRITE) {
+                if (FileUtils::isMediaFile(path)) {
+                    events.push_back({ LibraryEvent::FILE_CHANGED, path, "" });
+                }
+            } else if (ev->mask & IN_DELETE) {
+                if (isDir) {
+                    removeWatchesUnder(path);
+                    events.push_back({ LibraryEvent::DIR_DELETED, path, "" });
+                } else if (FileUtils::isMediaFile(path)) {
+                    events.push_back({ LibraryEvent::FILE_DELETED, path, "" });
+                }
+            }
+        }
+    }
+
+    // Unmatched ones are moves out of the tree, once their other half had time to arrive
+    for (auto m = pendingMoves.begin(); m != pendingMoves.end(); ) {
+        if (m->second.heldOver && now - m->second.since >= MOVE_PAIR_TIMEOUT) {
+            reportMovedOut(m->second.path, m->second.isDir, events);
+            m = pendingMoves.erase(m);
+        } else {
+            m->second.heldOver = true;
+            ++m;
+        }
+    }
+
+    return events;
+}
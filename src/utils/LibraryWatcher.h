@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+struct LibraryEvent {
+    enum EventType {
+        FILE_CHANGED,   // Created, moved in or rewritten (closed after writing)
+        FILE_DELETED,   // Deleted or moved out of the watched tree
+        FILE_RENAMED,   // Moved within the watched tree: oldPath -> path
+        DIR_DELETED,    // Directory removed; everything under 'path' is gone
+        DIR_RENAMED,    // Directory moved within the tree: oldPath -> path
+        QUEUE_OVERFLOW        // Kernel queue overflowed, events were lost; rescan needed
+    };
+
+    EventType type;
+    std::string path;
+    std::string oldPath;
+};
+
+// Recursive inotify watcher for library roots. poll() never blocks, so it can be
+// called from the UI loop; events are only reported for media files (and directories).
+// A move out of a watched directory is held for a short while for the other half of the
+// rename, which may only arrive by the next poll; if none does, it is reported as deleted.
+class LibraryWatcher {
+public:
+    LibraryWatcher();
+    ~LibraryWatcher();
+
+    bool init();
+    bool addRoot(const std::string& rootPath);
+    void removeRoot(const std::string& rootPath);
+    bool isWatching(const std::string& rootPath) const;
+
+    std::vector<LibraryEvent> poll();
+
+private:
+    void addWatchRecursive(const std::string& dirPath, std::vector<LibraryEvent>* newFiles);
+    void removeWatchesUnder(const std::string& dirPath);
+    void renameWatchesUnder(const std::string& oldDir, const std::string& newDir);
+    void reportMovedOut(const std::string& path, bool isDir, std::vector<LibraryEvent>& events);
+
+    // IN_MOVED_FROM waiting for the IN_MOVED_TO with the same cookie
+    struct PendingMove {
+        std::string path;
+        bool isDir;
+        std::chrono::steady_clock::time_point since;
+        bool heldOver; // Already kept through the end of one poll
+    };
+
+    int inotifyFd;
+    std::map<uint32_t, PendingMove> pendingMoves;
+    std::unordered_map<int, std::string> watchDirs; // watch descriptor -> directory path
+    std::vector<std::string> roots;
+};
@@ -0,0 +1,66 @@
+#include "utils/ScanScheduler.h"
+#include <chrono>
+
+void ScanScheduler::setPriority(const void* owner, ScanPriority priority) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        owners[owner].priority = priority;
+    }
+    changed.notify_all();
+}
+
+ScanPriority ScanScheduler::getPriority(const void* owner) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = owners.find(owner);
+    return it != owners.end() ? it->second.priority : ScanPriority::NORMAL;
+}
+
+void ScanScheduler::removeOwner(const void* owner) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        owners.erase(owner);
+    }
+    changed.notify_all();
+}
+
+void ScanScheduler::beginScan(const void* owner) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++owners[owner].runningScans;
+}
+
+void ScanScheduler::endScan(const void* owner) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = owners.find(owner);
+        if (it != owners.end() && it->second.runningScans > 0) --it->second.runningScans;
+    }
+    changed.notify_all();
+}
+
+bool ScanScheduler::mustWait(const void* owner) const {
+    auto self = owners.find(owner);
+    ScanPriority mine = self != owners.end() ? self->second.priority : ScanPriority::NORMAL;
+    for (const auto& [other, state] : owners) {
+        if (other != owner && state.runningScans > 0 && state.priority > mine) return true;
+    }
+    return false;
+}
+
+bool ScanScheduler::waitTurn(const void* owner, const std::atomic<bool>& cancelled) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!mustWait(owner)) return !cancelled;
+
+    ++owners[owner].waitingReaders;
+    // Cancelling does not notify us: look at the flag a few times a second
+    while (!cancelled && mustWait(owner)) {
+        changed.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    --owners[owner].waitingReaders;
+    return !cancelled;
+}
+
+bool ScanScheduler::isWaiting(const void* owner) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = owners.find(owner);
+    return it != owners.end() && it->second.waitingReaders > 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+// Which library's scan gets the disk and CPU when several run at once
+enum class ScanPriority { BACKGROUND, NORMAL, FOREGROUND };
+
+// Shared by the scan workers of several libraries (owners: any stable address, in
+// practice the MediaManager). Before reading a file, a worker asks for its turn and
+// waits while an owner of higher priority has a scan running, so the library on screen
+// is read first; the others carry on as soon as it is done or loses its priority.
+// Cooperative: nothing is interrupted in the middle of a file.
+class ScanScheduler {
+public:
+    void setPriority(const void* owner, ScanPriority priority);
+    ScanPriority getPriority(const void* owner) const;
+    void removeOwner(const void* owner); // Before the owner goes; it must have no scan running
+
+    void beginScan(const void* owner); // Called by each scan worker around its work
+    void endScan(const void* owner);
+
+    // Blocks while a scan of higher priority runs. False if 'cancelled' was set meanwhile.
+    bool waitTurn(const void* owner, const std::atomic<bool>& cancelled);
+    bool isWaiting(const void* owner) const; // Some worker of 'owner' is held back right now
+
+private:
+    struct OwnerState {
+        ScanPriority priority = ScanPriority::NORMAL;
+        int runningScans = 0;
+        int waitingReaders = 0;
+    };
+
+    bool mustWait(const void* owner) const; // With 'mutex' held
+
+    std::map<const void*, OwnerState> owners;
+    mutable std::mutex mutex;
+    std::condition_variable changed; // A scan ended or a priority changed
+};
@@ -0,0 +1,31 @@
+#include "utils/StringPool.h"
+
+StringPool& StringPool::shared() {
+    static StringPool pool;
+    return pool;
+}
+
+const std::string* StringPool::empty() {
+    static const std::string emptyString;
+    return &emptyString;
+}
+
+const std::string* StringPool::intern(std::string_view value) {
+    if (value.empty()) return empty();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = lookup.find(value);
+    if (it != lookup.end()) {
+        return it->second;
+    }
+
+    storage.emplace_back(value);
+    const std::string* stored = &storage.back();
+    lookup.emplace(std::string_view(*stored), stored);
+    return stored;
+}
+
+size_t StringPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return storage.size();
+}
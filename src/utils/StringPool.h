@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+
+// Process-wide interning for strings that repeat across the library (artists,
+// albums, genres, tag keys). Interned strings are never freed, and the returned
+// pointers stay valid for the lifetime of the program. Thread-safe.
+class StringPool {
+public:
+    static StringPool& shared();
+
+    const std::string* intern(std::string_view value);
+    static const std::string* empty();
+
+    size_t size() const;
+
+private:
+    StringPool() = default;
+
+    mutable std::mutex mutex;
+    std::deque<std::string> storage; // Deque: push_back never moves existing strings
+    std::unordered_map<std::string_view, const std::string*> lookup;
+};
@@ -19,14 +19,22 @@ namespace {
                        [](unsigned char c){ return std::tolower(c); });
         return s;
     }
+
+    bool isStandardKey(const std::string& key) {
+        return key == "title" || key == "artist" || key == "album" || key == "genre" ||
+               key == "date" || key == "year" || key == "tracknumber";
+    }
 }
 
 TagLibWrapper::TagLibWrapper() {}
 
 TagLibWrapper::~TagLibWrapper() {}
 
-std::unique_ptr<Metadata> TagLibWrapper::readTags(const std::string& filePath) {
-    TagLib::FileRef f(filePath.c_str());
+std::unique_ptr<Metadata> TagLibWrapper::readTags(const std::string& filePath, ScanProfile profile) {
+    TagLib::AudioProperties::ReadStyle style = TagLib::AudioProperties::Average;
+    if (profile == ScanProfile::FAST) style = TagLib::AudioProperties::Fast;
+    if (profile == ScanProfile::ACCURATE) style = TagLib::AudioProperties::Accurate;
+    TagLib::FileRef f(filePath.c_str(), true, style);
 
     if (f.isNull()) {
         std::cerr << "TagLibWrapper: Could not read file: " << filePath << std::endl;
@@ -43,6 +51,7 @@ std::unique_ptr<Metadata> TagLibWrapper::readTags(const std::string& filePath) {
 
     // --- Fill common Metadata fields ---
     meta->fileSizeInBytes = f.file()->length();
+    meta->estimated = profile == ScanProfile::FAST;
     
     if(f.tag()) { // Check if tag exists
         TagLib::Tag* tag = f.tag();
@@ -60,27 +69,26 @@ std::unique_ptr<Metadata> TagLibWrapper::readTags(const std::string& filePath) {
         meta->durationInSeconds = f.audioProperties()->lengthInSeconds();
     }
 
-    // --- Fill map 'fields' using setField ---
+    // --- Standard tags go to typed fields, the rest to the sorted extras ---
     if (f.tag()) {
+        meta->setArtist(f.tag()->artist().toCString(true));
+        meta->setAlbum(f.tag()->album().toCString(true));
+        meta->setGenre(f.tag()->genre().toCString(true));
+        meta->setYear(static_cast<int>(f.tag()->year()));
+        meta->setTrackNumber(static_cast<int>(f.tag()->track()));
+    }
+
+    // The full property map means walking every frame/comment; FAST leaves it for later
+    if (f.tag() && profile != ScanProfile::FAST) {
         TagLib::PropertyMap allTags = f.tag()->properties();
-        
-        // Use setField for standard fields to ensure map is populated
-        meta->setField("artist", f.tag()->artist().toCString(true));
-        meta->setField("album", f.tag()->album().toCString(true));
-        meta->setField("genre", f.tag()->genre().toCString(true));
-        meta->setField("year", std::to_string(f.tag()->year())); // Convert year to string
-
-        // Add any other properties found
         for(auto const& [key, valList] : allTags) {
             if (!valList.isEmpty()) {
                 // Convert key to lowercase to be consistent (e.g., "ARTIST" -> "artist")
                 std::string lKey = toLower(key.toCString(true));
-                
-                // Only add if we haven't already set it (optional)
-                if (meta->getField(lKey).empty()) { 
-                    std::string lVal = valList.front().toCString(true);
-                    meta->setField(lKey, lVal);
-                }
+
+                // Already covered by the typed fields (DATE is what year() is read from)
+                if (isStandardKey(lKey)) continue;
+                meta->setField(lKey, valList.front().toCString(true));
             }
         }
     }
@@ -88,11 +96,31 @@ std::unique_ptr<Metadata> TagLibWrapper::readTags(const std::string& filePath) {
     return meta; // Return the new object
 }
 
-bool TagLibWrapper::writeTags(const std::string& filePath, Metadata* metadata) {
+unsigned TagLibWrapper::changedFields(const Metadata& before, const Metadata& after) {
+    unsigned fields = 0;
+    if (before.title != after.title) fields |= TITLE;
+    if (before.getArtist() != after.getArtist()) fields |= ARTIST;
+    if (before.getAlbum() != after.getAlbum()) fields |= ALBUM;
+    if (before.getGenre() != after.getGenre()) fields |= GENRE;
+    if (before.getYear() != after.getYear()) fields |= YEAR;
+    return fields;
+}
+
+const char* TagLibWrapper::getScanProfileName(ScanProfile profile) {
+    switch (profile) {
+        case ScanProfile::FAST: return "Fast";
+        case ScanProfile::BALANCED: return "Balanced";
+        case ScanProfile::ACCURATE: return "Accurate";
+    }
+    return "";
+}
+
+bool TagLibWrapper::writeTags(const std::string& filePath, const Metadata* metadata, unsigned fields) {
     if (metadata == nullptr) {
         std::cerr << "TagLibWrapper Error: Cannot write null metadata." << std::endl;
         return false;
     }
+    if ((fields & ALL_FIELDS) == 0) return true; // Nothing changed; saving would still rewrite the file
 
     TagLib::FileRef f(filePath.c_str());
     if (f.isNull() || !f.tag()) {
@@ -102,22 +130,11 @@ bool TagLibWrapper::writeTags(const std::string& filePath, Metadata* metadata) {
 
     TagLib::Tag *tag = f.tag();
 
-    tag->setTitle(TagLib::String(metadata->title, TagLib::String::UTF8));
-    tag->setArtist(TagLib::String(metadata->getField("artist"), TagLib::String::UTF8));
-    tag->setAlbum(TagLib::String(metadata->getField("album"), TagLib::String::UTF8));
-    tag->setGenre(TagLib::String(metadata->getField("genre"), TagLib::String::UTF8));
-    
-    // Convert year from string back to uint
-    try {
-        std::string yearStr = metadata->getField("year");
-        if (yearStr.empty()) {
-            tag->setYear(0);
-        } else {
-            tag->setYear(std::stoi(yearStr));
-        }
-    } catch (...) {
-        tag->setYear(0); // Set to 0 if conversion fails
-    }
+    if (fields & TITLE) tag->setTitle(TagLib::String(metadata->title, TagLib::String::UTF8));
+    if (fields & ARTIST) tag->setArtist(TagLib::String(metadata->getArtist(), TagLib::String::UTF8));
+    if (fields & ALBUM) tag->setAlbum(TagLib::String(metadata->getAlbum(), TagLib::String::UTF8));
+    if (fields & GENRE) tag->setGenre(TagLib::String(metadata->getGenre(), TagLib::String::UTF8));
+    if (fields & YEAR) tag->setYear(std::max(0, metadata->getYear()));
 
     if (f.save()) {
         std::cout << "TagLibWrapper: Metadata saved successfully for: " << filePath << std::endl;
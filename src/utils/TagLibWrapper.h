@@ -3,11 +3,25 @@
 #include <memory>
 #include "model/Metadata.h"
 
+// How much of a file readTags() reads.
+//  FAST:     duration from the first frame headers (an estimate for VBR files without a
+//            Xing/VBRI header), standard tags only; the result is marked 'estimated'
+//  BALANCED: TagLib's default; every tag
+//  ACCURATE: exact duration (may read the whole stream); every tag
+enum class ScanProfile { FAST, BALANCED, ACCURATE };
+
 class TagLibWrapper {
 public:
     TagLibWrapper();
     ~TagLibWrapper();
 
-    std::unique_ptr<Metadata> readTags(const std::string& filePath);
-    bool writeTags(const std::string& filePath, Metadata* metadata);
+    std::unique_ptr<Metadata> readTags(const std::string& filePath, ScanProfile profile = ScanProfile::BALANCED);
+    // The fields writeTags() can write, as a mask
+    enum TagFields : unsigned { TITLE = 1, ARTIST = 2, ALBUM = 4, GENRE = 8, YEAR = 16, ALL_FIELDS = 31 };
+
+    // Writes the fields in 'fields' only; the file is not touched if that is 0
+    bool writeTags(const std::string& filePath, const Metadata* metadata, unsigned fields = ALL_FIELDS);
+    static unsigned changedFields(const Metadata& before, const Metadata& after);
+
+    static const char* getScanProfileName(ScanProfile profile);
 };
\ No newline at end of file
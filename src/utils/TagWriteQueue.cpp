@@ -0,0 +1,167 @@
+#include "utils/TagWriteQueue.h"
+#include "utils/TagLibWrapper.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace {
+    bool isUnder(const std::string& path, const std::string& dirPath) {
+        if (dirPath.empty()) return true;
+        return path.size() > dirPath.size() && path.compare(0, dirPath.size(), dirPath) == 0
+            && (path[dirPath.size()] == '/' || dirPath.back() == '/');
+    }
+
+    // Only what writeTags() writes; the rest of the entry's metadata is not needed
+    std::unique_ptr<Metadata> copyTags(const Metadata& tags) {
+        auto copy = std::make_unique<Metadata>();
+        copy->title = tags.title;
+        copy->setArtist(tags.getArtist());
+        copy->setAlbum(tags.getAlbum());
+        copy->setGenre(tags.getGenre());
+        copy->setYear(tags.getYear());
+        return copy;
+    }
+
+    // Filesystem of 'path', or of its directory for a file that is not there (yet)
+    unsigned long long deviceOf(const std::string& path) {
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) return static_cast<unsigned long long>(st.st_dev);
+        size_t slash = path.find_last_of('/');
+        if (slash != std::string::npos && slash > 0 && stat(path.substr(0, slash).c_str(), &st) == 0) {
+            return static_cast<unsigned long long>(st.st_dev);
+        }
+        return 0;
+    }
+}
+
+TagWriteQueue::TagWriteQueue(TagLibWrapper* tagUtil, size_t threadCount, int defaultDeviceLimit)
+    : tagUtil(tagUtil), defaultDeviceLimit(std::max(1, defaultDeviceLimit)), stopping(false)
+{
+    workers.reserve(std::max<size_t>(1, threadCount));
+    for (size_t i = 0; i < std::max<size_t>(1, threadCount); ++i) {
+        workers.emplace_back(&TagWriteQueue::worker, this);
+    }
+}
+
+TagWriteQueue::~TagWriteQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true; // The workers drain the queue before they return
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void TagWriteQueue::setDeviceLimit(const std::string& path, int limit) {
+    DeviceId device = deviceOf(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        deviceLimits[device] = std::max(1, limit);
+    }
+    wake.notify_all(); // A raised limit may let waiting jobs start
+}
+
+bool TagWriteQueue::enqueue(const std::string& path, const Metadata& tags, unsigned fields) {
+    fields &= TagLibWrapper::ALL_FIELDS;
+    if (fields == 0) return false;
+
+    std::unique_ptr<Metadata> copy = copyTags(tags);
+    DeviceId device = deviceOf(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // A write already running for this path has read its values; only a waiting one can absorb this
+        auto it = std::find_if(queue.begin(), queue.end(), [&path](const Job& job) { return job.path == path; });
+        if (it != queue.end()) {
+            it->tags = std::move(copy);
+            it->fields |= fields;
+            return true;
+        }
+        queue.push_back({ path, std::move(copy), fields, device });
+    }
+    wake.notify_one();
+    return true;
+}
+
+void TagWriteQueue::flush(const std::string& dirPath) {
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.wait(lock, [this, &dirPath] { return !hasJobUnder(dirPath); });
+}
+
+bool TagWriteQueue::hasJobUnder(const std::string& dirPath) const {
+    for (const auto& running : runningPaths) {
+        if (isUnder(running, dirPath)) return true;
+    }
+    return std::any_of(queue.begin(), queue.end(), [&dirPath](const Job& job) { return isUnder(job.path, dirPath); });
+}
+
+std::vector<TagWriteQueue::Result> TagWriteQueue::takeResults() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Result> finished;
+    finished.swap(results);
+    return finished;
+}
+
+size_t TagWriteQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + runningPaths.size();
+}
+
+bool TagWriteQueue::isPending(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isRunning(path)) return true;
+    return std::any_of(queue.begin(), queue.end(), [&path](const Job& job) { return job.path == path; });
+}
+
+bool TagWriteQueue::isRunning(const std::string& path) const {
+    return std::find(runningPaths.begin(), runningPaths.end(), path) != runningPaths.end();
+}
+
+int TagWriteQueue::getPeakRunning(const std::string& path) const {
+    DeviceId device = deviceOf(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = peakPerDevice.find(device);
+    return it != peakPerDevice.end() ? it->second : 0;
+}
+
+int TagWriteQueue::deviceLimit(DeviceId device) const {
+    auto it = deviceLimits.find(device);
+    return it != deviceLimits.end() ? it->second : defaultDeviceLimit;
+}
+
+std::deque<TagWriteQueue::Job>::iterator TagWriteQueue::findRunnable() {
+    return std::find_if(queue.begin(), queue.end(), [this](const Job& job) {
+        auto running = runningPerDevice.find(job.device);
+        int busy = running != runningPerDevice.end() ? running->second : 0;
+        return busy < deviceLimit(job.device) && !isRunning(job.path);
+    });
+}
+
+void TagWriteQueue::worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        std::deque<Job>::iterator next;
+        wake.wait(lock, [this, &next] {
+            next = findRunnable();
+            return next != queue.end() || (stopping && queue.empty());
+        });
+        if (next == queue.end()) return; // Stopping, and nothing left to write
+
+        Job job = std::move(*next);
+        queue.erase(next);
+        runningPaths.push_back(job.path);
+        int& peak = peakPerDevice[job.device];
+        peak = std::max(peak, ++runningPerDevice[job.device]);
+
+        lock.unlock();
+        bool ok = tagUtil->writeTags(job.path, job.tags.get(), job.fields);
+        lock.lock();
+
+        runningPaths.erase(std::find(runningPaths.begin(), runningPaths.end(), job.path));
+        if (--runningPerDevice[job.device] == 0) runningPerDevice.erase(job.device);
+        results.push_back({ std::move(job.path), job.fields, ok });
+        wake.notify_all(); // The device, or this file, is free for the next one
+        progress.notify_all();
+    }
+}
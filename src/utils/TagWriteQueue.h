@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "model/Metadata.h"
+
+class TagLibWrapper;
+
+// Writes tag edits on worker threads, so rewriting a large file on a slow stick does
+// not stall the UI. Writes start in the order they were queued, several at once, but
+// never more at a time on one filesystem than its device limit (flash sticks do
+// best with one), and never two to the same file. An edit to a file whose previous
+// edit is still waiting is merged into it: the file is saved once, with the union
+// of the changed fields and the latest values.
+class TagWriteQueue {
+public:
+    struct Result {
+        std::string path;
+        unsigned fields; // TagLibWrapper::TagFields written (or attempted)
+        bool ok;
+    };
+
+    explicit TagWriteQueue(TagLibWrapper* tagUtil, size_t threadCount = 4, int defaultDeviceLimit = 2);
+    ~TagWriteQueue(); // Finishes every queued write first
+
+    TagWriteQueue(const TagWriteQueue&) = delete;
+    TagWriteQueue& operator=(const TagWriteQueue&) = delete;
+
+    // Concurrent writes allowed on the filesystem holding 'path' (at least 1)
+    void setDeviceLimit(const std::string& path, int limit);
+
+    // Queues writing 'fields' of 'tags' (copied) to 'path'. False if 'fields' is 0.
+    bool enqueue(const std::string& path, const Metadata& tags, unsigned fields);
+
+    // Blocks until no write to a file under 'dirPath' is waiting or running
+    // (every file if empty). Used before unmounting a stick.
+    void flush(const std::string& dirPath = "");
+
+    std::vector<Result> takeResults(); // Finished writes since the last call, oldest first
+    size_t getPendingCount() const;    // Waiting plus running
+    bool isPending(const std::string& path) const;
+    int getPeakRunning(const std::string& path) const; // Most writes seen at once on the filesystem of 'path'
+
+private:
+    using DeviceId = unsigned long long; // st_dev
+
+    struct Job {
+        std::string path;
+        std::unique_ptr<Metadata> tags;
+        unsigned fields;
+        DeviceId device;
+    };
+
+    void worker();
+    // The rest are called with 'mutex' held
+    std::deque<Job>::iterator findRunnable(); // First waiting job its file and device allow
+    bool isRunning(const std::string& path) const;
+    int deviceLimit(DeviceId device) const;
+    bool hasJobUnder(const std::string& dirPath) const;
+
+    TagLibWrapper* tagUtil;
+    int defaultDeviceLimit;
+    std::deque<Job> queue;
+    std::vector<std::string> runningPaths;
+    std::map<DeviceId, int> runningPerDevice;
+    std::map<DeviceId, int> peakPerDevice;
+    std::map<DeviceId, int> deviceLimits; // Set by setDeviceLimit(); the rest use the default
+    std::vector<Result> results;
+    bool stopping;
+    mutable std::mutex mutex;
+    std::condition_variable wake; // A job was queued, or a running one finished
+    std::condition_variable progress; // A write finished
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,101 @@
+#include "utils/ThreadPool.h"
+#include <atomic>
+#include <algorithm>
+#include <iostream>
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : activeTasks(0), stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 2; // hardware_concurrency() may return 0 if unknown
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allIdle.wait(lock, [this]() { return tasks.empty() && activeTasks == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+
+    // One task per worker pulling indices from a shared counter keeps the queue
+    // bounded no matter how large 'count' is.
+    std::atomic<size_t> nextIndex(0);
+    size_t taskCount = std::min(count, workers.size());
+
+    for (size_t t = 0; t < taskCount; ++t) {
+        enqueue([&nextIndex, count, &fn]() {
+            size_t i;
+            while ((i = nextIndex.fetch_add(1)) < count) {
+                fn(i);
+            }
+        });
+    }
+    waitIdle();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++activeTasks;
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "ThreadPool Error: Task threw an exception: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "ThreadPool Error: Task threw an unknown exception." << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeTasks;
+            if (tasks.empty() && activeTasks == 0) {
+                allIdle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed-size worker pool. Tasks are run in FIFO order by whichever worker is free.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0); // 0 = defaultThreadCount()
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void enqueue(std::function<void()> task);
+    void waitIdle(); // Blocks until the queue is empty and no task is running
+
+    // Runs fn(0) .. fn(count - 1) across the workers and blocks until all are done.
+    // Each index is handed out exactly once, so fn may write to slot [i] of a result vector.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t getThreadCount() const;
+    static size_t defaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allIdle;
+    size_t activeTasks;
+    bool stopping;
+};
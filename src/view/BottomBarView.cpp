@@ -27,7 +27,7 @@ void BottomBarView::draw(bool hasFocus) {
     if (player != nullptr) {
         state = player->getState();
         if (state != PlayerState::STOPPED && player->getCurrentTrack()) {
-            title = player->getCurrentTrack()->getFileName();
+            title = std::string(player->getCurrentTrack()->getFileName());
             currentTime = player->getCurrentTime();
             totalTime = player->getTotalTime();
         }
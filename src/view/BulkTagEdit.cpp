@@ -0,0 +1,64 @@
+#include "view/BulkTagEdit.h"
+#include "model/Metadata.h"
+#include "utils/TagLibWrapper.h"
+
+BulkTagEdit::BulkTagEdit(const std::vector<const Metadata*>& targets) {
+    // Titles are per track, so they are not offered here
+    fields = {
+        { "Artist", "artist", TagLibWrapper::ARTIST, "" },
+        { "Album", "album", TagLibWrapper::ALBUM, "" },
+        { "Genre", "genre", TagLibWrapper::GENRE, "" },
+        { "Year", "year", TagLibWrapper::YEAR, "" },
+    };
+    if (targets.empty()) return;
+    for (auto& field : fields) {
+        field.value = targets.front()->getField(field.key);
+        for (const Metadata* target : targets) {
+            if (target->getField(field.key) != field.value) {
+                field.various = true;
+                field.value.clear();
+                break;
+            }
+        }
+    }
+}
+
+const std::vector<BulkTagEdit::Field>& BulkTagEdit::getFields() const {
+    return fields;
+}
+
+std::string BulkTagEdit::getDisplayValue(size_t index) const {
+    const Field& field = fields.at(index);
+    if (!field.edited) return field.various ? "(various)" : field.value;
+    return field.value.empty() ? "(cleared)" : field.value;
+}
+
+void BulkTagEdit::enter(size_t index, const std::string& typed) {
+    Field& field = fields.at(index);
+    if (field.various && typed.empty()) {
+        // Nothing typed over "(various)": back to each file's own value
+        field.value.clear();
+        field.edited = false;
+        return;
+    }
+    if (typed != field.value) { // Confirming a shared value unchanged is not an edit
+        field.value = typed;
+        field.edited = true;
+    }
+}
+
+void BulkTagEdit::clear(size_t index) {
+    Field& field = fields.at(index);
+    field.value.clear();
+    field.edited = true;
+}
+
+unsigned BulkTagEdit::apply(Metadata& changes) const {
+    unsigned edited = 0;
+    for (const auto& field : fields) {
+        if (!field.edited) continue;
+        changes.setField(field.key, field.value);
+        edited |= field.mask;
+    }
+    return edited;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class Metadata;
+
+// What the bulk tag editor shows and what it will write. Fields the files disagree on
+// start out as "(various)" and are only written if the user types a value over them,
+// or clears them on purpose: confirming "(various)" with ENTER leaves every file's
+// own value alone.
+class BulkTagEdit {
+public:
+    struct Field {
+        std::string label;
+        std::string key; // Metadata::getField() key
+        unsigned mask;   // TagLibWrapper::TagFields
+        std::string value;
+        bool various = false;
+        bool edited = false;
+    };
+
+    explicit BulkTagEdit(const std::vector<const Metadata*>& targets);
+
+    const std::vector<Field>& getFields() const;
+    std::string getDisplayValue(size_t field) const; // "(various)", "(cleared)" or the value
+
+    void enter(size_t field, const std::string& typed); // The line typed over the field
+    void clear(size_t field); // Empties the field in every file
+
+    // Fills the edited fields into 'changes'; their TagFields mask, 0 if none
+    unsigned apply(Metadata& changes) const;
+
+private:
+    std::vector<Field> fields;
+};
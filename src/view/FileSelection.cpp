@@ -0,0 +1,42 @@
+#include "view/FileSelection.h"
+#include "model/MediaManager.h"
+#include <algorithm>
+
+bool FileSelection::toggle(const MediaFile* file) {
+    if (!file) return false;
+    const std::string& path = file->getFilePath();
+    if (marked.erase(path) > 0) {
+        paths.erase(std::find(paths.begin(), paths.end(), path));
+        return false;
+    }
+    marked.insert(path);
+    paths.push_back(path);
+    return true;
+}
+
+void FileSelection::clear() {
+    paths.clear();
+    marked.clear();
+}
+
+bool FileSelection::isMarked(const MediaFile* file) const {
+    return file && !marked.empty() && marked.count(file->getFilePath()) > 0;
+}
+
+bool FileSelection::empty() const {
+    return marked.empty();
+}
+
+size_t FileSelection::size() const {
+    return marked.size();
+}
+
+std::vector<MediaFile*> FileSelection::getFiles(const MediaManager* manager) const {
+    std::vector<MediaFile*> files;
+    if (!manager) return files;
+    files.reserve(paths.size());
+    for (const auto& path : paths) {
+        if (MediaFile* file = manager->findFileByPath(path)) files.push_back(file);
+    }
+    return files;
+}
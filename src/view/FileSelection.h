@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+class MediaManager;
+class MediaFile;
+
+// Files marked for a bulk action, shared by the library views. SPACE marks or
+// unmarks the highlighted file, ESC drops the marks. Kept by path, so marks survive
+// sorting and searching, and a file that leaves the library leaves the selection.
+class FileSelection {
+public:
+    bool toggle(const MediaFile* file); // True if the file is marked now
+    void clear();
+
+    bool isMarked(const MediaFile* file) const;
+    bool empty() const;
+    size_t size() const;
+
+    // The marked files still in 'manager', in the order they were marked
+    std::vector<MediaFile*> getFiles(const MediaManager* manager) const;
+
+private:
+    std::vector<std::string> paths;
+    std::unordered_set<std::string> marked;
+};
@@ -18,6 +18,7 @@ MainFileView::MainFileView(NcursesUI* ui, WINDOW* win, MediaManager* manager)
     nextBtnY = nextBtnX = nextBtnW = 0;
     editButtonY = editButtonX = editButtonW = 0;
     addButtonY = addButtonX = addButtonW = 0;
+    sortBtnY = sortBtnX = sortBtnW = 0;
 
     // Calculate initial pagination (will be recalculated in draw)
     int width, height;
@@ -47,8 +48,7 @@ void MainFileView::draw(FocusArea focus) {
     int availableLines = height - 4 - 2;
     if(availableLines < 1) availableLines = 1;
     itemsPerPage = std::min(25, availableLines); // Apply 25 limit
-    totalPages = mediaManager ? mediaManager->getTotalPages(itemsPerPage) : 1;
-    if (totalPages == 0) totalPages = 1;
+    totalPages = std::max(1, (visibleFileCount() + itemsPerPage - 1) / itemsPerPage);
     if (filePage > totalPages) filePage = totalPages;
     //int totalFiles = mediaManager ? mediaManager->getTotalFileCount() : 0;
 
@@ -65,8 +65,43 @@ void MainFileView::draw(FocusArea focus) {
     mvwprintw(win, 2, titleX, "%s", pageInfo.c_str());
     mvwprintw(win, nextBtnY, nextBtnX, "%s", nextLabel.c_str());
 
+    // Sort order toggle (right side of the status row)
+    std::string sortLabel = std::string("[Sort: ") +
+        MediaManager::getSortOrderName(mediaManager ? mediaManager->getSortOrder() : SortOrder::DATE_ADDED) + "]";
+    sortBtnW = sortLabel.length();
+    sortBtnY = 1;
+    sortBtnX = std::max(3, listWidth - sortBtnW - 2);
+    mvwprintw(win, sortBtnY, sortBtnX, "%s", sortLabel.c_str());
+    int statusWidth = sortBtnX - 4;
+
+    // Duplicates summary, or live progress while the library is still loading unless a search is open
+    if (mediaManager && showDuplicates) {
+        int groups = getDuplicates().empty() ? 0 : duplicateGroups.back();
+        std::string info = "Duplicates: " + std::to_string(groups) + " groups";
+        if (mediaManager->isHashing()) {
+            info += " (hashing " + std::to_string(mediaManager->getHashedCount()) + "/" +
+                    std::to_string(mediaManager->getHashTotal()) + ")";
+        } else if (mediaManager->isLoading()) {
+            info += " (" + mediaManager->getScanProgress().getStatusText() + ")";
+        }
+        mvwprintw(win, 1, 3, "%.*s", statusWidth, info.c_str());
+    } else if (mediaManager && mediaManager->isLoading() && !filter.isEditing() && !filter.isActive()) {
+        std::string loadInfo = mediaManager->getScanProgress().getStatusText();
+        mvwprintw(win, 1, 3, "%.*s", statusWidth, loadInfo.c_str());
+    } else {
+        filter.draw(win, 1, 3, statusWidth, mediaManager);
+    }
+
+    // Lazy libraries read the tags of the page on screen and its neighbours in the
+    // background; pending entries show placeholders until they arrive
+    if (mediaManager && mediaManager->isLazyMetadata()) {
+        bool plainPage = !filter.isActive() && !showDuplicates;
+        mediaManager->prefetchPage(getVisiblePage(), static_cast<size_t>(filePage - 1) * itemsPerPage,
+                                   plainPage ? itemsPerPage : 0);
+    }
+
     // File list content (loop up to itemsPerPage)
-    std::vector<MediaFile*> filesOnPage = mediaManager ? mediaManager->getPage(filePage, itemsPerPage) : std::vector<MediaFile*>();
+    MediaFileRange filesOnPage = getVisiblePage();
     for (size_t i = 0; i < filesOnPage.size(); ++i) {
         int lineY = 4 + i;
         if (lineY >= height - 2) break; // Don't draw outside window
@@ -79,8 +114,16 @@ void MainFileView::draw(FocusArea focus) {
             wattron(win, A_REVERSE | A_BOLD);
         }
 
+        if (marks.isMarked(filesOnPage[i])) mvwaddch(win, lineY, 2, '*');
+
         // Draw the filename from the filesOnPage vector using index 'i'
-        mvwprintw(win, lineY, 3, "%.*s", listWidth - 5, filesOnPage[i]->getFileName().c_str());
+        if (showDuplicates) {
+            std::string row = std::to_string(duplicateGroups[fileIdxGlobal]) + ". " +
+                              std::string(filesOnPage[i]->getFileName());
+            mvwprintw(win, lineY, 3, "%.*s", listWidth - 5, row.c_str());
+        } else {
+            mvwprintw(win, lineY, 3, "%.*s", listWidth - 5, filesOnPage[i]->getFileName().data());
+        }
         
         wattroff(win, A_REVERSE | A_BOLD);
     }
@@ -89,7 +132,7 @@ void MainFileView::draw(FocusArea focus) {
     // Header with button
     std::string metaTitle = "Metadata";
     editButtonY = 2; // Same line as list header
-    std::string editLabel = "[Edit]"; // Shorter label
+    std::string editLabel = marks.empty() ? "[Edit]" : "[Edit " + std::to_string(marks.size()) + "]";
     editButtonW = editLabel.length();
     int metaTitleX = listWidth + (detailWidth - metaTitle.length()) / 2; // Center title
     editButtonX = width - editButtonW - 2; // Align right
@@ -112,11 +155,13 @@ void MainFileView::draw(FocusArea focus) {
     // Metadata content - ONLY if explicitly selected
     if (fileExplicitlySelected) {
         MediaFile* selectedFile = getSelectedFile();
-        if (selectedFile && selectedFile->getMetadata()) {
+        if (selectedFile && selectedFile->isMetadataPending()) {
+             mvwprintw(win, 4, listWidth + 2, "(Reading tags...)");
+        } else if (selectedFile && selectedFile->getMetadata()) {
              mvwprintw(win, 4, listWidth + 2, "Title: %.*s", detailWidth-4, selectedFile->getMetadata()->title.c_str());
              // Draw other fields...
-             mvwprintw(win, 5, listWidth + 2, "Artist: %.*s", detailWidth-4, selectedFile->getMetadata()->getField("artist").c_str());
-             mvwprintw(win, 6, listWidth + 2, "Album: %.*s", detailWidth-4, selectedFile->getMetadata()->getField("album").c_str());
+             mvwprintw(win, 5, listWidth + 2, "Artist: %.*s", detailWidth-4, selectedFile->getMetadata()->getArtist().c_str());
+             mvwprintw(win, 6, listWidth + 2, "Album: %.*s", detailWidth-4, selectedFile->getMetadata()->getAlbum().c_str());
 
         } else {
              mvwprintw(win, 4, listWidth + 2, "(No metadata found)");
@@ -144,7 +189,50 @@ void MainFileView::draw(FocusArea focus) {
 // --- UPDATED HANDLEINPUT FUNCTION ---
 MainAreaAction MainFileView::handleInput(InputEvent event, FocusArea focus) {
     if (!mediaManager) return MainAreaAction::NONE;
-    int totalFiles = mediaManager->getTotalFileCount();
+
+    if (focus == FocusArea::MAIN_LIST && (event.key == 'd' || event.key == 'D' || (event.key == 27 && showDuplicates))) {
+        if (!filter.isEditing()) {
+            toggleDuplicates();
+            return MainAreaAction::NONE;
+        }
+    }
+
+    if (focus == FocusArea::MAIN_LIST && !showDuplicates) {
+        TypeAheadFilter::KeyResult result = filter.handleKey(event.key);
+        if (result == TypeAheadFilter::KeyResult::QUERY_CHANGED) {
+            // Jump to the best match so ENTER plays it
+            filePage = 1;
+            fileSelected = visibleFileCount() > 0 ? 0 : -1;
+            fileExplicitlySelected = fileSelected >= 0;
+            return MainAreaAction::NONE;
+        }
+        if (result == TypeAheadFilter::KeyResult::CONSUMED) return MainAreaAction::NONE;
+        if (event.key == 's' || event.key == 'S') {
+            cycleSortOrder();
+            return MainAreaAction::NONE;
+        }
+    }
+
+    if (focus == FocusArea::MAIN_LIST) {
+        if (event.key == ' ') {
+            MediaFile* file = getSelectedFile();
+            if (!file) {
+                flash();
+                return MainAreaAction::NONE;
+            }
+            marks.toggle(file);
+            event.key = KEY_DOWN; // Then move on, so repeated SPACE marks a run of tracks
+        } else if (event.key == 27 && !marks.empty()) {
+            marks.clear();
+            return MainAreaAction::NONE;
+        } else if (event.key == 'e' || event.key == 'E') {
+            if (canEdit()) return MainAreaAction::EDIT_METADATA;
+            flash();
+            return MainAreaAction::NONE;
+        }
+    }
+
+    int totalFiles = visibleFileCount();
     bool selectionChanged = false; // Flag to check if selection actually moved
 
     if (focus == FocusArea::MAIN_LIST && totalFiles > 0) {
@@ -208,11 +296,16 @@ MainAreaAction MainFileView::handleInput(InputEvent event, FocusArea focus) {
 // --- UPDATED HANDLEMOUSE FUNCTION ---
 MainAreaAction MainFileView::handleMouse(int localY, int localX) {
     if (!mediaManager) return MainAreaAction::NONE;
-    int totalFiles = mediaManager->getTotalFileCount();
+    int totalFiles = visibleFileCount();
     int listStartY = 4;
     int clickedIndexOnPage = localY - listStartY;
     int width; getmaxyx(win, std::ignore, width); int listWidth = width / 2;
 
+    if (localY == sortBtnY && localX >= sortBtnX && localX < sortBtnX + sortBtnW && !showDuplicates) {
+        cycleSortOrder();
+        return MainAreaAction::NONE;
+    }
+
     // Check Header Button Clicks
     if (localY == prevBtnY) { // Clicked on header row
         if (localX >= prevBtnX && localX < prevBtnX + prevBtnW && filePage > 1) { // Prev
@@ -229,8 +322,8 @@ MainAreaAction MainFileView::handleMouse(int localY, int localX) {
             return MainAreaAction::NONE;
         }
         if (localX >= editButtonX && localX < editButtonX + editButtonW) { // Edit
-             // Only allow editing if a file has been selected
-             if (fileExplicitlySelected && getSelectedFile() != nullptr) {
+             // Only allow editing if files are marked or one has been selected
+             if (canEdit()) {
                  return MainAreaAction::EDIT_METADATA;
              } else {
                  flash();
@@ -261,37 +354,85 @@ MainAreaAction MainFileView::handleMouse(int localY, int localX) {
     }
     return MainAreaAction::NONE;
 }
-MediaFile* MainFileView::getSelectedFile() const {
-    if (!mediaManager) return nullptr;
-    int totalFiles = mediaManager->getTotalFileCount();
-    if (fileSelected < 0 || fileSelected >= totalFiles) return nullptr;
-
-    // Ensure itemsPerPage is valid before division
-    if (itemsPerPage <= 0) {
-        std::cerr << "Error: itemsPerPage is invalid in getSelectedFile: " << itemsPerPage << std::endl;
-        return nullptr;
+void MainFileView::cycleSortOrder() {
+    if (!mediaManager) return;
+    int orderCount = static_cast<int>(SortOrder::FILE_NAME) + 1;
+    int next = (static_cast<int>(mediaManager->getSortOrder()) + 1) % orderCount;
+    mediaManager->setSortOrder(static_cast<SortOrder>(next));
+    // Back to the top of the newly ordered list
+    filePage = 1;
+    fileSelected = visibleFileCount() > 0 ? 0 : -1;
+    fileExplicitlySelected = false;
+}
+
+void MainFileView::toggleDuplicates() {
+    if (!mediaManager) return;
+    showDuplicates = !showDuplicates;
+    if (showDuplicates) {
+        filter.clear();
+        duplicatesValid = false;
+        mediaManager->startHashing(); // Only files not hashed yet; a no-op once the library is done
     }
+    filePage = 1;
+    fileSelected = visibleFileCount() > 0 ? 0 : -1;
+    fileExplicitlySelected = false;
+}
 
-    int targetPage = (fileSelected / itemsPerPage) + 1;
-    int indexOnPage = fileSelected % itemsPerPage;
+const std::vector<MediaFile*>& MainFileView::getDuplicates() const {
+    if (duplicatesValid && duplicatesGeneration == mediaManager->getGeneration()) return duplicateFiles;
+    duplicateFiles.clear();
+    duplicateGroups.clear();
+    int group = 0;
+    for (const auto& files : mediaManager->findDuplicates()) {
+        ++group;
+        for (MediaFile* file : files) {
+            duplicateFiles.push_back(file);
+            duplicateGroups.push_back(group);
+        }
+    }
+    duplicatesGeneration = mediaManager->getGeneration();
+    duplicatesValid = true;
+    return duplicateFiles;
+}
 
-    // Recalculate totalPages for robust check
-    int currentTotalPages = mediaManager->getTotalPages(itemsPerPage);
-    if(currentTotalPages == 0) currentTotalPages = 1;
+int MainFileView::visibleFileCount() const {
+    if (!mediaManager) return 0;
+    if (showDuplicates) return static_cast<int>(getDuplicates().size());
+    if (filter.isActive()) return static_cast<int>(filter.getResults(mediaManager).size());
+    return mediaManager->getTotalFileCount();
+}
 
-    if (targetPage < 1 || targetPage > currentTotalPages) {
+MediaFileRange MainFileView::getVisiblePage() const {
+    if (!mediaManager) return {};
+    size_t offset = static_cast<size_t>(filePage - 1) * itemsPerPage;
+    if (!filter.isActive() && !showDuplicates) return mediaManager->range(offset, itemsPerPage);
 
-         return nullptr; // Return null if page calc is wrong
+    const std::vector<MediaFile*>& results = showDuplicates ? getDuplicates() : filter.getResults(mediaManager);
+    MediaFileRange page;
+    if (offset < results.size()) {
+        page.first = results.data() + offset;
+        page.count = std::min(results.size() - offset, static_cast<size_t>(itemsPerPage));
     }
+    return page;
+}
 
-    std::vector<MediaFile*> pageData = mediaManager->getPage(targetPage, itemsPerPage);
-    if (indexOnPage >= 0 && static_cast<size_t>(indexOnPage) < pageData.size()) {
-        return pageData[indexOnPage];
-    }
+std::vector<MediaFile*> MainFileView::getMarkedFiles() const {
+    return marks.getFiles(mediaManager);
+}
 
+void MainFileView::clearMarks() {
+    marks.clear();
+}
+
+bool MainFileView::canEdit() const {
+    return !marks.empty() || (fileExplicitlySelected && getSelectedFile() != nullptr);
+}
 
-    if (static_cast<size_t>(indexOnPage) >= pageData.size()){
-      std::cerr << "Error in getSelectedFile: indexOnPage=" << indexOnPage
-                << " >= pageData.size=" << pageData.size() << std::endl;
+MediaFile* MainFileView::getSelectedFile() const {
+    if (!mediaManager || fileSelected < 0) return nullptr;
+    if (showDuplicates || filter.isActive()) {
+        const std::vector<MediaFile*>& results = showDuplicates ? getDuplicates() : filter.getResults(mediaManager);
+        return static_cast<size_t>(fileSelected) < results.size() ? results[fileSelected] : nullptr;
     }
-    return nullptr;
+    return mediaManager->at(fileSelected);
+}
@@ -4,6 +4,9 @@
 #include <string>
 #include "model/MediaManager.h"
 #include "model/MediaFile.h"
+#include "view/TypeAheadFilter.h"
+#include "view/FileSelection.h"
+
 
 class MainFileView : public IMainAreaView {
 public:
@@ -12,6 +15,8 @@ public:
     MainAreaAction handleInput(InputEvent event, FocusArea focus) override;
     MainAreaAction handleMouse(int localY, int localX) override;
     MediaFile* getSelectedFile() const;
+    std::vector<MediaFile*> getMarkedFiles() const; // Bulk edit targets; empty when nothing is marked
+    void clearMarks();
 
 private:
     NcursesUI* ui;
@@ -24,6 +29,24 @@ private:
     int addButtonY, addButtonX, addButtonW;
     int prevBtnY, prevBtnX, prevBtnW;
     int nextBtnY, nextBtnX, nextBtnW;
+    int sortBtnY, sortBtnX, sortBtnW;
 
     bool fileExplicitlySelected;
+
+    void cycleSortOrder(); // 's' or clicking [Sort: ...]
+    void toggleDuplicates(); // 'd'; ESC also closes
+
+    // Duplicates view: files sharing an audio hash, one group after another
+    bool showDuplicates = false;
+    mutable std::vector<MediaFile*> duplicateFiles;
+    mutable std::vector<int> duplicateGroups; // 1-based group number of each entry in duplicateFiles
+    mutable uint64_t duplicatesGeneration = 0;
+    mutable bool duplicatesValid = false;
+    const std::vector<MediaFile*>& getDuplicates() const; // Rebuilt when the library changed
+
+    TypeAheadFilter filter;
+    FileSelection marks;
+    bool canEdit() const; // Files are marked, or one is selected
+    int visibleFileCount() const; // Duplicates or search matches when shown, otherwise the whole library
+    MediaFileRange getVisiblePage() const; // Points into the library, the search results or the duplicates
 };
\ No newline at end of file
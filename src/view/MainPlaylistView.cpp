@@ -116,7 +116,7 @@ void MainPlaylistView::draw(FocusArea focus) {
                 if (focus == FocusArea::MAIN_DETAIL && (int)i == trackSelected) {
                     wattron(win, A_REVERSE | A_BOLD);
                 }
-                mvwprintw(win, 4 + i, listWidth + 2, "%.*s", detailWidth - 4, tracks[i]->getFileName().c_str());
+                mvwprintw(win, 4 + i, listWidth + 2, "%.*s", detailWidth - 4, tracks[i]->getFileName().data());
                 wattroff(win, A_REVERSE | A_BOLD);
             }
         }
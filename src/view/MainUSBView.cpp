@@ -1,4 +1,5 @@
 #include "view/MainUSBView.h"
+#include "view/MainFileView.h"
 #include "controller/AppController.h"
 #include "model/Metadata.h"
 #include <cmath>
@@ -36,7 +37,7 @@ void MainUSBView::updateUSBStatus() {
     if (!appController) return;
     mediaManager = appController->getUSBMediaManager();
 
-    if (mediaManager && mediaManager->getTotalFileCount() > 0) {
+    if (mediaManager && (mediaManager->getTotalFileCount() > 0 || mediaManager->isLoading())) {
         usbConnected = true;
     } else {
         usbConnected = false;
@@ -45,6 +46,7 @@ void MainUSBView::updateUSBStatus() {
 
 
 void MainUSBView::draw(FocusArea focus) {
+    updateUSBStatus(); // The USB library fills in over time while it loads
     werase(win);
     box(win, 0, 0);
 
@@ -55,6 +57,9 @@ void MainUSBView::draw(FocusArea focus) {
 
     if (!usbConnected || !mediaManager || mediaManager->getTotalFileCount() == 0) {
         std::string msg = "⚠️ No USB detected. Please connect a USB drive.";
+        if (mediaManager && mediaManager->isLoading()) {
+            msg = "USB: " + mediaManager->getScanProgress().getStatusText();
+        }
         mvwprintw(win, height / 2, (width - msg.size()) / 2, "%s", msg.c_str());
 
         std::string reloadLabel = "[Reload USB]";
@@ -76,8 +81,7 @@ void MainUSBView::draw(FocusArea focus) {
     int availableLines = height - 4 - 2;
     if(availableLines < 1) availableLines = 1;
     itemsPerPage = std::min(25, availableLines);
-    totalPages = mediaManager->getTotalPages(itemsPerPage);
-    if (totalPages == 0) totalPages = 1;
+    totalPages = std::max(1, (visibleFileCount() + itemsPerPage - 1) / itemsPerPage);
     if (filePage > totalPages) filePage = totalPages;
 
     std::string pageInfo = "Page " + std::to_string(filePage) + "/" + std::to_string(totalPages);
@@ -91,7 +95,20 @@ void MainUSBView::draw(FocusArea focus) {
     mvwprintw(win, 2, (listWidth - pageInfo.size()) / 2, "%s", pageInfo.c_str());
     mvwprintw(win, nextBtnY, nextBtnX, "%s", nextLabel.c_str());
 
-    std::vector<MediaFile*> filesOnPage = mediaManager ? mediaManager->getPage(filePage, itemsPerPage) : std::vector<MediaFile*>();
+    if (mediaManager->isLoading() && !filter.isEditing() && !filter.isActive()) {
+        std::string loadInfo = mediaManager->getScanProgress().getStatusText();
+        mvwprintw(win, 1, 3, "%.*s", listWidth - 5, loadInfo.c_str());
+    } else {
+        filter.draw(win, 1, 3, listWidth - 5, mediaManager);
+    }
+
+    // Lazy libraries read the tags of the page on screen and its neighbours in the
+    // background; pending entries show placeholders until they arrive
+    if (mediaManager && mediaManager->isLazyMetadata()) {
+        mediaManager->prefetchPage(getVisiblePage(), static_cast<size_t>(filePage - 1) * itemsPerPage,
+                                   filter.isActive() ? 0 : itemsPerPage);
+    }
+    MediaFileRange filesOnPage = getVisiblePage();
     for (size_t i = 0; i < filesOnPage.size(); ++i) {
         int lineY = 4 + i;
         if (lineY >= height - 2) break;
@@ -102,14 +119,15 @@ void MainUSBView::draw(FocusArea focus) {
             wattron(win, A_REVERSE | A_BOLD);
         }
 
-        mvwprintw(win, lineY, 3, "%.*s", listWidth - 5, filesOnPage[i]->getFileName().c_str());
+        if (marks.isMarked(filesOnPage[i])) mvwaddch(win, lineY, 2, '*');
+        mvwprintw(win, lineY, 3, "%.*s", listWidth - 5, filesOnPage[i]->getFileName().data());
         
         wattroff(win, A_REVERSE | A_BOLD);
     }
 
     std::string metaTitle = "Metadata";
     editBtnY = 2;
-    std::string editLabel = "[Edit]";
+    std::string editLabel = marks.empty() ? "[Edit]" : "[Edit " + std::to_string(marks.size()) + "]";
     editBtnW = editLabel.length();
     int metaTitleX = listWidth + (detailWidth - metaTitle.size()) / 2;
     editBtnX = width - editBtnW - 2;
@@ -128,10 +146,12 @@ void MainUSBView::draw(FocusArea focus) {
 
     if (fileExplicitlySelected) {
         MediaFile* selectedFile = getSelectedFile();
-        if (selectedFile && selectedFile->getMetadata()) {
+        if (selectedFile && selectedFile->isMetadataPending()) {
+             mvwprintw(win, 4, listWidth + 2, "(Reading tags...)");
+        } else if (selectedFile && selectedFile->getMetadata()) {
              mvwprintw(win, 4, listWidth + 2, "Title: %.*s", detailWidth-4, selectedFile->getMetadata()->title.c_str());
-             mvwprintw(win, 5, listWidth + 2, "Artist: %.*s", detailWidth-4, selectedFile->getMetadata()->getField("artist").c_str());
-             mvwprintw(win, 6, listWidth + 2, "Album: %.*s", detailWidth-4, selectedFile->getMetadata()->getField("album").c_str());
+             mvwprintw(win, 5, listWidth + 2, "Artist: %.*s", detailWidth-4, selectedFile->getMetadata()->getArtist().c_str());
+             mvwprintw(win, 6, listWidth + 2, "Album: %.*s", detailWidth-4, selectedFile->getMetadata()->getAlbum().c_str());
 
         } else {
              mvwprintw(win, 4, listWidth + 2, "(No metadata found)");
@@ -168,7 +188,36 @@ void MainUSBView::draw(FocusArea focus) {
 MainAreaAction MainUSBView::handleInput(InputEvent event, FocusArea focus) {
     if (!usbConnected || !mediaManager) return MainAreaAction::NONE;
 
-   int totalFiles = mediaManager->getTotalFileCount();
+    if (focus == FocusArea::MAIN_LIST) {
+        TypeAheadFilter::KeyResult result = filter.handleKey(event.key);
+        if (result == TypeAheadFilter::KeyResult::QUERY_CHANGED) {
+            // Jump to the best match so ENTER plays it
+            filePage = 1;
+            fileSelected = visibleFileCount() > 0 ? 0 : -1;
+            fileExplicitlySelected = fileSelected >= 0;
+            return MainAreaAction::NONE;
+        }
+        if (result == TypeAheadFilter::KeyResult::CONSUMED) return MainAreaAction::NONE;
+
+        if (event.key == ' ') {
+            MediaFile* file = getSelectedFile();
+            if (!file) {
+                flash();
+                return MainAreaAction::NONE;
+            }
+            marks.toggle(file);
+            event.key = KEY_DOWN; // Then move on, so repeated SPACE marks a run of tracks
+        } else if (event.key == 27 && !marks.empty()) {
+            marks.clear();
+            return MainAreaAction::NONE;
+        } else if (event.key == 'e' || event.key == 'E') {
+            if (canEdit()) return MainAreaAction::EDIT_METADATA;
+            flash();
+            return MainAreaAction::NONE;
+        }
+    }
+
+    int totalFiles = visibleFileCount();
     bool selectionChanged = false; // Flag to check if selection actually moved
 
     if (focus == FocusArea::MAIN_LIST && totalFiles > 0) {
@@ -225,7 +274,7 @@ MainAreaAction MainUSBView::handleInput(InputEvent event, FocusArea focus) {
 // --- MOUSE HANDLER ---
 MainAreaAction MainUSBView::handleMouse(int y, int x) {
     if (!mediaManager) return MainAreaAction::NONE;
-    int totalFiles = mediaManager->getTotalFileCount();
+    int totalFiles = visibleFileCount();
     int listStartY = 4;
     int clickedIndexOnPage = y - listStartY;
     int width; getmaxyx(win, std::ignore, width); int listWidth = width / 2;   
@@ -256,8 +305,8 @@ MainAreaAction MainUSBView::handleMouse(int y, int x) {
             return MainAreaAction::NONE;
         }
         if (x >= editBtnX && x < editBtnX + editBtnW) { // Edit
-             // Only allow editing if a file has been selected
-             if (fileExplicitlySelected && getSelectedFile() != nullptr) {
+             // Only allow editing if files are marked or one has been selected
+             if (canEdit()) {
                  return MainAreaAction::EDIT_METADATA;
              } else {
                  flash();
@@ -293,34 +342,43 @@ MainAreaAction MainUSBView::handleMouse(int y, int x) {
 
 
 
-MediaFile* MainUSBView::getSelectedFile() const {
-    if (!mediaManager) return nullptr;
-    int totalFiles = mediaManager->getTotalFileCount();
-    if (fileSelected < 0 || fileSelected >= totalFiles) return nullptr;
+int MainUSBView::visibleFileCount() const {
+    if (!mediaManager) return 0;
+    if (filter.isActive()) return static_cast<int>(filter.getResults(mediaManager).size());
+    return mediaManager->getTotalFileCount();
+}
 
-    if (itemsPerPage <= 0) {
-        std::cerr << "Error: itemsPerPage is invalid in getSelectedFile: " << itemsPerPage << std::endl;
-        return nullptr;
-    }
+MediaFileRange MainUSBView::getVisiblePage() const {
+    if (!mediaManager) return {};
+    size_t offset = static_cast<size_t>(filePage - 1) * itemsPerPage;
+    if (!filter.isActive()) return mediaManager->range(offset, itemsPerPage);
 
-    int targetPage = (fileSelected / itemsPerPage) + 1;
-    int indexOnPage = fileSelected % itemsPerPage;
+    const std::vector<MediaFile*>& results = filter.getResults(mediaManager);
+    MediaFileRange page;
+    if (offset < results.size()) {
+        page.first = results.data() + offset;
+        page.count = std::min(results.size() - offset, static_cast<size_t>(itemsPerPage));
+    }
+    return page;
+}
 
-    int currentTotalPages = mediaManager->getTotalPages(itemsPerPage);
-    if(currentTotalPages == 0) currentTotalPages = 1;
+std::vector<MediaFile*> MainUSBView::getMarkedFiles() const {
+    return marks.getFiles(mediaManager);
+}
 
-    if (targetPage < 1 || targetPage > currentTotalPages) {
-         return nullptr;
-    }
+void MainUSBView::clearMarks() {
+    marks.clear();
+}
 
-    std::vector<MediaFile*> pageData = mediaManager->getPage(targetPage, itemsPerPage);
-    if (indexOnPage >= 0 && static_cast<size_t>(indexOnPage) < pageData.size()) {
-        return pageData[indexOnPage];
-    }
+bool MainUSBView::canEdit() const {
+    return !marks.empty() || (fileExplicitlySelected && getSelectedFile() != nullptr);
+}
 
-    if (static_cast<size_t>(indexOnPage) >= pageData.size()){
-      std::cerr << "Error in getSelectedFile: indexOnPage=" << indexOnPage
-                << " >= pageData.size=" << pageData.size() << std::endl;
+MediaFile* MainUSBView::getSelectedFile() const {
+    if (!mediaManager || fileSelected < 0) return nullptr;
+    if (filter.isActive()) {
+        const std::vector<MediaFile*>& results = filter.getResults(mediaManager);
+        return static_cast<size_t>(fileSelected) < results.size() ? results[fileSelected] : nullptr;
     }
-    return nullptr;
+    return mediaManager->at(fileSelected);
 }
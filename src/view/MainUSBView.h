@@ -3,6 +3,8 @@
 #include "utils/NcursesUI.h"
 #include "model/MediaManager.h"
 #include "model/MediaFile.h"
+#include "view/TypeAheadFilter.h"
+#include "view/FileSelection.h"
 
 class AppController;
 
@@ -13,6 +15,8 @@ public:
     MainAreaAction handleInput(InputEvent event, FocusArea focus) override;
     MainAreaAction handleMouse(int localY, int localX) override;
     MediaFile* getSelectedFile() const;
+    std::vector<MediaFile*> getMarkedFiles() const; // Bulk edit targets; empty when nothing is marked
+    void clearMarks();
 
 private:
     NcursesUI* ui;
@@ -34,5 +38,11 @@ private:
     int nextBtnY, nextBtnX, nextBtnW;
 
     void updateUSBStatus();
-    
+
+    TypeAheadFilter filter;
+    FileSelection marks;
+    bool canEdit() const; // Files are marked, or one is selected
+    int visibleFileCount() const; // Search matches while filtering, otherwise the whole library
+    MediaFileRange getVisiblePage() const; // Points into the library or the search results
+
 };
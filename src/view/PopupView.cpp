@@ -1,5 +1,6 @@
 #include "view/PopupView.h"
 #include "model/Metadata.h"
+#include "view/BulkTagEdit.h"
 #include <string.h>
 #include <algorithm>
 #include <iostream> 
@@ -221,4 +222,73 @@ bool PopupView::showMetadataEditor(Metadata* metadata) {
 exit_loop:
     clearWindow();
     return saved;
+}
+
+unsigned PopupView::showBulkMetadataEditor(const std::vector<const Metadata*>& targets, Metadata& changes) {
+    if (targets.empty()) return 0;
+
+    winHeight_ = 12;
+    winWidth_ = 60;
+    std::string title = "Edit " + std::to_string(targets.size()) + " files";
+    drawWindow(title);
+
+    BulkTagEdit edit(targets);
+    const std::vector<BulkTagEdit::Field>& fields = edit.getFields();
+    int selectedField = 0;
+    bool saved = false;
+
+    while (true) {
+        werase(win_);
+        box(win_, 0, 0);
+        mvwprintw(win_, 0, 2, "%s", title.c_str());
+        mvwprintw(win_, 1, 2, "ENTER: Edit | 'c': Clear | 's': Save | 'q': Cancel");
+
+        int y = 3;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            std::string label = fields[i].label + ":";
+            std::string value = edit.getDisplayValue(i);
+
+            mvwprintw(win_, y + i, 2, "%-10s", label.c_str());
+
+            if ((int)i == selectedField) wattron(win_, A_REVERSE | A_BOLD);
+            mvwprintw(win_, y + i, 12, " %.*s ", winWidth_ - 17, value.c_str());
+            if ((int)i == selectedField) wattroff(win_, A_REVERSE | A_BOLD);
+            if (fields[i].edited) mvwprintw(win_, y + i, winWidth_ - 3, "*");
+        }
+
+        mvwprintw(win_, y + fields.size() + 2, 2, "[S]ave & Close");
+        mvwprintw(win_, y + fields.size() + 2, 20, "[Q]uit");
+
+        wrefresh(win_);
+
+        int ch = wgetch(win_);
+        switch (ch) {
+            case KEY_UP:
+                selectedField = (selectedField - 1 + fields.size()) % fields.size();
+                break;
+            case KEY_DOWN:
+                selectedField = (selectedField + 1) % fields.size();
+                break;
+            case 10: // Enter
+                edit.enter(selectedField, getLineInput(y + selectedField, 12, fields[selectedField].value, winWidth_ - 17));
+                break;
+            case 'c':
+            case 'C':
+                edit.clear(selectedField);
+                break;
+            case 's':
+            case 'S':
+                saved = true;
+                goto exit_loop;
+            case 'q':
+            case 'Q':
+            case 27: // ESC
+                saved = false;
+                goto exit_loop;
+        }
+    }
+
+exit_loop:
+    clearWindow();
+    return saved ? edit.apply(changes) : 0;
 }
\ No newline at end of file
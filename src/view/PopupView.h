@@ -16,6 +16,11 @@ public:
     std::optional<int> showListSelection(const std::string& title, const std::vector<std::string>& options);
 
     bool showMetadataEditor(Metadata* metadata);
+    // One editor for several files (see BulkTagEdit): fields that differ between them
+    // show as "(various)". Only the fields the user edits or clears are filled into
+    // 'changes'; returns their TagLibWrapper::TagFields mask, 0 if cancelled or nothing
+    // was edited.
+    unsigned showBulkMetadataEditor(const std::vector<const Metadata*>& targets, Metadata& changes);
 
 private:
     void drawWindow(const std::string& title);
@@ -1,5 +1,6 @@
 #include "view/TopBarView.h"
 #include <cstring>
+#include <algorithm>
 
 TopBarView::TopBarView(NcursesUI* ui, WINDOW* win, const std::string& title)
     : ui(ui), win(win), title(title) {}
@@ -13,6 +14,15 @@ void TopBarView::draw() {
     mvwprintw(win, 1, (width - title.size()) / 2, "%s", title.c_str());
     wattroff(win, A_BOLD | A_REVERSE);
 
+    if (!status.empty() && width > 4) {
+        int x = std::max(2, width - static_cast<int>(status.size()) - 2);
+        mvwprintw(win, 1, x, "%.*s", width - x - 1, status.c_str());
+    }
+
     wnoutrefresh(win);
 }
 
+void TopBarView::setStatus(const std::string& newStatus) {
+    status = newStatus;
+}
+
@@ -6,9 +6,11 @@ class TopBarView {
 public:
     TopBarView(NcursesUI* ui, WINDOW* win, const std::string& title);
     void draw();
+    void setStatus(const std::string& status); // Right-aligned; empty for none
 
 private:
     NcursesUI* ui;
     WINDOW* win;
     std::string title;
+    std::string status;
 };
@@ -0,0 +1,80 @@
+#include "view/TypeAheadFilter.h"
+#include "model/MediaManager.h"
+
+TypeAheadFilter::KeyResult TypeAheadFilter::handleKey(int key) {
+    if (!editing) {
+        if (key == '/') {
+            editing = true;
+            return KeyResult::CONSUMED;
+        }
+        if (key == 27 && isActive()) { // ESC drops a kept filter
+            clear();
+            return KeyResult::QUERY_CHANGED;
+        }
+        return KeyResult::IGNORED;
+    }
+
+    if (key == 27) {
+        clear();
+        return KeyResult::QUERY_CHANGED;
+    }
+    if (key == 10) {
+        editing = false;
+        return KeyResult::IGNORED; // Let ENTER through so it still plays the selection
+    }
+    if (key == KEY_BACKSPACE || key == 127 || key == 8) {
+        if (query.empty()) return KeyResult::CONSUMED;
+        query.pop_back();
+        return KeyResult::QUERY_CHANGED;
+    }
+    if (key >= 32 && key < 127) {
+        query.push_back(static_cast<char>(key));
+        return KeyResult::QUERY_CHANGED;
+    }
+    return KeyResult::IGNORED; // Arrows and paging still move through the results
+}
+
+void TypeAheadFilter::clear() {
+    query.clear();
+    editing = false;
+    results.clear();
+    resultsManager = nullptr;
+}
+
+bool TypeAheadFilter::isEditing() const {
+    return editing;
+}
+
+bool TypeAheadFilter::isActive() const {
+    return !query.empty();
+}
+
+const std::vector<MediaFile*>& TypeAheadFilter::getResults(MediaManager* manager) const {
+    if (!manager || query.empty()) {
+        results.clear();
+        resultsManager = nullptr;
+        return results;
+    }
+    if (manager != resultsManager || manager->getGeneration() != resultsGeneration || query != resultsQuery) {
+        results = manager->search(query, MAX_RESULTS);
+        resultsManager = manager;
+        resultsGeneration = manager->getGeneration();
+        resultsQuery = query;
+    }
+    return results;
+}
+
+void TypeAheadFilter::draw(WINDOW* win, int y, int x, int width, MediaManager* manager) const {
+    if (width <= 0) return;
+    if (!editing && !isActive()) {
+        mvwprintw(win, y, x, "%.*s", width, "[/] Search");
+        return;
+    }
+
+    size_t matches = getResults(manager).size();
+    std::string line = "Search: " + query + (editing ? "_" : "");
+    if (isActive()) {
+        line += "  (" + std::to_string(matches) + (matches >= MAX_RESULTS ? "+" : "") + " matches)";
+    }
+    mvwprintw(win, y, x, "%.*s", width, line.c_str());
+}
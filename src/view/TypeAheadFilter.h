@@ -0,0 +1,39 @@
+#pragma once
+#include <ncurses.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class MediaManager;
+class MediaFile;
+
+// Search box shared by the library views. '/' starts typing, ESC clears,
+// ENTER stops typing but keeps the filter. While a query is set the view
+// lists getResults() instead of the whole library.
+class TypeAheadFilter {
+public:
+    enum class KeyResult { IGNORED, CONSUMED, QUERY_CHANGED };
+
+    KeyResult handleKey(int key);
+    void clear();
+
+    bool isEditing() const;
+    bool isActive() const; // A non-empty query is applied
+
+    // Ranked matches, recomputed only when the query or the library changed
+    const std::vector<MediaFile*>& getResults(MediaManager* manager) const;
+
+    void draw(WINDOW* win, int y, int x, int width, MediaManager* manager) const;
+
+private:
+    static const size_t MAX_RESULTS = 500;
+
+    std::string query;
+    bool editing = false;
+
+    // Cached results; MediaFile* may dangle once the generation moves on
+    mutable std::vector<MediaFile*> results;
+    mutable const MediaManager* resultsManager = nullptr;
+    mutable uint64_t resultsGeneration = 0;
+    mutable std::string resultsQuery;
+};
@@ -74,7 +74,13 @@ void UIManager::run() {
         if (event.type != InputEvent::UNKNOWN)
             handleInput(event);
 
-        if (topBarView) topBarView->draw();
+        if (appController && appController->pollLibraryChanges())
+            needsRedrawMain = true;
+
+        if (topBarView) {
+            if (appController) topBarView->setStatus(appController->getTagWriteStatus());
+            topBarView->draw();
+        }
         if (needsRedrawSidebar && sidebarView) {
             sidebarView->draw(currentFocus == FocusArea::SIDEBAR);
             needsRedrawSidebar = false;
@@ -283,14 +289,39 @@ void UIManager::handleInput(InputEvent event) {
                 break;
 
             MediaFile* fileToEdit = nullptr;
+            std::vector<MediaFile*> marked;
 
             if (currentMode == AppMode::FILE_BROWSER) {
-                if (auto* fv = dynamic_cast<MainFileView*>(mainAreaView.get()))
+                if (auto* fv = dynamic_cast<MainFileView*>(mainAreaView.get())) {
                     fileToEdit = fv->getSelectedFile();
+                    marked = fv->getMarkedFiles();
+                }
             }
             else if (currentMode == AppMode::USB_BROWSER) {
-                if (auto* uv = dynamic_cast<MainUSBView*>(mainAreaView.get()))
+                if (auto* uv = dynamic_cast<MainUSBView*>(mainAreaView.get())) {
                     fileToEdit = uv->getSelectedFile();
+                    marked = uv->getMarkedFiles();
+                }
+            }
+
+            // Marked files: one editor for all of them
+            if (!marked.empty() && popup && appController && appController->getMediaController()) {
+                MediaController* mc = appController->getMediaController();
+                mc->ensureMetadata(marked);
+                std::vector<const Metadata*> targets;
+                for (MediaFile* file : marked) {
+                    if (file->getMetadata()) targets.push_back(file->getMetadata());
+                }
+                Metadata changes;
+                unsigned fields = popup->showBulkMetadataEditor(targets, changes);
+                if (fields != 0) {
+                    mc->saveBulkMetadataChanges(marked, changes, fields);
+                    if (auto* fv = dynamic_cast<MainFileView*>(mainAreaView.get())) fv->clearMarks();
+                    if (auto* uv = dynamic_cast<MainUSBView*>(mainAreaView.get())) uv->clearMarks();
+                }
+                needsRedrawSidebar = true;
+                needsRedrawMain = true;
+                break;
             }
 
             if (!fileToEdit || !popup) {
@@ -298,13 +329,17 @@ void UIManager::handleInput(InputEvent event) {
                 break;
             }
 
+            // A lazy library may still hold placeholder tags; never write those back
+            if (appController && appController->getMediaController())
+                appController->getMediaController()->ensureMetadata(fileToEdit);
+            const Metadata before = *fileToEdit->getMetadata(); // So only changed fields are written
             bool saved = popup->showMetadataEditor(fileToEdit->getMetadata());
 
             needsRedrawSidebar = true;
             needsRedrawMain = true;
 
             if (saved && appController && appController->getMediaController()) {
-                appController->getMediaController()->saveMetadataChanges(fileToEdit);
+                appController->getMediaController()->saveMetadataChanges(fileToEdit, before);
             }
 
             break;
@@ -428,6 +463,10 @@ void UIManager::switchMainView(AppMode newMode) {
     if (newMode == currentMode && mainAreaView != nullptr) return;
     currentMode = newMode;
 
+    // The scan behind the view being opened gets the disk first
+    appController->focusLibrary(newMode == AppMode::FILE_BROWSER ? appController->getMediaManager()
+                                : newMode == AppMode::USB_BROWSER ? appController->getUSBMediaManager() : nullptr);
+
     if (newMode == AppMode::FILE_BROWSER) {
         mainAreaView = std::make_unique<MainFileView>(ui, mainWin, appController->getMediaManager());
     }